@@ -1,12 +1,17 @@
 #include <stdio.h>
+#include <atomic>
 #include "pico/stdlib.h"
+#include "pico/multicore.h"
 #include "hardware/spi.h"
 #include "hardware/watchdog.h"
 #include "hardware/gpio.h"
 #include "core/GC9A01.h"
+#include "core/GlyphCache.h"
 #include "core/MCP2515.h"
 #include "core/HolleySniper.h"
-#include "assets/torino_logo_sm.h"
+#include "core/SnapshotBuffer.h"
+#include "core/Dashboard.h"
+#include "torino_logo_sm.h"
 
 // GC9A01 Display pin definitions (SPI0)
 #define DISPLAY_SPI_PORT spi0
@@ -24,10 +29,187 @@
 #define CAN_PIN_INT      6    // Interrupt pin
 // SPI1 pins: SCK=10, MOSI=11, MISO=12 (hardwired)
 
+// Core1 redraws the gauge at a fixed rate, core0 polls the CAN intake. Frames
+// wait in the MCP2515 RX ring (filled from the INT pin IRQ) between passes.
+#define UI_FPS            30
+#define UI_FRAME_US       (1000000 / UI_FPS)
+#define INTAKE_PERIOD_US  1000
+#define PUBLISH_PERIOD_MS 100    // Snapshot refresh when no frames arrive
+#define STATS_PERIOD_MS   5000
+
+// Frame time / SPI overlay on the panel (1 to enable), the same numbers go to
+// the USB console every STATS_PERIOD_MS either way
+#define UI_STATS_OVERLAY  0
+
+// Readout text path benchmark on the USB console at boot (1 to enable). It
+// draws test values on the panel and delays the logo, so it is off in use
+#define UI_BENCHMARK_READOUTS 0
+
+enum IntakeState {
+    INTAKE_STARTING,
+    INTAKE_RUNNING,
+    INTAKE_FAILED
+};
+
 // Create objects
 GC9A01 display(DISPLAY_SPI_PORT, DISPLAY_PIN_CS, DISPLAY_PIN_DC, DISPLAY_PIN_RST, DISPLAY_PIN_BL);
 MCP2515 can_controller(CAN_SPI_PORT, CAN_PIN_CS, CAN_PIN_INT);
 HolleySniper sniper(&can_controller);
+GlyphCache glyph_cache(GLYPH_CACHE_DEFAULT_BUDGET);
+SnapshotBuffer<GaugeSnapshot> snapshots;
+std::atomic<int> intake_state(INTAKE_STARTING);
+
+// Dashboard widgets, redrawn by core1 only when their output changes
+Dashboard dashboard(display);
+
+#if UI_BENCHMARK_READOUTS
+// Times the main readouts drawn straight to the panel, pixel by pixel, with
+// the glyph blitter and from a warm glyph cache, so the cost of each text
+// path shows on the console
+static void benchmark_readouts() {
+    struct Readout {
+        const char* name;
+        uint16_t x, y;
+        const char* text;
+        sFONT* font;
+    };
+    const Readout readouts[] = {
+        {"RPM", 60, 205, "6500", &LiberationSansNarrow_Bold36},
+        {"AFR", 130, 155, "14.7", &Font20},
+        {"Coolant", 10, 105, "88.5C", &LiberationSansNarrow_Bold24},
+    };
+    
+    const char* modes[] = {"per pixel", "glyph blit", "cached"};
+    for (int mode = 0; mode < 3; mode++) {
+        display.setGlyphBlit(mode > 0);
+        display.setGlyphCache(mode == 2 ? &glyph_cache : nullptr);
+        for (const Readout& readout : readouts) {
+            if (mode == 2) {
+                display.print(readout.x, readout.y, readout.text, WHITE, BLACK, readout.font);
+            }
+            uint32_t bytes = display.getSpiBytes();
+            uint32_t start = time_us_32();
+            display.print(readout.x, readout.y, readout.text, WHITE, BLACK, readout.font);
+            display.waitIdle();
+            printf("Readout %-7s %-10s %6lu us, %6lu SPI bytes\n", readout.name, modes[mode],
+                   (unsigned long)(time_us_32() - start), (unsigned long)(display.getSpiBytes() - bytes));
+        }
+    }
+    glyph_cache.resetStats();
+    display.fillScreen(BLACK);
+}
+#endif
+
+// Core1: owns the display. DMA is enabled from here so its IRQ runs on this
+// core and rendering never competes with the CAN intake on core0.
+static void core1_main() {
+    // Initialize display
+    printf("Initializing GC9A01 display...\n");
+    display.init();
+    printf("Display initialized!\n");
+#if UI_BENCHMARK_READOUTS
+    benchmark_readouts();
+#endif
+    
+    // Draw into RAM and send only what changed, so values update without
+    // flicker. Falls back to drawing straight to the panel when out of RAM.
+    if (!display.enableFramebuffer()) {
+        printf("WARNING: No RAM for the display framebuffer, drawing directly\n");
+    }
+    
+    // Stream pixels with DMA, the CPU renders while a flush goes out
+    if (!display.enableDMA()) {
+        printf("WARNING: No DMA channel for the display, using blocking SPI\n");
+    }
+    display.setGlyphCache(&glyph_cache);
+    
+    // Show Torino logo for 5 seconds while core0 brings up CAN
+    display.fillScreen(BLACK);
+    
+    // Center the logo on the 240x240 screen
+    uint16_t logo_x = (240 - torino_logo_sm.width) / 2 + 4;  // 46 pixels from left
+    uint16_t logo_y = (240 - torino_logo_sm.height) / 2 - 12;  // 43 pixels from top
+    
+    printf("Displaying Torino logo...\n");
+    display.drawPackedImage(logo_x, logo_y, torino_logo_sm);
+    display.flush();
+    
+    // Keep logo visible for 5 seconds
+    sleep_ms(5000);
+    
+    while (intake_state.load() == INTAKE_STARTING) {
+        sleep_ms(10);
+    }
+    if (intake_state.load() == INTAKE_FAILED) {
+        display.fillScreen(RED);
+        display.print(20, 110, "CAN ERROR", WHITE, RED, &LiberationSansNarrow_Bold36);
+        display.flush();
+        while(true) { sleep_ms(1000); }
+    }
+    
+    // Widgets repaint only their own boxes from here on, the screen is
+    // only cleared once
+    display.fillScreen(BLACK);
+    dashboard.invalidate();
+    display.setStatsOverlay(UI_STATS_OVERLAY);
+    display.resetFrameStats();
+    
+    uint32_t last_stats_time = to_ms_since_boot(get_absolute_time());
+    uint32_t last_version = 0;
+    uint32_t frames = 0;
+    uint32_t new_snapshots = 0;
+    uint32_t overruns = 0;
+    uint64_t busy_us = 0;
+    absolute_time_t next_frame = get_absolute_time();
+    
+    while (true) {
+        uint32_t start = time_us_32();
+        
+        GaugeSnapshot snapshot;
+        uint32_t version = snapshots.read(snapshot);
+        if (version != last_version) {
+            new_snapshots++;
+            last_version = version;
+        }
+        // After the snapshot, so its frame times are never ahead of the clock
+        uint32_t current_time = to_ms_since_boot(get_absolute_time());
+        
+        display.beginFrame();
+        dashboard.update(snapshot, current_time);
+        
+        // With DMA this returns while the pixels go out
+        display.flush();
+        frames++;
+        busy_us += time_us_32() - start;
+        
+        if (current_time - last_stats_time >= STATS_PERIOD_MS) {
+            uint32_t elapsed_us = (current_time - last_stats_time) * 1000;
+            display.printFrameStats();
+            printf("Core1: %.1f%% busy, %.1f fps (target %d), %lu overruns, %lu new snapshots, %lu read retries, %lu widget redraws\n",
+                   100.0f * busy_us / elapsed_us, frames * 1000000.0f / elapsed_us, UI_FPS,
+                   (unsigned long)overruns, (unsigned long)new_snapshots, (unsigned long)snapshots.retryCount(),
+                   (unsigned long)dashboard.getRedraws());
+            dashboard.resetStats();
+            glyph_cache.printStats();
+            
+            last_stats_time = current_time;
+            frames = 0;
+            new_snapshots = 0;
+            overruns = 0;
+            busy_us = 0;
+        }
+        
+        // Fixed frame rate; a late frame restarts the schedule instead of
+        // bunching up frames to catch up
+        next_frame = delayed_by_us(next_frame, UI_FRAME_US);
+        if (absolute_time_diff_us(get_absolute_time(), next_frame) <= 0) {
+            overruns++;
+            next_frame = get_absolute_time();
+            continue;
+        }
+        sleep_until(next_frame);
+    }
+}
 
 int main() {
     stdio_init_all();
@@ -39,150 +221,96 @@ int main() {
     gpio_set_function(DISPLAY_PIN_SCK,  GPIO_FUNC_SPI);
     gpio_set_function(DISPLAY_PIN_MOSI, GPIO_FUNC_SPI);
     
-    // SPI1 initialization for CAN controller (1MHz for MCP2515)
-    spi_init(CAN_SPI_PORT, 1*1000*1000);
+    // SPI1 initialization for CAN controller (8MHz, MCP2515 max is 10MHz)
+    spi_init(CAN_SPI_PORT, 8*1000*1000);
     gpio_set_function(10, GPIO_FUNC_SPI);  // SCK
     gpio_set_function(11, GPIO_FUNC_SPI);  // MOSI 
     gpio_set_function(12, GPIO_FUNC_SPI);  // MISO
     
-    // Initialize display
-    printf("Initializing GC9A01 display...\n");
-    display.init();
-    printf("Display initialized!\n");
+    // The display belongs to core1 from here on
+    multicore_launch_core1(core1_main);
     
     // Initialize CAN controller
     printf("Initializing MCP2515 CAN controller...\n");
     if (!can_controller.init(CAN_500KBPS)) {
         printf("ERROR: Failed to initialize CAN controller!\n");
-        display.fillScreen(RED);
-        display.print(20, 110, "CAN ERROR", WHITE, RED, &LiberationSansNarrow_Bold36);
+        intake_state.store(INTAKE_FAILED);
         while(true) { sleep_ms(1000); }
     }
     printf("CAN controller initialized at 500kbps!\n");
     
+    // Receive frames from the INT pin handler so the chip's two RX buffers are
+    // drained as frames arrive; the IRQ is taken on this core
+    if (!can_controller.enableRxInterrupt()) {
+        printf("WARNING: CAN RX interrupt unavailable, polling instead\n");
+    }
+    
     // Initialize Holley Sniper decoder
     printf("Initializing Holley Sniper decoder...\n");
     sniper.init();
+    if (!sniper.configureFilters()) {
+        printf("WARNING: CAN filters not set, every bus frame will be read\n");
+    }
     printf("Holley Sniper decoder ready!\n");
     
-    // Show Torino logo for 5 seconds
-    display.fillScreen(BLACK);
-    
-    // Center the 156x130 logo on the 240x240 screen
-    uint16_t logo_x = (240 - 156) / 2 + 4;  // 42 pixels from left
-    uint16_t logo_y = (240 - 130) / 2 - 12;  // 55 pixels from top
-    
-    printf("Displaying Torino logo...\n");
-    display.drawImage(logo_x, logo_y, 156, 130, torino_logo_sm);
-    
-    // Keep logo visible for 5 seconds
-    sleep_ms(5000);
-    
     printf("Starting real-time engine monitoring...\n");
+    intake_state.store(INTAKE_RUNNING);
     
     // Variables for fuel consumption calculation
     float total_fuel_consumed_liters = 0.0f;
     uint32_t last_fuel_calc_time = to_ms_since_boot(get_absolute_time());
+    uint32_t last_publish_time = 0;
+    uint32_t last_stats_time = last_fuel_calc_time;
+    uint64_t busy_us = 0;
     
-    // Main engine monitoring loop
+    // Core0: CAN intake loop
     while (true) {
-        // Process incoming CAN messages
-        sniper.processCANMessages();
+        uint32_t start = time_us_32();
         
-        // Clear screen for new data
-        display.fillScreen(BLACK);
+        // Process incoming CAN messages
+        bool updated = sniper.processCANMessages();
         
         // Get current time
         uint32_t current_time = to_ms_since_boot(get_absolute_time());
         
-        // Calculate fuel consumption (integrate flow rate over time)
-        if (sniper.isFuelFlowValid()) {
+        // Calculate fuel consumption (integrate flow rate over time), in
+        // 100 ms steps so tiny increments don't vanish in the float total
+        if (sniper.isFuelFlowValid() && current_time - last_fuel_calc_time >= 100) {
             float time_delta_hours = (current_time - last_fuel_calc_time) / 3600000.0f;  // Convert ms to hours
             float fuel_flow_gal_hr = sniper.convertLbHrToGalHr(sniper.getFuelFlow());
             float fuel_consumed_gal = fuel_flow_gal_hr * time_delta_hours;
             float fuel_consumed_liters = fuel_consumed_gal * 3.78541f;  // Convert gallons to liters
             total_fuel_consumed_liters += fuel_consumed_liters;
             last_fuel_calc_time = current_time;
+            updated = true;
         }
         
-        // === TOP CENTER: TOTAL FUEL CONSUMPTION (LITERS) ===
-        display.print(10, 10, "FUEL CONSUMED", YELLOW, BLACK, &LiberationSansNarrow_Bold16);
-        if (sniper.isFuelFlowValid()) {
-            char fuel_str[32];
-            snprintf(fuel_str, sizeof(fuel_str), "%.2f L", total_fuel_consumed_liters);
-            display.print(70, 35, fuel_str, WHITE, BLACK, &LiberationSansNarrow_Bold30);
-        } else {
-            display.print(85, 35, "-- L", RED, BLACK, &LiberationSansNarrow_Bold30);
-        }
-        
-        // === LEFT SIDE: COOLANT TEMPERATURE (CELSIUS) ===
-        display.print(10, 80, "COOLANT", CYAN, BLACK, &LiberationSansNarrow_Bold16);
-        if (sniper.isCoolantTempValid()) {
-            float temp_celsius = sniper.convertFahrenheitToCelsius(sniper.getCoolantTemp());
-            char temp_str[32];
-            snprintf(temp_str, sizeof(temp_str), "%.1f°C", temp_celsius);
-            
-            // Color coding for temperature
-            uint16_t temp_color = GREEN;
-            if (temp_celsius > 95.0f) temp_color = RED;       // Too hot
-            else if (temp_celsius > 85.0f) temp_color = ORANGE; // Warm
-            else if (temp_celsius < 70.0f) temp_color = BLUE;   // Cold
-            
-            display.print(10, 105, temp_str, temp_color, BLACK, &LiberationSansNarrow_Bold24);
-        } else {
-            display.print(10, 105, "--°C", RED, BLACK, &LiberationSansNarrow_Bold24);
-        }
-        
-        // === BOTTOM CENTER: RPM ===
-        display.print(95, 180, "RPM", YELLOW, BLACK, &LiberationSansNarrow_Bold16);
-        if (sniper.isRPMValid()) {
-            char rpm_str[32];
-            snprintf(rpm_str, sizeof(rpm_str), "%.0f", sniper.getRPM());
-            
-            // Color coding for RPM
-            uint16_t rpm_color = GREEN;
-            float rpm = sniper.getRPM();
-            if (rpm > 6500.0f) rpm_color = RED;        // Danger zone
-            else if (rpm > 5500.0f) rpm_color = ORANGE; // High RPM
-            else if (rpm > 4000.0f) rpm_color = YELLOW; // Medium RPM
-            
-            display.print(60, 205, rpm_str, rpm_color, BLACK, &LiberationSansNarrow_Bold36);
-        } else {
-            display.print(85, 205, "----", RED, BLACK, &LiberationSansNarrow_Bold36);
+        // Hand the new state to core1, and refresh it now and then so data
+        // going stale shows up even without traffic
+        if (updated || current_time - last_publish_time >= PUBLISH_PERIOD_MS) {
+            GaugeSnapshot snapshot;
+            snapshot.engine = sniper.getEngineData();
+            snapshot.rpm_valid = sniper.isRPMValid();
+            snapshot.coolant_temp_valid = sniper.isCoolantTempValid();
+            snapshot.fuel_flow_valid = sniper.isFuelFlowValid();
+            snapshot.afr_valid = sniper.getEngineData().afr_valid;
+            snapshot.fuel_consumed_liters = total_fuel_consumed_liters;
+            snapshots.publish(snapshot);
+            last_publish_time = current_time;
         }
         
-        // === RIGHT SIDE: ADDITIONAL INFO ===
-        // Current fuel flow rate
-        if (sniper.isFuelFlowValid()) {
-            display.print(130, 80, "FLOW", MAGENTA, BLACK, &LiberationSansNarrow_Bold16);
-            char flow_str[32];
-            float flow_lph = sniper.convertLbHrToGalHr(sniper.getFuelFlow()) * 3.78541f; // L/hr
-            snprintf(flow_str, sizeof(flow_str), "%.1fL/h", flow_lph);
-            display.print(130, 105, flow_str, WHITE, BLACK, &LiberationSansNarrow_Bold16);
-        }
+        busy_us += time_us_32() - start;
         
-        // AFR (Air-Fuel Ratio)
-        if (sniper.getEngineData().afr_valid) {
-            display.print(130, 130, "AFR", GREEN, BLACK, &LiberationSansNarrow_Bold16);
-            char afr_str[32];
-            snprintf(afr_str, sizeof(afr_str), "%.1f", sniper.getAFR());
-            display.print(130, 155, afr_str, WHITE, BLACK, &Font20);
+        // Report CAN filter effectiveness every 5 seconds
+        if (current_time - last_stats_time >= STATS_PERIOD_MS) {
+            uint32_t elapsed_us = (current_time - last_stats_time) * 1000;
+            sniper.printCANStats();
+            printf("Core0: %.1f%% busy, %lu snapshots published\n",
+                   100.0f * busy_us / elapsed_us, (unsigned long)snapshots.getVersion());
+            busy_us = 0;
+            last_stats_time = current_time;
         }
         
-        // === STATUS INDICATORS ===
-        // CAN communication status
-        uint32_t last_update = sniper.getLastUpdateTime();
-        bool can_ok = (current_time - last_update) < 2000; // 2 second timeout
-        
-        display.fillCircle(10, 220, 8, can_ok ? GREEN : RED);
-        display.print(25, 215, "CAN", WHITE, BLACK, &LiberationSansNarrow_Bold16);
-        
-        // Engine running status (based on RPM > 500)
-        bool engine_running = sniper.isRPMValid() && sniper.getRPM() > 500.0f;
-        display.fillCircle(220, 220, 8, engine_running ? GREEN : GRAY);
-        display.print(170, 215, "ENGINE", WHITE, BLACK, &LiberationSansNarrow_Bold16);
-        
-        // Update display
-        sleep_ms(100);  // 10Hz update rate
+        sleep_us(INTAKE_PERIOD_US);
     }
 }
@@ -1,6 +0,0 @@
-#ifndef _TORINO_LOGO_SM_H_
-#define _TORINO_LOGO_SM_H_
-
-extern const unsigned char torino_logo_sm[];
-
-#endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "Dashboard.h"
+
+static const ColorBand rpm_bands[] = {
+    {6500.0f, RED},     // Danger zone
+    {5500.0f, ORANGE},  // High RPM
+    {4000.0f, YELLOW},  // Medium RPM
+};
+
+static const ColorBand coolant_bands[] = {
+    {95.0f, RED},       // Too hot
+    {85.0f, ORANGE},    // Warm
+    {70.0f, GREEN},     // Below this it's cold
+};
+
+static float lb_hr_to_l_hr(float lb_hr) {
+    return HolleySniper::convertLbHrToGalHr(lb_hr) * 3.78541f;
+}
+
+static float fahrenheit_to_celsius(float fahrenheit) {
+    return HolleySniper::convertFahrenheitToCelsius(fahrenheit);
+}
+
+static uint16_t band_color(const ColorBand* bands, uint8_t count, uint16_t color, float value) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (value > bands[i].above) {
+            return bands[i].color;
+        }
+    }
+    return color;
+}
+
+// Holley value shown by a readout
+struct Dashboard::ReadoutBinding {
+    Readout Dashboard::* readout;
+    float HolleyEngineData::* value;
+    bool GaugeSnapshot::* valid;
+    float (*convert)(float);        // Unit conversion, nullptr shows the value as is
+    const ColorBand* bands;
+    uint8_t band_count;
+    uint16_t color;                 // Below every band
+    const char* invalid_text;       // nullptr hides the readout and its label instead
+    Label Dashboard::* label;
+};
+
+const Dashboard::ReadoutBinding Dashboard::readout_bindings[] = {
+    {&Dashboard::rpm_readout, &HolleyEngineData::rpm, &GaugeSnapshot::rpm_valid, nullptr,
+     rpm_bands, 3, GREEN, "----", nullptr},
+    {&Dashboard::coolant_readout, &HolleyEngineData::coolant_temp, &GaugeSnapshot::coolant_temp_valid, fahrenheit_to_celsius,
+     coolant_bands, 3, BLUE, "--°C", nullptr},
+    {&Dashboard::flow_readout, &HolleyEngineData::fuel_flow, &GaugeSnapshot::fuel_flow_valid, lb_hr_to_l_hr,
+     nullptr, 0, WHITE, nullptr, &Dashboard::label_flow},
+    {&Dashboard::afr_readout, &HolleyEngineData::air_fuel_ratio, &GaugeSnapshot::afr_valid, nullptr,
+     nullptr, 0, WHITE, nullptr, &Dashboard::label_afr},
+};
+
+Dashboard::Dashboard(GC9A01& display)
+    : label_fuel(display, 10, 10, "FUEL CONSUMED", YELLOW, BLACK, &LiberationSansNarrow_Bold16),
+      fuel_readout(display, 70, 35, 120, &LiberationSansNarrow_Bold30, "%.2f L", BLACK, ALIGN_CENTER),
+      label_coolant(display, 10, 80, "COOLANT", CYAN, BLACK, &LiberationSansNarrow_Bold16),
+      coolant_readout(display, 10, 105, 110, &LiberationSansNarrow_Bold24, "%.1f°C", BLACK),
+      label_rpm(display, 95, 180, "RPM", YELLOW, BLACK, &LiberationSansNarrow_Bold16),
+      rpm_readout(display, 60, 205, 120, &LiberationSansNarrow_Bold36, "%.0f", BLACK, ALIGN_CENTER),
+      rpm_arc(display, 120, 120, 118, 4, -45, 45, 0.0f, 7000.0f, ARC_TRACK_COLOR, BLACK),
+      label_flow(display, 130, 80, "FLOW", MAGENTA, BLACK, &LiberationSansNarrow_Bold16),
+      flow_readout(display, 130, 105, 90, &LiberationSansNarrow_Bold16, "%.1fL/h", BLACK),
+      label_afr(display, 130, 130, "AFR", GREEN, BLACK, &LiberationSansNarrow_Bold16),
+      afr_readout(display, 130, 155, 90, &Font20, "%.1f", BLACK),
+      can_dot(display, 10, 220, 8, RED, BLACK),
+      label_can(display, 25, 215, "CAN", WHITE, BLACK, &LiberationSansNarrow_Bold16),
+      engine_dot(display, 220, 220, 8, GRAY, BLACK),
+      label_engine(display, 170, 215, "ENGINE", WHITE, BLACK, &LiberationSansNarrow_Bold16) {
+    Widget* const widgets[] = {
+        &label_fuel, &fuel_readout, &label_coolant, &coolant_readout, &label_rpm, &rpm_readout, &rpm_arc,
+        &label_flow, &flow_readout, &label_afr, &afr_readout, &can_dot, &label_can, &engine_dot, &label_engine,
+    };
+    for (Widget* widget : widgets) {
+        screen.add(*widget);
+    }
+}
+
+uint8_t Dashboard::update(const GaugeSnapshot& snapshot, uint32_t current_time) {
+    const HolleyEngineData& engine = snapshot.engine;
+    
+    for (const ReadoutBinding& binding : readout_bindings) {
+        Readout& readout = this->*binding.readout;
+        bool valid = snapshot.*binding.valid;
+        if (binding.label) {
+            (this->*binding.label).setVisible(valid);
+            readout.setVisible(valid);
+        }
+        if (!valid) {
+            if (binding.invalid_text) {
+                readout.setText(binding.invalid_text, RED);
+            }
+            continue;
+        }
+        
+        float value = engine.*binding.value;
+        if (binding.convert) {
+            value = binding.convert(value);
+        }
+        readout.setValue(value, band_color(binding.bands, binding.band_count, binding.color, value));
+    }
+    
+    if (snapshot.fuel_flow_valid) {
+        fuel_readout.setValue(snapshot.fuel_consumed_liters, WHITE);
+    } else {
+        fuel_readout.setText("-- L", RED);
+    }
+    
+    if (snapshot.rpm_valid) {
+        rpm_arc.setValue(engine.rpm, band_color(rpm_bands, 3, GREEN, engine.rpm));
+    } else {
+        rpm_arc.setValue(0.0f, ARC_TRACK_COLOR);
+    }
+    
+    // CAN communication status, 2 second timeout. Signed, core0 may stamp a
+    // frame a millisecond after the caller read the clock
+    can_dot.setColor((int32_t)(current_time - engine.last_update_time) < 2000 ? GREEN : RED);
+    
+    // Engine running status (based on RPM > 500)
+    engine_dot.setColor(snapshot.rpm_valid && engine.rpm > 500.0f ? GREEN : GRAY);
+    
+    return screen.render();
+}
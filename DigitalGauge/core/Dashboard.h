@@ -0,0 +1,65 @@
+#ifndef DASHBOARD_H
+#define DASHBOARD_H
+
+#include "GC9A01.h"
+#include "HolleySniper.h"
+#include "Widgets.h"
+
+#define ARC_TRACK_COLOR   0x2104 // Dark gray
+
+// Engine state handed from core0 to core1, validity (data freshness) is
+// evaluated on core0 when the snapshot is taken
+struct GaugeSnapshot {
+    HolleyEngineData engine;
+    bool rpm_valid;
+    bool coolant_temp_valid;
+    bool fuel_flow_valid;
+    bool afr_valid;
+    float fuel_consumed_liters;
+};
+
+// Value range drawn in one colour, a binding lists them highest first
+struct ColorBand {
+    float above;
+    uint16_t color;
+};
+
+// The gauge screen: widget layout plus the mapping from a snapshot to the
+// widgets. Shared by the firmware and the host simulator (tools/gauge_sim).
+class Dashboard {
+private:
+    struct ReadoutBinding;
+    static const ReadoutBinding readout_bindings[];
+    
+    Label label_fuel;
+    Readout fuel_readout;
+    Label label_coolant;
+    Readout coolant_readout;
+    Label label_rpm;
+    Readout rpm_readout;
+    ArcGauge rpm_arc;
+    Label label_flow;
+    Readout flow_readout;
+    Label label_afr;
+    Readout afr_readout;
+    StatusDot can_dot;
+    Label label_can;
+    StatusDot engine_dot;
+    Label label_engine;
+    WidgetScreen screen;
+    
+public:
+    explicit Dashboard(GC9A01& display);
+    
+    // Paints every widget on the next update(), after the screen was cleared
+    void invalidate() { screen.invalidateAll(); }
+    
+    // Feeds a snapshot to the widgets, then repaints the ones whose output
+    // changed (into the framebuffer when enabled). Returns the widgets repainted.
+    uint8_t update(const GaugeSnapshot& snapshot, uint32_t current_time);
+    
+    uint32_t getRedraws() const { return screen.getRedraws(); }
+    void resetStats() { screen.resetStats(); }
+};
+
+#endif // DASHBOARD_H
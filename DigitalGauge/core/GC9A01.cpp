@@ -1,44 +1,76 @@
 #include "GC9A01.h"
+#include "hardware/irq.h"
 #include <cmath>
 #include <cstring>
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// The panel takes RGB565 MSB first, the framebuffer keeps pixels in that
+// order so rows can be sent straight from RAM
+static inline uint16_t toPanelOrder(uint16_t color) {
+    return (uint16_t)((color >> 8) | (color << 8));
+}
+
 GC9A01::GC9A01(spi_inst_t* spi, uint8_t cs, uint8_t dc, uint8_t rst, uint8_t bl) 
-    : spi_port(spi), pin_cs(cs), pin_dc(dc), pin_rst(rst), pin_bl(bl) {
+    : spi_port(spi), pin_cs(cs), pin_dc(dc), pin_rst(rst), pin_bl(bl),
+      framebuffer(nullptr), dirty_count(0), spi_bytes(0), flush_bytes(0), flush_rects(0), glyph_blit(true), glyph_cache(nullptr),
+      dma_channel(-1), dma_active(false), dma_release_cs(false), dma_notify(false),
+      dma_callback(nullptr), dma_callback_context(nullptr), fill_pattern(0) {
+    frame_start_us = 0;
+    frame_period_us = 0;
+    frame_spi_start = 0;
+    frame_open = false;
+    flush_start_us = 0;
+    flush_end_us = 0;
+    flush_pending = false;
+    stats_overlay = false;
+    overlay_x = 0;
+    overlay_y = 0;
+    resetFrameStats();
 }
 
+GC9A01* GC9A01::dma_instance = nullptr;
+
 void GC9A01::writeCommand(uint8_t cmd) {
+    waitIdle();
     gpio_put(pin_dc, 0);  // Command mode
     gpio_put(pin_cs, 0);  // Select device
     spi_write_blocking(spi_port, &cmd, 1);
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += 1;
 }
 
 void GC9A01::writeData(uint8_t data) {
+    waitIdle();
     gpio_put(pin_dc, 1);  // Data mode
     gpio_put(pin_cs, 0);  // Select device
     spi_write_blocking(spi_port, &data, 1);
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += 1;
 }
 
 void GC9A01::writeData16(uint16_t data) {
+    waitIdle();
     uint8_t buffer[2] = {(uint8_t)(data >> 8), (uint8_t)(data & 0xFF)};
     gpio_put(pin_dc, 1);  // Data mode
     gpio_put(pin_cs, 0);  // Select device
     spi_write_blocking(spi_port, buffer, 2);
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += 2;
 }
 
 void GC9A01::writeDataBuffer(uint8_t* buffer, size_t len) {
+    waitIdle();
     gpio_put(pin_dc, 1);  // Data mode
     gpio_put(pin_cs, 0);  // Select device
     spi_write_blocking(spi_port, buffer, len);
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += len;
 }
 
 void GC9A01::init() {
@@ -341,6 +373,339 @@ void GC9A01::displayOff() {
     writeCommand(GC9A01_DISPOFF);
 }
 
+// Allocates the 240x240 RGB565 framebuffer (115 KB). The first flush()
+// rewrites the whole panel so RAM and panel start out identical.
+bool GC9A01::enableFramebuffer() {
+    if (framebuffer) {
+        return true;
+    }
+    
+    // Drawing no longer waits for the engine once this is set
+    waitIdle();
+    framebuffer = (uint16_t*)calloc(GC9A01_WIDTH * GC9A01_HEIGHT, sizeof(uint16_t));
+    if (!framebuffer) {
+        return false;
+    }
+    
+    dirty_count = 0;
+    markDirty(0, 0, GC9A01_WIDTH - 1, GC9A01_HEIGHT - 1);
+    return true;
+}
+
+// Adds a damaged region. Regions touching an existing one are merged into it;
+// once the list is full the new region joins the rectangle it grows the least.
+void GC9A01::markDirty(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+    for (uint8_t i = 0; i < dirty_count; i++) {
+        GC9A01Rect& rect = dirty[i];
+        if (x0 <= rect.x1 + 1 && x1 + 1 >= rect.x0 && y0 <= rect.y1 + 1 && y1 + 1 >= rect.y0) {
+            if (x0 < rect.x0) rect.x0 = x0;
+            if (y0 < rect.y0) rect.y0 = y0;
+            if (x1 > rect.x1) rect.x1 = x1;
+            if (y1 > rect.y1) rect.y1 = y1;
+            mergeDirty(i);
+            return;
+        }
+    }
+    
+    if (dirty_count < GC9A01_MAX_DIRTY_RECTS) {
+        dirty[dirty_count++] = {x0, y0, x1, y1};
+        return;
+    }
+    
+    uint8_t best = 0;
+    uint32_t best_growth = UINT32_MAX;
+    for (uint8_t i = 0; i < dirty_count; i++) {
+        const GC9A01Rect& rect = dirty[i];
+        uint32_t w = (x1 > rect.x1 ? x1 : rect.x1) - (x0 < rect.x0 ? x0 : rect.x0) + 1;
+        uint32_t h = (y1 > rect.y1 ? y1 : rect.y1) - (y0 < rect.y0 ? y0 : rect.y0) + 1;
+        uint32_t growth = w * h - (uint32_t)(rect.x1 - rect.x0 + 1) * (rect.y1 - rect.y0 + 1);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    
+    GC9A01Rect& rect = dirty[best];
+    if (x0 < rect.x0) rect.x0 = x0;
+    if (y0 < rect.y0) rect.y0 = y0;
+    if (x1 > rect.x1) rect.x1 = x1;
+    if (y1 > rect.y1) rect.y1 = y1;
+    mergeDirty(best);
+}
+
+// A grown rectangle may now overlap others, fold them in until none does
+void GC9A01::mergeDirty(uint8_t index) {
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        GC9A01Rect& rect = dirty[index];
+        for (uint8_t i = 0; i < dirty_count; i++) {
+            if (i == index) continue;
+            const GC9A01Rect& other = dirty[i];
+            if (other.x0 <= rect.x1 + 1 && other.x1 + 1 >= rect.x0 && other.y0 <= rect.y1 + 1 && other.y1 + 1 >= rect.y0) {
+                if (other.x0 < rect.x0) rect.x0 = other.x0;
+                if (other.y0 < rect.y0) rect.y0 = other.y0;
+                if (other.x1 > rect.x1) rect.x1 = other.x1;
+                if (other.y1 > rect.y1) rect.y1 = other.y1;
+                
+                // Move the last entry into the freed slot
+                dirty[i] = dirty[--dirty_count];
+                if (index == dirty_count) index = i;
+                merged = true;
+                break;
+            }
+        }
+    }
+}
+
+// Sends every damaged window from the framebuffer, one address window each.
+// With DMA it returns while the last tile is still going out; the tiles are
+// copies, so drawing the next frame right away is safe.
+void GC9A01::flush() {
+    uint32_t render_end = time_us_32();
+    waitIdle();
+    foldFlushTime();
+    
+    if (frame_open) {
+        uint32_t render_us = render_end - frame_start_us;
+        frame_stats.render_us = render_us;
+        frame_stats.render_total_us += render_us;
+        if (render_us > frame_stats.render_max_us) frame_stats.render_max_us = render_us;
+    }
+    if (stats_overlay) {
+        drawStatsOverlay();
+    }
+    
+    flush_start_us = time_us_32();
+    flush_pending = false;
+    flushDirty();
+    
+    if (frame_open) {
+        uint32_t bytes = spi_bytes - frame_spi_start;
+        frame_stats.spi_bytes = bytes;
+        frame_stats.spi_total_bytes += bytes;
+        if (bytes > frame_stats.spi_max_bytes) frame_stats.spi_max_bytes = bytes;
+        frame_stats.frames++;
+        frame_open = false;
+    }
+}
+
+void GC9A01::flushDirty() {
+    if (!framebuffer) {
+        notifyIdle();
+        return;
+    }
+    
+    uint32_t start = spi_bytes;
+    for (uint8_t i = 0; i < dirty_count; i++) {
+        const GC9A01Rect& rect = dirty[i];
+        uint16_t w = rect.x1 - rect.x0 + 1;
+        bool last = i + 1 == dirty_count;
+        
+        setAddressWindow(rect.x0, rect.y0, rect.x1, rect.y1);
+        gpio_put(pin_dc, 1);  // Data mode
+        gpio_put(pin_cs, 0);  // Select device
+        
+        if (dma_channel >= 0) {
+            // Always through the tiles, even full width rows: DMA must not read
+            // the framebuffer while the next frame is drawn into it
+            flushTiles(rect, last);
+            continue;
+        }
+        
+        for (uint16_t y = rect.y0; y <= rect.y1; y++) {
+            spi_write_blocking(spi_port, (const uint8_t*)&framebuffer[y * GC9A01_WIDTH + rect.x0], w * 2);
+        }
+        gpio_put(pin_cs, 1);  // Deselect device
+        spi_bytes += (uint32_t)w * (rect.y1 - rect.y0 + 1) * 2;
+    }
+    
+    flush_bytes = spi_bytes - start;
+    flush_rects = dirty_count;
+    if (dma_channel < 0 || dirty_count == 0) {
+        notifyIdle();
+    }
+    dirty_count = 0;
+}
+
+// Packs the rows of a window into the two tile buffers in turn, so the next
+// tile is copied while DMA sends the previous one
+void GC9A01::flushTiles(const GC9A01Rect& rect, bool notify) {
+    size_t row_bytes = (size_t)(rect.x1 - rect.x0 + 1) * 2;
+    uint16_t rows_per_tile = GC9A01_DMA_TILE_BYTES / row_bytes;
+    uint8_t tile = 0;
+    
+    for (uint16_t y = rect.y0; y <= rect.y1; y += rows_per_tile) {
+        uint16_t rows = rect.y1 - y + 1;
+        if (rows > rows_per_tile) rows = rows_per_tile;
+        
+        uint8_t* dst = tiles[tile];
+        for (uint16_t row = 0; row < rows; row++) {
+            memcpy(dst + row * row_bytes, &framebuffer[(y + row) * GC9A01_WIDTH + rect.x0], row_bytes);
+        }
+        
+        bool end = y + rows > rect.y1;
+        waitIdle();
+        startDMA(dst, rows * row_bytes, false, end, notify && end);
+        tile ^= 1;
+    }
+}
+
+// Claims a DMA channel fed by the SPI TX DREQ, completion is reported through
+// the shared DMA_IRQ_0 handler. Only one display can use DMA.
+bool GC9A01::enableDMA() {
+    if (dma_channel >= 0) {
+        return true;
+    }
+    if (dma_instance) {
+        return false;
+    }
+    
+    dma_channel = dma_claim_unused_channel(false);
+    if (dma_channel < 0) {
+        return false;
+    }
+    
+    dma_instance = this;
+    dma_channel_set_irq0_enabled(dma_channel, true);
+    irq_add_shared_handler(DMA_IRQ_0, dmaIrqHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+    return true;
+}
+
+void GC9A01::setFlushCallback(void (*callback)(void* context), void* context) {
+    waitIdle();
+    dma_callback = callback;
+    dma_callback_context = context;
+}
+
+void GC9A01::waitIdle() {
+    while (dma_active) {
+        tight_loop_contents();
+    }
+}
+
+// Starts a transfer of len bytes to the SPI data register. CS and DC must
+// already be set. repeat sends the 2 bytes at src over and over.
+void GC9A01::startDMA(const uint8_t* src, size_t len, bool repeat, bool release_cs, bool notify) {
+    dma_channel_config config = dma_channel_get_default_config(dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+    channel_config_set_dreq(&config, spi_get_dreq(spi_port, true));
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+    if (repeat) {
+        channel_config_set_ring(&config, false, 1);  // Reads wrap every 2 bytes
+    }
+    
+    dma_release_cs = release_cs;
+    dma_notify = notify;
+    dma_active = true;
+    spi_bytes += len;
+    dma_channel_configure(dma_channel, &config, &spi_get_hw(spi_port)->dr, src, len, true);
+}
+
+void GC9A01::dmaIrqHandler() {
+    GC9A01* display = dma_instance;
+    if (!display || !dma_channel_get_irq0_status(display->dma_channel)) {
+        return;
+    }
+    dma_channel_acknowledge_irq0(display->dma_channel);
+    display->dmaComplete();
+}
+
+void GC9A01::dmaComplete() {
+    if (dma_release_cs) {
+        // DMA is done once the FIFO has the last bytes, wait for them to shift out
+        while (spi_is_busy(spi_port)) {
+            tight_loop_contents();
+        }
+        gpio_put(pin_cs, 1);  // Deselect device
+        
+        // Nothing reads RX during DMA, drop what piled up and the overrun flag
+        while (spi_is_readable(spi_port)) {
+            (void)spi_get_hw(spi_port)->dr;
+        }
+        spi_get_hw(spi_port)->icr = SPI_SSPICR_RORIC_BITS;
+    }
+    
+    dma_active = false;
+    if (dma_notify) {
+        dma_notify = false;
+        notifyIdle();
+    }
+}
+
+void GC9A01::notifyIdle() {
+    flush_end_us = time_us_32();
+    flush_pending = true;
+    if (dma_callback) {
+        dma_callback(dma_callback_context);
+    }
+}
+
+void GC9A01::beginFrame() {
+    uint32_t now = time_us_32();
+    frame_period_us = frame_start_us ? now - frame_start_us : 0;
+    frame_start_us = now;
+    frame_spi_start = spi_bytes;
+    frame_open = true;
+}
+
+// Called once the engine is idle, so the last flush has finished
+void GC9A01::foldFlushTime() {
+    if (!flush_pending) {
+        return;
+    }
+    flush_pending = false;
+    
+    uint32_t spi_us = flush_end_us - flush_start_us;
+    frame_stats.spi_us = spi_us;
+    frame_stats.spi_total_us += spi_us;
+    if (spi_us > frame_stats.spi_max_us) frame_stats.spi_max_us = spi_us;
+}
+
+GC9A01FrameStats GC9A01::getFrameStats() {
+    waitIdle();
+    foldFlushTime();
+    frame_stats.elapsed_us = time_us_32() - stats_start_us;
+    return frame_stats;
+}
+
+void GC9A01::resetFrameStats() {
+    memset(&frame_stats, 0, sizeof(frame_stats));
+    stats_start_us = time_us_32();
+}
+
+void GC9A01::printFrameStats() {
+    GC9A01FrameStats stats = getFrameStats();
+    uint32_t frames = stats.frames ? stats.frames : 1;
+    
+    ::printf("Display: %lu frames, %.1f fps, render avg %lu max %lu us, SPI avg %lu max %lu us, "
+           "avg %lu max %lu bytes/frame (%lu B/s)\n",
+           (unsigned long)stats.frames, stats.elapsed_us ? stats.frames * 1000000.0f / stats.elapsed_us : 0.0f,
+           (unsigned long)(stats.render_total_us / frames), (unsigned long)stats.render_max_us,
+           (unsigned long)(stats.spi_total_us / frames), (unsigned long)stats.spi_max_us,
+           (unsigned long)(stats.spi_total_bytes / frames), (unsigned long)stats.spi_max_bytes,
+           (unsigned long)(stats.elapsed_us ? stats.spi_total_bytes * 1000000 / stats.elapsed_us : 0));
+    resetFrameStats();
+}
+
+void GC9A01::setStatsOverlay(bool enabled, uint16_t x, uint16_t y) {
+    stats_overlay = enabled;
+    overlay_x = x;
+    overlay_y = y;
+}
+
+// Previous frame's numbers in a fixed width field, so it only costs SPI
+// bytes when they change
+void GC9A01::drawStatsOverlay() {
+    char text[32];
+    snprintf(text, sizeof(text), "%2lufps %4.1fms %5luB",
+             (unsigned long)(frame_period_us ? 1000000 / frame_period_us : 0),
+             frame_stats.render_us / 1000.0f, (unsigned long)frame_stats.spi_bytes);
+    printField(overlay_x, overlay_y, 20 * Font8.Width, text, WHITE, BLACK, &Font8);
+}
+
 void GC9A01::setAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
     writeCommand(GC9A01_CASET);
     writeData16(x0);
@@ -360,6 +725,16 @@ void GC9A01::fillScreen(uint16_t color) {
 void GC9A01::drawPixel(uint16_t x, uint16_t y, uint16_t color) {
     if (x >= GC9A01_WIDTH || y >= GC9A01_HEIGHT) return;
     
+    if (framebuffer) {
+        uint16_t& pixel = framebuffer[y * GC9A01_WIDTH + x];
+        uint16_t value = toPanelOrder(color);
+        if (pixel != value) {
+            pixel = value;
+            markDirty(x, y, x, y);
+        }
+        return;
+    }
+    
     setAddressWindow(x, y, x, y);
     writeData16(color);
 }
@@ -423,18 +798,55 @@ void GC9A01::fillRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c
     
     if (x + w > GC9A01_WIDTH) w = GC9A01_WIDTH - x;
     if (y + h > GC9A01_HEIGHT) h = GC9A01_HEIGHT - y;
+    if (w == 0 || h == 0) return;
+    
+    if (framebuffer) {
+        // Only the bounding box of pixels that change becomes dirty
+        uint16_t value = toPanelOrder(color);
+        uint16_t x0 = GC9A01_WIDTH, y0 = GC9A01_HEIGHT, x1 = 0, y1 = 0;
+        for (uint16_t row = y; row < y + h; row++) {
+            uint16_t* pixel = &framebuffer[row * GC9A01_WIDTH + x];
+            for (uint16_t col = 0; col < w; col++) {
+                if (pixel[col] != value) {
+                    pixel[col] = value;
+                    if (x + col < x0) x0 = x + col;
+                    if (x + col > x1) x1 = x + col;
+                    if (row < y0) y0 = row;
+                    y1 = row;
+                }
+            }
+        }
+        if (y0 < GC9A01_HEIGHT) {
+            markDirty(x0, y0, x1, y1);
+        }
+        return;
+    }
     
     setAddressWindow(x, y, x + w - 1, y + h - 1);
-    
-    uint8_t buffer[2] = {(uint8_t)(color >> 8), (uint8_t)(color & 0xFF)};
     gpio_put(pin_dc, 1);  // Data mode
     gpio_put(pin_cs, 0);  // Select device
     
-    for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
-        spi_write_blocking(spi_port, buffer, 2);
+    uint32_t total_bytes = (uint32_t)w * h * 2;
+    if (dma_channel >= 0) {
+        // setAddressWindow waited for the engine, the pattern is free to change
+        fill_pattern = toPanelOrder(color);
+        startDMA((const uint8_t*)&fill_pattern, total_bytes, true, true, false);
+        return;
+    }
+    
+    // Replicate the color over a tile and send it in tile sized chunks
+    uint16_t* pattern = (uint16_t*)tiles[0];
+    uint32_t pattern_bytes = total_bytes < GC9A01_DMA_TILE_BYTES ? total_bytes : GC9A01_DMA_TILE_BYTES;
+    for (uint32_t i = 0; i < pattern_bytes / 2; i++) {
+        pattern[i] = toPanelOrder(color);
+    }
+    for (uint32_t offset = 0; offset < total_bytes; offset += pattern_bytes) {
+        uint32_t bytes_to_send = total_bytes - offset < pattern_bytes ? total_bytes - offset : pattern_bytes;
+        spi_write_blocking(spi_port, tiles[0], bytes_to_send);
     }
     
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += total_bytes;
 }
 
 void GC9A01::drawCircle(uint16_t x0, uint16_t y0, uint16_t r, uint16_t color) {
@@ -632,6 +1044,13 @@ void GC9A01::drawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t b
     uint32_t char_offset = (c - 32) * font->Height * ((font->Width + 7) / 8);
     const uint8_t* char_data = &font->table[char_offset];
     
+    // Opaque glyphs cover their whole cell and can be sent as one block,
+    // transparent ones (bg == color) still go pixel by pixel
+    if (glyph_blit && bg != color) {
+        blitGlyph(x, y, c, char_data, font, color, bg);
+        return;
+    }
+    
     for (uint16_t row = 0; row < font->Height; row++) {
         for (uint16_t col = 0; col < font->Width; col++) {
             // Calculate byte and bit position
@@ -648,6 +1067,119 @@ void GC9A01::drawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t b
     }
 }
 
+// Expands the 1bpp glyph rows into RGB565. In framebuffer mode that happens in
+// place (only changed pixels become dirty); otherwise rows are staged in the
+// tile buffers and the glyph goes out through a single address window.
+// A cached glyph is copied row by row, or sent as is when it isn't clipped.
+void GC9A01::blitGlyph(uint16_t x, uint16_t y, char c, const uint8_t* glyph, sFONT* font, uint16_t color, uint16_t bg) {
+    if (x >= GC9A01_WIDTH || y >= GC9A01_HEIGHT) return;
+    
+    uint16_t bytes_per_row = (font->Width + 7) / 8;
+    uint16_t w = font->Width;
+    uint16_t h = font->Height;
+    if (x + w > GC9A01_WIDTH) w = GC9A01_WIDTH - x;
+    if (y + h > GC9A01_HEIGHT) h = GC9A01_HEIGHT - y;
+    
+    uint16_t fg_value = toPanelOrder(color);
+    uint16_t bg_value = toPanelOrder(bg);
+    
+    if (framebuffer) {
+        const uint16_t* cached = glyph_cache ? glyph_cache->get(font, c, color, bg, glyph) : nullptr;
+        uint16_t x0 = GC9A01_WIDTH, y0 = GC9A01_HEIGHT, x1 = 0, y1 = 0;
+        for (uint16_t row = 0; row < h; row++) {
+            uint16_t* pixel = &framebuffer[(y + row) * GC9A01_WIDTH + x];
+            if (cached) {
+                const uint16_t* src = &cached[row * font->Width];
+                if (memcmp(pixel, src, w * 2) == 0) {
+                    continue;
+                }
+                for (uint16_t col = 0; col < w; col++) {
+                    if (pixel[col] != src[col]) {
+                        if (x + col < x0) x0 = x + col;
+                        break;
+                    }
+                }
+                for (uint16_t col = w; col-- > 0;) {
+                    if (pixel[col] != src[col]) {
+                        if (x + col > x1) x1 = x + col;
+                        break;
+                    }
+                }
+                if (y + row < y0) y0 = y + row;
+                y1 = y + row;
+                memcpy(pixel, src, w * 2);
+                continue;
+            }
+            
+            const uint8_t* bits = &glyph[row * bytes_per_row];
+            for (uint16_t col = 0; col < w; col++) {
+                uint16_t value = (bits[col >> 3] & (0x80 >> (col & 7))) ? fg_value : bg_value;
+                if (pixel[col] != value) {
+                    pixel[col] = value;
+                    if (x + col < x0) x0 = x + col;
+                    if (x + col > x1) x1 = x + col;
+                    if (y + row < y0) y0 = y + row;
+                    y1 = y + row;
+                }
+            }
+        }
+        if (y0 < GC9A01_HEIGHT) {
+            markDirty(x0, y0, x1, y1);
+        }
+        return;
+    }
+    
+    setAddressWindow(x, y, x + w - 1, y + h - 1);
+    gpio_put(pin_dc, 1);  // Data mode
+    gpio_put(pin_cs, 0);  // Select device
+    
+    // The engine is idle after setAddressWindow, so a miss may evict (free)
+    // a glyph without pulling it from under a DMA transfer
+    const uint16_t* cached = glyph_cache ? glyph_cache->get(font, c, color, bg, glyph) : nullptr;
+    if (cached && w == font->Width) {
+        size_t total_bytes = (size_t)w * h * 2;
+        if (dma_channel >= 0) {
+            startDMA((const uint8_t*)cached, total_bytes, false, true, false);
+            return;
+        }
+        spi_write_blocking(spi_port, (const uint8_t*)cached, total_bytes);
+        spi_bytes += total_bytes;
+        gpio_put(pin_cs, 1);  // Deselect device
+        return;
+    }
+    
+    size_t row_bytes = (size_t)w * 2;
+    uint16_t rows_per_tile = GC9A01_DMA_TILE_BYTES / row_bytes;
+    uint8_t tile = 0;
+    
+    for (uint16_t row = 0; row < h; row += rows_per_tile) {
+        uint16_t rows = h - row;
+        if (rows > rows_per_tile) rows = rows_per_tile;
+        
+        uint16_t* dst = (uint16_t*)tiles[tile];
+        for (uint16_t r = 0; r < rows; r++) {
+            const uint8_t* bits = &glyph[(row + r) * bytes_per_row];
+            for (uint16_t col = 0; col < w; col++) {
+                *dst++ = (bits[col >> 3] & (0x80 >> (col & 7))) ? fg_value : bg_value;
+            }
+        }
+        
+        if (dma_channel >= 0) {
+            bool end = row + rows >= h;
+            waitIdle();
+            startDMA(tiles[tile], rows * row_bytes, false, end, false);
+            tile ^= 1;
+        } else {
+            spi_write_blocking(spi_port, tiles[tile], rows * row_bytes);
+            spi_bytes += rows * row_bytes;
+        }
+    }
+    
+    if (dma_channel < 0) {
+        gpio_put(pin_cs, 1);  // Deselect device
+    }
+}
+
 uint16_t GC9A01::getCharSpacing(char c, sFONT* font) {
     // Character-specific spacing adjustments - only reduce spacing for narrow characters
     switch (c) {
@@ -688,6 +1220,24 @@ void GC9A01::print(uint16_t x, uint16_t y, const char* text, uint16_t color, uin
     }
 }
 
+uint16_t GC9A01::textWidth(const char* text, sFONT* font) {
+    uint16_t width = 0;
+    while (*text) {
+        width += getCharSpacing(*text++, font);
+    }
+    return width;
+}
+
+// Prints text and paints the rest of a fixed width field with bg, so a value
+// that got shorter needs no separate clear (and no clear-then-redraw flicker)
+void GC9A01::printField(uint16_t x, uint16_t y, uint16_t width, const char* text, uint16_t color, uint16_t bg, sFONT* font) {
+    print(x, y, text, color, bg, font);
+    uint16_t used = textWidth(text, font);
+    if (used < width) {
+        fillRect(x + used, y, width - used, font->Height, bg);
+    }
+}
+
 void GC9A01::printf(uint16_t x, uint16_t y, uint16_t color, uint16_t bg, sFONT* font, const char* format, ...) {
     char buffer[256];
     va_list args;
@@ -701,9 +1251,33 @@ void GC9A01::drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uns
     if (x >= GC9A01_WIDTH || y >= GC9A01_HEIGHT) return;
     
     // Clip to screen boundaries
+    uint16_t stride = w;
     if (x + w > GC9A01_WIDTH) w = GC9A01_WIDTH - x;
     if (y + h > GC9A01_HEIGHT) h = GC9A01_HEIGHT - y;
     
+    if (framebuffer) {
+        // Image bytes are already in panel order
+        uint16_t x0 = GC9A01_WIDTH, y0 = GC9A01_HEIGHT, x1 = 0, y1 = 0;
+        for (uint16_t row = 0; row < h; row++) {
+            const unsigned char* src = &image_data[(uint32_t)row * stride * 2];
+            uint16_t* pixel = &framebuffer[(y + row) * GC9A01_WIDTH + x];
+            for (uint16_t col = 0; col < w; col++) {
+                uint16_t value = (uint16_t)(src[col * 2] | (src[col * 2 + 1] << 8));
+                if (pixel[col] != value) {
+                    pixel[col] = value;
+                    if (x + col < x0) x0 = x + col;
+                    if (x + col > x1) x1 = x + col;
+                    if (y + row < y0) y0 = y + row;
+                    y1 = y + row;
+                }
+            }
+        }
+        if (y0 < GC9A01_HEIGHT) {
+            markDirty(x0, y0, x1, y1);
+        }
+        return;
+    }
+    
     setAddressWindow(x, y, x + w - 1, y + h - 1);
     
     // Send image data directly (assuming RGB565 format)
@@ -714,12 +1288,18 @@ void GC9A01::drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uns
     const size_t chunk_size = 1024;  // Send 1KB at a time
     size_t total_bytes = w * h * 2;  // 2 bytes per pixel for RGB565
     
+    if (dma_channel >= 0) {
+        startDMA(image_data, total_bytes, false, true, false);
+        return;
+    }
+    
     for (size_t offset = 0; offset < total_bytes; offset += chunk_size) {
         size_t bytes_to_send = (offset + chunk_size > total_bytes) ? (total_bytes - offset) : chunk_size;
         spi_write_blocking(spi_port, &image_data[offset], bytes_to_send);
     }
     
     gpio_put(pin_cs, 1);  // Deselect device
+    spi_bytes += total_bytes;
 }
 
 uint16_t GC9A01::color565(uint8_t r, uint8_t g, uint8_t b) {
@@ -745,61 +1325,392 @@ uint16_t GC9A01::interpolateColor(uint16_t color1, uint16_t color2, float factor
     return (r << 11) | (g << 5) | b;
 }
 
-void GC9A01::drawGauge(uint16_t centerX, uint16_t centerY, uint16_t radius, 
-                       float value, float minVal, float maxVal, 
-                       uint16_t needleColor, uint16_t scaleColor) {
-    // Draw outer circle
-    drawCircle(centerX, centerY, radius, scaleColor);
-    drawCircle(centerX, centerY, radius - 1, scaleColor);
+// Fixed-point cos/sin (Q14) for every gauge step, filled on first use
+static int16_t gauge_cos[GC9A01_GAUGE_STEPS + 1];
+static int16_t gauge_sin[GC9A01_GAUGE_STEPS + 1];
+static bool gauge_tables_ready = false;
+
+// Scratch for drawNeedle(), kept off the (small) core stacks
+static GC9A01NeedleSpan needle_spans[GC9A01_HEIGHT];
+static uint8_t needle_coverage[GC9A01_HEIGHT * 2];
+static uint16_t run_pixels[GC9A01_WIDTH];
+
+static void initGaugeTables() {
+    if (gauge_tables_ready) return;
     
-    // Calculate needle angle (270 degrees range, starting from -135 degrees)
-    float angleRange = 270.0f;  // degrees
-    float startAngle = -135.0f; // degrees
+    for (int i = 0; i <= GC9A01_GAUGE_STEPS; i++) {
+        float angle = (GC9A01_GAUGE_START + (float)i * GC9A01_GAUGE_SWEEP / GC9A01_GAUGE_STEPS) * M_PI / 180.0f;
+        gauge_cos[i] = (int16_t)lroundf(cosf(angle) * 16384.0f);
+        gauge_sin[i] = (int16_t)lroundf(sinf(angle) * 16384.0f);
+    }
+    gauge_tables_ready = true;
+}
+
+static int16_t gaugeStep(float value, float minVal, float maxVal) {
     float normalizedValue = (value - minVal) / (maxVal - minVal);
     if (normalizedValue < 0) normalizedValue = 0;
     if (normalizedValue > 1) normalizedValue = 1;
+    return (int16_t)lroundf(normalizedValue * GC9A01_GAUGE_STEPS);
+}
+
+// Mixes two RGB565 colours, alpha 0..256 weighs fg
+static inline uint16_t blend565(uint16_t fg, uint16_t bg, uint32_t alpha) {
+    uint32_t rb = (((fg & 0xF81F) * alpha + (bg & 0xF81F) * (256 - alpha)) >> 8) & 0xF81F;
+    uint32_t g = (((fg & 0x07E0) * alpha + (bg & 0x07E0) * (256 - alpha)) >> 8) & 0x07E0;
+    return (uint16_t)(rb | g);
+}
+
+void GC9A01::drawGauge(uint16_t centerX, uint16_t centerY, uint16_t radius, 
+                       float value, float minVal, float maxVal, 
+                       uint16_t needleColor, uint16_t scaleColor) {
+    static GC9A01Needle needle;
     
-    float needleAngle = startAngle + (normalizedValue * angleRange);
-    float needleRad = needleAngle * M_PI / 180.0f;
-    
-    // Draw needle
-    uint16_t needleLength = radius - 10;
-    int16_t needleX = centerX + (int16_t)(needleLength * cos(needleRad));
-    int16_t needleY = centerY + (int16_t)(needleLength * sin(needleRad));
+    drawGaugeFace(centerX, centerY, radius, scaleColor);
     
-    // Draw thick needle
-    drawLine(centerX, centerY, needleX, needleY, needleColor);
-    drawLine(centerX - 1, centerY, needleX - 1, needleY, needleColor);
-    drawLine(centerX + 1, centerY, needleX + 1, needleY, needleColor);
-    drawLine(centerX, centerY - 1, needleX, needleY - 1, needleColor);
-    drawLine(centerX, centerY + 1, needleX, needleY + 1, needleColor);
+    // Nothing to erase: a fresh needle over a black face
+    initNeedle(needle, centerX, centerY, radius - 10, 3, {nullptr, 0, 0, 0, 0, BLACK});
+    drawNeedle(needle, value, minVal, maxVal, needleColor);
     
     // Draw center dot
     fillCircle(centerX, centerY, 4, needleColor);
+}
+
+void GC9A01::drawGaugeFace(uint16_t centerX, uint16_t centerY, uint16_t radius, uint16_t scaleColor) {
+    initGaugeTables();
+    
+    // Draw outer circle
+    drawCircle(centerX, centerY, radius, scaleColor);
+    drawCircle(centerX, centerY, radius - 1, scaleColor);
     
     // Draw scale marks
     for (int i = 0; i <= 10; i++) {
-        float markAngle = startAngle + (i * angleRange / 10.0f);
-        float markRad = markAngle * M_PI / 180.0f;
+        int step = i * GC9A01_GAUGE_STEPS / 10;
+        int32_t c = gauge_cos[step];
+        int32_t s = gauge_sin[step];
         
-        uint16_t outerX = centerX + (uint16_t)((radius - 5) * cos(markRad));
-        uint16_t outerY = centerY + (uint16_t)((radius - 5) * sin(markRad));
-        uint16_t innerX = centerX + (uint16_t)((radius - 15) * cos(markRad));
-        uint16_t innerY = centerY + (uint16_t)((radius - 15) * sin(markRad));
+        uint16_t outerX = centerX + (((radius - 5) * c + 8192) >> 14);
+        uint16_t outerY = centerY + (((radius - 5) * s + 8192) >> 14);
+        uint16_t innerX = centerX + (((radius - 15) * c + 8192) >> 14);
+        uint16_t innerY = centerY + (((radius - 15) * s + 8192) >> 14);
         
         drawLine(innerX, innerY, outerX, outerY, scaleColor);
     }
 }
 
+void GC9A01::initNeedle(GC9A01Needle& needle, uint16_t centerX, uint16_t centerY, uint16_t length, uint8_t width,
+                        const GC9A01Background& background) {
+    needle.cx = centerX;
+    needle.cy = centerY;
+    needle.length = length;
+    needle.width = width;
+    needle.background = background;
+    needle.step = -1;
+    needle.color = 0;
+    needle.columns = false;
+    needle.span_count = 0;
+}
+
+// Copies a framebuffer region (panel byte order) to use as a needle background
+bool GC9A01::captureRegion(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels) {
+    if (!framebuffer || x + w > GC9A01_WIDTH || y + h > GC9A01_HEIGHT) {
+        return false;
+    }
+    for (uint16_t row = 0; row < h; row++) {
+        memcpy(&pixels[row * w], &framebuffer[(y + row) * GC9A01_WIDTH + x], w * 2);
+    }
+    return true;
+}
+
+// Writes a small block of panel ordered pixels (a needle run)
+void GC9A01::writePixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels) {
+    if (framebuffer) {
+        bool changed = false;
+        for (uint16_t row = 0; row < h; row++) {
+            uint16_t* dst = &framebuffer[(y + row) * GC9A01_WIDTH + x];
+            if (memcmp(dst, &pixels[row * w], w * 2) != 0) {
+                memcpy(dst, &pixels[row * w], w * 2);
+                changed = true;
+            }
+        }
+        if (changed) {
+            markDirty(x, y, x + w - 1, y + h - 1);
+        }
+        return;
+    }
+    
+    setAddressWindow(x, y, x + w - 1, y + h - 1);
+    gpio_put(pin_dc, 1);  // Data mode
+    gpio_put(pin_cs, 0);  // Select device
+    
+    // The engine is idle after setAddressWindow, stage the run in a tile
+    // since the caller reuses its buffer right away
+    size_t total_bytes = (size_t)w * h * 2;
+    if (dma_channel >= 0 && total_bytes <= GC9A01_DMA_TILE_BYTES) {
+        memcpy(tiles[0], pixels, total_bytes);
+        startDMA(tiles[0], total_bytes, false, true, false);
+        return;
+    }
+    spi_write_blocking(spi_port, (const uint8_t*)pixels, total_bytes);
+    spi_bytes += total_bytes;
+    gpio_put(pin_cs, 1);  // Deselect device
+}
+
+// Packed images are expanded as they go out: a tile at a time straight into
+// the DMA buffers (decoding one while the other is sent), or a row at a time
+// through writePixels() in framebuffer mode and when clipped
+void GC9A01::drawPackedImage(uint16_t x, uint16_t y, const PackedImage& image) {
+    if (x >= GC9A01_WIDTH || y >= GC9A01_HEIGHT || image.width == 0 || image.height == 0) return;
+    
+    uint16_t w = image.width;
+    uint16_t h = image.height;
+    if (x + w > GC9A01_WIDTH) w = GC9A01_WIDTH - x;
+    if (y + h > GC9A01_HEIGHT) h = GC9A01_HEIGHT - y;
+    
+    PackedImageDecoder decoder(image);
+    
+    if (framebuffer || w != image.width) {
+        for (uint16_t row = 0; row < h; row++) {
+            uint32_t n = decoder.read(run_pixels, w);
+            if (n < w) {
+                memset(&run_pixels[n], 0, (w - n) * 2);
+            }
+            writePixels(x, y + row, w, 1, run_pixels);
+            
+            // Columns past the right edge are decoded and dropped
+            for (uint32_t skip = image.width - w; skip > 0; ) {
+                uint32_t chunk = skip < GC9A01_WIDTH ? skip : GC9A01_WIDTH;
+                if (decoder.read(run_pixels, chunk) < chunk) break;
+                skip -= chunk;
+            }
+        }
+        return;
+    }
+    
+    setAddressWindow(x, y, x + w - 1, y + h - 1);
+    gpio_put(pin_dc, 1);  // Data mode
+    gpio_put(pin_cs, 0);  // Select device
+    
+    const uint32_t tile_pixels = GC9A01_DMA_TILE_BYTES / 2;
+    uint32_t total = (uint32_t)w * h;
+    uint8_t tile = 0;
+    
+    while (total > 0) {
+        uint32_t count = total < tile_pixels ? total : tile_pixels;
+        uint16_t* pixels = (uint16_t*)tiles[tile];
+        
+        // A truncated stream finishes black so the window still closes
+        uint32_t n = decoder.read(pixels, count);
+        if (n < count) {
+            memset(&pixels[n], 0, (count - n) * 2);
+        }
+        total -= count;
+        
+        if (dma_channel >= 0) {
+            waitIdle();
+            startDMA(tiles[tile], count * 2, false, total == 0, false);
+            tile ^= 1;
+        } else {
+            spi_write_blocking(spi_port, tiles[tile], count * 2);
+            spi_bytes += count * 2;
+        }
+    }
+    
+    if (dma_channel < 0) {
+        gpio_put(pin_cs, 1);  // Deselect device
+    }
+}
+
+uint16_t GC9A01::backgroundPixel(const GC9A01Background& background, uint16_t x, uint16_t y) {
+    if (background.pixels && x >= background.x && y >= background.y &&
+        x < background.x + background.width && y < background.y + background.height) {
+        return toPanelOrder(background.pixels[(y - background.y) * background.width + (x - background.x)]);
+    }
+    return background.color;
+}
+
+// Puts the background back under a[0..1] of one row (or column)
+void GC9A01::restoreRun(const GC9A01Background& background, bool columns, uint16_t pos, uint16_t a0, uint16_t a1) {
+    for (uint16_t a = a0; a <= a1; a++) {
+        uint16_t color = columns ? backgroundPixel(background, pos, a) : backgroundPixel(background, a, pos);
+        run_pixels[a - a0] = toPanelOrder(color);
+    }
+    
+    uint16_t len = a1 - a0 + 1;
+    if (columns) {
+        writePixels(pos, a0, 1, len, run_pixels);
+    } else {
+        writePixels(a0, pos, len, 1, run_pixels);
+    }
+}
+
+// Scan converts the needle quad (hub to tapered tip) at a table step. Spans
+// run along rows, or along columns when the needle is mostly horizontal, so
+// the antialiased edges are always the ones across the needle. Edge pixel
+// coverage (0..255) goes to edge_coverage, two entries per span.
+uint16_t GC9A01::rasterizeNeedle(const GC9A01Needle& needle, int16_t step, bool& columns, GC9A01NeedleSpan* spans,
+                                 uint8_t* edge_coverage) {
+    int32_t c = gauge_cos[step];
+    int32_t s = gauge_sin[step];
+    columns = abs(c) > abs(s);
+    
+    // Corners in 24.8 fixed point, pixel centres at +128
+    int32_t hub_x = needle.cx * 256 + 128;
+    int32_t hub_y = needle.cy * 256 + 128;
+    int32_t tip_x = hub_x + ((int32_t)needle.length * c >> 6);
+    int32_t tip_y = hub_y + ((int32_t)needle.length * s >> 6);
+    int32_t hub_half = needle.width * 128;
+    int32_t tip_half = hub_half / 2;
+    
+    int32_t px[4] = {
+        hub_x - (s * hub_half >> 14), tip_x - (s * tip_half >> 14),
+        tip_x + (s * tip_half >> 14), hub_x + (s * hub_half >> 14),
+    };
+    int32_t py[4] = {
+        hub_y + (c * hub_half >> 14), tip_y + (c * tip_half >> 14),
+        tip_y - (c * tip_half >> 14), hub_y - (c * hub_half >> 14),
+    };
+    
+    // u is the scan axis, v runs along each span
+    const int32_t* u = columns ? px : py;
+    const int32_t* v = columns ? py : px;
+    
+    int32_t u_min = u[0], u_max = u[0];
+    for (int i = 1; i < 4; i++) {
+        if (u[i] < u_min) u_min = u[i];
+        if (u[i] > u_max) u_max = u[i];
+    }
+    
+    int32_t first = u_min >> 8;
+    int32_t last = (u_max - 1) >> 8;
+    if (first < 0) first = 0;
+    if (last > GC9A01_HEIGHT - 1) last = GC9A01_HEIGHT - 1;
+    
+    uint16_t count = 0;
+    for (int32_t pos = first; pos <= last; pos++) {
+        int32_t uc = pos * 256 + 128;
+        int32_t v_left = INT32_MAX, v_right = INT32_MIN;
+        
+        for (int e = 0; e < 4; e++) {
+            int p = e, q = (e + 1) & 3;
+            if (u[p] == u[q]) continue;
+            int32_t lo = u[p] < u[q] ? u[p] : u[q];
+            int32_t hi = u[p] < u[q] ? u[q] : u[p];
+            if (uc < lo || uc >= hi) continue;
+            
+            int32_t vv = v[p] + (int32_t)((int64_t)(uc - u[p]) * (v[q] - v[p]) / (u[q] - u[p]));
+            if (vv < v_left) v_left = vv;
+            if (vv > v_right) v_right = vv;
+        }
+        if (v_left > v_right) continue;
+        
+        if (v_left < 0) v_left = 0;
+        if (v_right > GC9A01_WIDTH * 256) v_right = GC9A01_WIDTH * 256;
+        int32_t a0 = v_left >> 8;
+        int32_t a1 = (v_right - 1) >> 8;
+        if (a1 < a0) a1 = a0;
+        if (a0 > GC9A01_WIDTH - 1) continue;
+        
+        // Share of the first and last pixel the needle covers
+        int32_t left = (a0 + 1) * 256 - v_left;
+        int32_t right = v_right - a1 * 256;
+        if (a0 == a1) left = right = v_right - v_left;
+        
+        spans[count] = {(uint16_t)pos, (uint16_t)a0, (uint16_t)a1};
+        edge_coverage[count * 2] = (uint8_t)(left > 255 ? 255 : (left < 0 ? 0 : left));
+        edge_coverage[count * 2 + 1] = (uint8_t)(right > 255 ? 255 : (right < 0 ? 0 : right));
+        count++;
+    }
+    
+    return count;
+}
+
+// Moves the needle to value. Only pixels the old needle covered and the new
+// one doesn't are restored from the background, the new needle is written as
+// one window per span with its edge pixels blended into the background.
+void GC9A01::drawNeedle(GC9A01Needle& needle, float value, float minVal, float maxVal, uint16_t color) {
+    initGaugeTables();
+    
+    int16_t step = gaugeStep(value, minVal, maxVal);
+    if (step == needle.step && color == needle.color) {
+        return;
+    }
+    
+    bool columns;
+    uint16_t count = rasterizeNeedle(needle, step, columns, needle_spans, needle_coverage);
+    
+    if (needle.step >= 0) {
+        for (uint16_t i = 0; i < needle.span_count; i++) {
+            const GC9A01NeedleSpan& old_span = needle.spans[i];
+            
+            // Spans are sorted by position, so the matching new one is found by offset
+            const GC9A01NeedleSpan* new_span = nullptr;
+            if (columns == needle.columns && count > 0 && old_span.pos >= needle_spans[0].pos &&
+                old_span.pos - needle_spans[0].pos < count) {
+                new_span = &needle_spans[old_span.pos - needle_spans[0].pos];
+            }
+            
+            if (!new_span) {
+                restoreRun(needle.background, needle.columns, old_span.pos, old_span.a0, old_span.a1);
+                continue;
+            }
+            if (old_span.a0 < new_span->a0) {
+                uint16_t end = old_span.a1 < new_span->a0 ? old_span.a1 : new_span->a0 - 1;
+                restoreRun(needle.background, columns, old_span.pos, old_span.a0, end);
+            }
+            if (old_span.a1 > new_span->a1) {
+                uint16_t begin = old_span.a0 > new_span->a1 ? old_span.a0 : new_span->a1 + 1;
+                restoreRun(needle.background, columns, old_span.pos, begin, old_span.a1);
+            }
+        }
+    }
+    
+    uint16_t fg = toPanelOrder(color);
+    for (uint16_t i = 0; i < count; i++) {
+        const GC9A01NeedleSpan& span = needle_spans[i];
+        uint16_t len = span.a1 - span.a0 + 1;
+        
+        for (uint16_t a = 0; a < len; a++) {
+            run_pixels[a] = fg;
+        }
+        uint16_t ends[2] = {span.a0, span.a1};
+        for (int e = 0; e < 2; e++) {
+            uint8_t coverage = needle_coverage[i * 2 + e];
+            if (coverage < 255) {
+                uint16_t behind = columns ? backgroundPixel(needle.background, span.pos, ends[e])
+                                          : backgroundPixel(needle.background, ends[e], span.pos);
+                run_pixels[ends[e] - span.a0] = toPanelOrder(blend565(color, behind, coverage));
+            }
+        }
+        
+        if (columns) {
+            writePixels(span.pos, span.a0, 1, len, run_pixels);
+        } else {
+            writePixels(span.a0, span.pos, len, 1, run_pixels);
+        }
+    }
+    
+    memcpy(needle.spans, needle_spans, count * sizeof(GC9A01NeedleSpan));
+    needle.span_count = count;
+    needle.step = step;
+    needle.color = color;
+    needle.columns = columns;
+}
+
 void GC9A01::drawArc(uint16_t x, uint16_t y, uint16_t r, float startAngle, float endAngle, uint16_t color, uint8_t thickness) {
-    float step = 1.0f / r; // Adaptive step size
+    // Half a pixel along the outer edge per step, so thick arcs leave no gaps
+    float step = 90.0f / (M_PI * r);
     
     for (float angle = startAngle; angle <= endAngle; angle += step) {
         float radian = angle * M_PI / 180.0f;
+        float c = cosf(radian);
+        float s = sinf(radian);
         for (uint8_t t = 0; t < thickness; t++) {
-            uint16_t px = x + (uint16_t)((r - t) * cos(radian));
-            uint16_t py = y + (uint16_t)((r - t) * sin(radian));
-            drawPixel(px, py, color);
+            // Signed offsets: points left of or above the centre are negative
+            int16_t px = (int16_t)x + (int16_t)lroundf((r - t) * c);
+            int16_t py = (int16_t)y + (int16_t)lroundf((r - t) * s);
+            if (px >= 0 && py >= 0) {
+                drawPixel(px, py, color);
+            }
         }
     }
 }
@@ -4,7 +4,10 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 #include "fonts/fonts.h"
+#include "GlyphCache.h"
+#include "PackedImage.h"
 
 // Display dimensions
 #define GC9A01_WIDTH  240
@@ -38,6 +41,68 @@
 #define GC9A01_MADCTL      0x36
 #define GC9A01_DFUNCTR     0xB6
 
+// Framebuffer mode: damaged regions are merged into at most this many windows
+#define GC9A01_MAX_DIRTY_RECTS 8
+
+// DMA mode: pixels are staged in two buffers of this size, the CPU fills one
+// while the other is being sent
+#define GC9A01_DMA_TILE_BYTES 4096
+
+// Frame timing collected between beginFrame() and flush() since the last
+// resetFrameStats(). SPI time is from flush() until its last byte went out,
+// so it is 0 without a framebuffer, where drawing sends as it goes.
+struct GC9A01FrameStats {
+    uint32_t frames;
+    uint32_t elapsed_us;
+    uint32_t render_us, render_max_us;      // Last frame, worst frame
+    uint64_t render_total_us;
+    uint32_t spi_us, spi_max_us;
+    uint64_t spi_total_us;
+    uint32_t spi_bytes, spi_max_bytes;      // All panel traffic of a frame
+    uint64_t spi_total_bytes;
+};
+
+// Inclusive pixel rectangle
+struct GC9A01Rect {
+    uint16_t x0, y0, x1, y1;
+};
+
+// Analog gauges sweep 270 degrees clockwise from -135 (0 is 3 o'clock), the
+// fixed-point trig tables hold one entry per step (half a degree)
+#define GC9A01_GAUGE_START  -135
+#define GC9A01_GAUGE_SWEEP  270
+#define GC9A01_GAUGE_STEPS  540
+
+// What lies behind a needle: a copy of the gauge face in panel byte order
+// (see captureRegion()), or a plain colour when pixels is nullptr
+struct GC9A01Background {
+    const uint16_t* pixels;
+    uint16_t x, y, width, height;
+    uint16_t color;
+};
+
+// One run of needle pixels along its scan axis (rows, or columns for a
+// mostly horizontal needle), a0..a1 inclusive
+struct GC9A01NeedleSpan {
+    uint16_t pos;
+    uint16_t a0, a1;
+};
+
+// Needle geometry plus what drawNeedle() drew last, so the next call only
+// restores the pixels the needle leaves
+struct GC9A01Needle {
+    uint16_t cx, cy;
+    uint16_t length;
+    uint8_t width;              // At the hub, the tip is half as wide
+    GC9A01Background background;
+    
+    int16_t step;               // Table step drawn, -1: nothing drawn yet
+    uint16_t color;
+    bool columns;               // Spans run along columns
+    uint16_t span_count;
+    GC9A01NeedleSpan spans[GC9A01_HEIGHT];
+};
+
 class GC9A01 {
 private:
     spi_inst_t* spi_port;
@@ -46,6 +111,63 @@ private:
     uint8_t pin_rst;
     uint8_t pin_bl;
     
+    // Optional RAM copy of the panel in panel byte order (nullptr: draw
+    // straight to the panel). Drawing only marks pixels that actually change.
+    uint16_t* framebuffer;
+    GC9A01Rect dirty[GC9A01_MAX_DIRTY_RECTS];
+    uint8_t dirty_count;
+    uint32_t spi_bytes;         // Bytes written to the panel since init
+    uint32_t flush_bytes;       // Bytes sent by the last flush()
+    uint8_t flush_rects;        // Windows sent by the last flush()
+    bool glyph_blit;            // Opaque glyphs in one window (false: per pixel)
+    GlyphCache* glyph_cache;    // Expanded opaque glyphs, optional
+    
+    // Frame instrumentation. The flush end stamp comes from the DMA IRQ and is
+    // folded into the stats from thread context.
+    GC9A01FrameStats frame_stats;
+    uint32_t stats_start_us;
+    uint32_t frame_start_us;
+    uint32_t frame_period_us;
+    uint32_t frame_spi_start;   // spi_bytes when the frame began
+    bool frame_open;
+    volatile uint32_t flush_start_us;
+    volatile uint32_t flush_end_us;
+    volatile bool flush_pending;    // flush_end_us not folded in yet
+    bool stats_overlay;
+    uint16_t overlay_x, overlay_y;
+    
+    void foldFlushTime();
+    void drawStatsOverlay();
+    
+    void markDirty(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    void mergeDirty(uint8_t index);
+    
+    // DMA transfer engine (dma_channel < 0: blocking SPI writes). A transfer
+    // keeps CS low until the DMA IRQ sees it finish; every blocking write
+    // waits for the engine to go idle first.
+    int dma_channel;
+    volatile bool dma_active;       // Transfer in flight
+    volatile bool dma_release_cs;   // Raise CS when it completes (end of window)
+    volatile bool dma_notify;       // Call dma_callback when it completes
+    void (*dma_callback)(void* context);
+    void* dma_callback_context;
+    uint16_t fill_pattern;          // Solid fill source, read in a 2 byte ring
+    alignas(4) uint8_t tiles[2][GC9A01_DMA_TILE_BYTES];
+    
+    static GC9A01* dma_instance;
+    static void dmaIrqHandler();
+    void dmaComplete();
+    void startDMA(const uint8_t* src, size_t len, bool repeat, bool release_cs, bool notify);
+    void flushDirty();
+    void flushTiles(const GC9A01Rect& rect, bool notify);
+    void writePixels(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const uint16_t* pixels);
+    uint16_t backgroundPixel(const GC9A01Background& background, uint16_t x, uint16_t y);
+    void restoreRun(const GC9A01Background& background, bool columns, uint16_t pos, uint16_t a0, uint16_t a1);
+    uint16_t rasterizeNeedle(const GC9A01Needle& needle, int16_t step, bool& columns, GC9A01NeedleSpan* spans,
+                             uint8_t* edge_coverage);
+    void notifyIdle();
+    void blitGlyph(uint16_t x, uint16_t y, char c, const uint8_t* glyph, sFONT* font, uint16_t color, uint16_t bg);
+    
     // Low-level SPI communication
     void writeCommand(uint8_t cmd);
     void writeData(uint8_t data);
@@ -65,6 +187,32 @@ public:
     void displayOn();
     void displayOff();
     
+    // Framebuffer mode: primitives render into RAM and flush() sends the
+    // damaged windows, so the panel never shows a half drawn frame
+    bool enableFramebuffer();
+    bool hasFramebuffer() const { return framebuffer != nullptr; }
+    void flush();
+    uint32_t getSpiBytes() const { return spi_bytes; }
+    uint32_t getFlushBytes() const { return flush_bytes; }
+    uint8_t getFlushRects() const { return flush_rects; }
+    
+    // Frame instrumentation: call beginFrame() before drawing a frame,
+    // flush() ends it. The overlay shows fps, render time and SPI bytes of
+    // the previous frame in Font8 at x, y (drawn as part of every flush).
+    void beginFrame();
+    GC9A01FrameStats getFrameStats();
+    void resetFrameStats();
+    void printFrameStats();
+    void setStatsOverlay(bool enabled, uint16_t x = 20, uint16_t y = 150);
+    
+    // DMA mode: fills, images and flushes return once the last transfer is
+    // queued. waitIdle() is the fence; the callback runs (in IRQ context when
+    // DMA is on) when the transfers of a flush() have all gone out.
+    bool enableDMA();
+    bool isBusy() const { return dma_active; }
+    void waitIdle();
+    void setFlushCallback(void (*callback)(void* context), void* context);
+    
     // Address window and basic drawing
     void setAddressWindow(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
     void fillScreen(uint16_t color);
@@ -94,16 +242,27 @@ public:
     // Text drawing (using sFONT structure)
     void drawChar(uint16_t x, uint16_t y, char c, uint16_t color, uint16_t bg, sFONT* font);
     uint16_t getCharSpacing(char c, sFONT* font);
+    void setGlyphBlit(bool enabled) { glyph_blit = enabled; }
+    void setGlyphCache(GlyphCache* cache) { waitIdle(); glyph_cache = cache; }
     void print(uint16_t x, uint16_t y, const char* text, uint16_t color, uint16_t bg = BLACK, sFONT* font = &Font16);
     void printf(uint16_t x, uint16_t y, uint16_t color, uint16_t bg, sFONT* font, const char* format, ...);
+    uint16_t textWidth(const char* text, sFONT* font);
+    void printField(uint16_t x, uint16_t y, uint16_t width, const char* text, uint16_t color, uint16_t bg, sFONT* font);
     
     // Image drawing
     void drawImage(uint16_t x, uint16_t y, uint16_t w, uint16_t h, const unsigned char* image_data);
+    void drawPackedImage(uint16_t x, uint16_t y, const PackedImage& image);
     
-    // Gauge-specific functions
+    // Gauge-specific functions. drawGauge() paints face and needle in one go;
+    // for a moving needle draw the face once and call drawNeedle() per frame.
     void drawGauge(uint16_t centerX, uint16_t centerY, uint16_t radius, 
                    float value, float minVal, float maxVal, 
                    uint16_t needleColor = RED, uint16_t scaleColor = WHITE);
+    void drawGaugeFace(uint16_t centerX, uint16_t centerY, uint16_t radius, uint16_t scaleColor = WHITE);
+    void initNeedle(GC9A01Needle& needle, uint16_t centerX, uint16_t centerY, uint16_t length, uint8_t width,
+                    const GC9A01Background& background);
+    void drawNeedle(GC9A01Needle& needle, float value, float minVal, float maxVal, uint16_t color);
+    bool captureRegion(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t* pixels);
     void drawArc(uint16_t x, uint16_t y, uint16_t r, float startAngle, float endAngle, uint16_t color, uint8_t thickness = 1);
     
     // Color utilities
@@ -0,0 +1,127 @@
+#include "GlyphCache.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+GlyphCache::GlyphCache(uint32_t budget_bytes)
+    : budget(budget_bytes), used(0), tick(0), hits(0), misses(0), evictions(0), uncacheable(0) {
+    memset(entries, 0, sizeof(entries));
+}
+
+GlyphCache::~GlyphCache() {
+    clear();
+}
+
+void GlyphCache::evict(GlyphCacheEntry& entry) {
+    free(entry.pixels);
+    used -= entry.bytes;
+    memset(&entry, 0, sizeof(entry));
+}
+
+GlyphCacheEntry* GlyphCache::leastRecentlyUsed() {
+    GlyphCacheEntry* oldest = nullptr;
+    for (GlyphCacheEntry& entry : entries) {
+        if (entry.font && (!oldest || entry.last_used < oldest->last_used)) {
+            oldest = &entry;
+        }
+    }
+    return oldest;
+}
+
+const uint16_t* GlyphCache::get(const sFONT* font, char c, uint16_t fg, uint16_t bg, const uint8_t* glyph_bits) {
+    tick++;
+    
+    GlyphCacheEntry* free_slot = nullptr;
+    for (GlyphCacheEntry& entry : entries) {
+        if (!entry.font) {
+            if (!free_slot) free_slot = &entry;
+            continue;
+        }
+        if (entry.font == font && entry.c == c && entry.fg == fg && entry.bg == bg) {
+            entry.last_used = tick;
+            hits++;
+            return entry.pixels;
+        }
+    }
+    
+    misses++;
+    uint32_t bytes = (uint32_t)font->Width * font->Height * 2;
+    if (bytes > budget) {
+        uncacheable++;
+        return nullptr;
+    }
+    
+    // Make room: a free slot and enough of the budget
+    while (!free_slot || used + bytes > budget) {
+        GlyphCacheEntry* victim = leastRecentlyUsed();
+        if (!victim) {
+            return nullptr;
+        }
+        evict(*victim);
+        evictions++;
+        if (!free_slot) free_slot = victim;
+    }
+    
+    uint16_t* pixels = (uint16_t*)malloc(bytes);
+    if (!pixels) {
+        return nullptr;
+    }
+    
+    // Expand the 1bpp rows, colours already swapped to panel byte order
+    uint16_t fg_value = (uint16_t)((fg >> 8) | (fg << 8));
+    uint16_t bg_value = (uint16_t)((bg >> 8) | (bg << 8));
+    uint16_t bytes_per_row = (font->Width + 7) / 8;
+    uint16_t* dst = pixels;
+    for (uint16_t row = 0; row < font->Height; row++) {
+        const uint8_t* bits = &glyph_bits[row * bytes_per_row];
+        for (uint16_t col = 0; col < font->Width; col++) {
+            *dst++ = (bits[col >> 3] & (0x80 >> (col & 7))) ? fg_value : bg_value;
+        }
+    }
+    
+    free_slot->font = font;
+    free_slot->c = c;
+    free_slot->fg = fg;
+    free_slot->bg = bg;
+    free_slot->pixels = pixels;
+    free_slot->bytes = bytes;
+    free_slot->last_used = tick;
+    used += bytes;
+    return pixels;
+}
+
+void GlyphCache::setBudget(uint32_t budget_bytes) {
+    budget = budget_bytes;
+    while (used > budget) {
+        evict(*leastRecentlyUsed());
+        evictions++;
+    }
+}
+
+void GlyphCache::clear() {
+    for (GlyphCacheEntry& entry : entries) {
+        if (entry.font) {
+            evict(entry);
+        }
+    }
+}
+
+void GlyphCache::resetStats() {
+    hits = 0;
+    misses = 0;
+    evictions = 0;
+    uncacheable = 0;
+}
+
+void GlyphCache::printStats() {
+    uint32_t lookups = hits + misses;
+    uint8_t count = 0;
+    for (const GlyphCacheEntry& entry : entries) {
+        if (entry.font) count++;
+    }
+    
+    printf("Glyph cache: %lu hits, %lu misses (%.1f%% hit), %lu evictions, %lu uncacheable, %u glyphs in %lu/%lu bytes\n",
+           (unsigned long)hits, (unsigned long)misses, lookups ? 100.0f * hits / lookups : 0.0f,
+           (unsigned long)evictions, (unsigned long)uncacheable, count,
+           (unsigned long)used, (unsigned long)budget);
+}
@@ -0,0 +1,64 @@
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include "pico/stdlib.h"
+#include "fonts/fonts.h"
+
+// Default RAM budget for cached glyph pixels
+#define GLYPH_CACHE_DEFAULT_BUDGET (32 * 1024)
+
+// Most glyphs kept at once, regardless of the budget
+#define GLYPH_CACHE_MAX_ENTRIES 64
+
+// One glyph expanded to RGB565 in panel byte order, Width x Height pixels
+struct GlyphCacheEntry {
+    const sFONT* font;          // nullptr when the slot is free
+    char c;
+    uint16_t fg;
+    uint16_t bg;
+    uint16_t* pixels;
+    uint32_t bytes;
+    uint32_t last_used;         // LRU tick
+};
+
+// LRU cache of expanded glyphs keyed by (font, char, fg, bg). The display
+// redraws the same digits in a few colour pairs, so after warm up a glyph is
+// a copy (or a DMA) instead of a bit-by-bit expansion.
+class GlyphCache {
+private:
+    GlyphCacheEntry entries[GLYPH_CACHE_MAX_ENTRIES];
+    uint32_t budget;
+    uint32_t used;
+    uint32_t tick;
+    
+    // Counters
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+    uint32_t uncacheable;       // Glyphs bigger than the whole budget
+    
+    void evict(GlyphCacheEntry& entry);
+    GlyphCacheEntry* leastRecentlyUsed();
+    
+public:
+    GlyphCache(uint32_t budget_bytes = GLYPH_CACHE_DEFAULT_BUDGET);
+    ~GlyphCache();
+    
+    // Returns the expanded glyph, expanding glyph_bits (the 1bpp sFONT rows)
+    // on a miss. nullptr when it can't be cached, the caller expands it then.
+    // Pointers stay valid until the next get() or clear().
+    const uint16_t* get(const sFONT* font, char c, uint16_t fg, uint16_t bg, const uint8_t* glyph_bits);
+    
+    void setBudget(uint32_t budget_bytes);
+    void clear();
+    void resetStats();
+    
+    uint32_t getBudget() const { return budget; }
+    uint32_t getUsedBytes() const { return used; }
+    uint32_t getHits() const { return hits; }
+    uint32_t getMisses() const { return misses; }
+    uint32_t getEvictions() const { return evictions; }
+    void printStats();
+};
+
+#endif // GLYPH_CACHE_H
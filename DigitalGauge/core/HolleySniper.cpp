@@ -1,10 +1,59 @@
 #include "HolleySniper.h"
 #include <cstdio>
 
-HolleySniper::HolleySniper(MCP2515* can) : can_controller(can) {
+// Binds a generated signal decoder to the engine data fields it updates
+struct HolleySignalBinding {
+    uint32_t id;
+    float (*decode)(const uint8_t* data);
+    float HolleyEngineData::* value;
+    bool HolleyEngineData::* valid;
+    uint32_t HolleyEngineData::* timestamp;  // nullptr when not tracked
+};
+
+static const HolleySignalBinding signal_bindings[] = {
+    {HolleyDBC::RPM_ID, HolleyDBC::RPM_RPM, &HolleyEngineData::rpm, &HolleyEngineData::rpm_valid, &HolleyEngineData::last_rpm_time},
+    {HolleyDBC::CTS_ID, HolleyDBC::CTS_CTS, &HolleyEngineData::coolant_temp, &HolleyEngineData::coolant_temp_valid, &HolleyEngineData::last_coolant_time},
+    {HolleyDBC::Fuel_Flow_ID, HolleyDBC::Fuel_Flow_Fuel_Flow, &HolleyEngineData::fuel_flow, &HolleyEngineData::fuel_flow_valid, &HolleyEngineData::last_fuel_flow_time},
+    {HolleyDBC::MAP_ID, HolleyDBC::MAP_MAP, &HolleyEngineData::map_pressure, &HolleyEngineData::map_valid, nullptr},
+    {HolleyDBC::TPS_ID, HolleyDBC::TPS_TPS, &HolleyEngineData::tps_position, &HolleyEngineData::tps_valid, nullptr},
+    {HolleyDBC::AirFuel_Ratio_ID, HolleyDBC::AirFuel_Ratio_AirFuel_Ratio, &HolleyEngineData::air_fuel_ratio, &HolleyEngineData::afr_valid, nullptr},
+    {HolleyDBC::Target_AFR_ID, HolleyDBC::Target_AFR_Target_AFR, &HolleyEngineData::target_afr, &HolleyEngineData::target_afr_valid, nullptr},
+    {HolleyDBC::Ignition_Timing_ID, HolleyDBC::Ignition_Timing_Ignition_Timing, &HolleyEngineData::ignition_timing, &HolleyEngineData::timing_valid, nullptr},
+    {HolleyDBC::Battery_ID, HolleyDBC::Battery_Battery, &HolleyEngineData::battery_voltage, &HolleyEngineData::battery_valid, nullptr},
+    {HolleyDBC::MAT_ID, HolleyDBC::MAT_MAT, &HolleyEngineData::manifold_air_temp, &HolleyEngineData::mat_valid, nullptr},
+};
+
+static const size_t signal_binding_count = sizeof(signal_bindings) / sizeof(signal_bindings[0]);
+static_assert(signal_binding_count == HOLLEY_BOUND_MESSAGES, "HOLLEY_BOUND_MESSAGES out of date");
+
+static const uint32_t jitter_bounds[HOLLEY_JITTER_BUCKETS] = HOLLEY_JITTER_BOUNDS;
+
+// Nominal frame length on the wire, stuff bits not included
+static uint32_t frameBits(const CANFrame& frame) {
+    return (frame.extended ? 67 : 47) + (frame.remote ? 0 : 8 * frame.dlc);
+}
+
+HolleySniper::HolleySniper(MCP2515* can) : can_controller(can), frames_read(0), frames_used(0), source_serial_filter(-1) {
     // Initialize engine data structure
     memset(&engine_data, 0, sizeof(engine_data));
     engine_data.data_valid = false;
+    
+    // Resolve each binding to its generated message index once
+    memset(&acceptance, 0, sizeof(acceptance));
+    memset(message_stats, 0, sizeof(message_stats));
+    period_start = 0;
+    period_bits = 0;
+    overflow_events = 0;
+    receive_to_decode_sum = receive_to_decode_max = 0;
+    decode_to_publish_sum = decode_to_publish_max = 0;
+    latency_samples = publish_samples = 0;
+    memset(binding_index, -1, sizeof(binding_index));
+    for (size_t i = 0; i < signal_binding_count; i++) {
+        int index = HolleyDBC::messageIndex(signal_bindings[i].id);
+        if (index >= 0) {
+            binding_index[index] = (int8_t)i;
+        }
+    }
 }
 
 bool HolleySniper::init() {
@@ -18,150 +67,59 @@ bool HolleySniper::init() {
     engine_data.last_coolant_time = current_time;
     engine_data.last_fuel_flow_time = current_time;
     engine_data.last_update_time = current_time;
+    period_start = time_us_32();
     
     printf("Holley Sniper CAN decoder initialized\n");
     return true;
 }
 
-float HolleySniper::extractFloat32(const uint8_t* data, uint8_t start_byte, bool big_endian) {
-    uint32_t raw_value;
-    
-    if (big_endian) {
-        // Big endian (most significant byte first)
-        raw_value = ((uint32_t)data[start_byte] << 24) |
-                   ((uint32_t)data[start_byte + 1] << 16) |
-                   ((uint32_t)data[start_byte + 2] << 8) |
-                   ((uint32_t)data[start_byte + 3]);
-    } else {
-        // Little endian (least significant byte first)
-        raw_value = ((uint32_t)data[start_byte + 3] << 24) |
-                   ((uint32_t)data[start_byte + 2] << 16) |
-                   ((uint32_t)data[start_byte + 1] << 8) |
-                   ((uint32_t)data[start_byte]);
+// Programs the controller's masks and filters so only the messages in the
+// bindings table are read over SPI. Every other DBC message counts as unwanted.
+bool HolleySniper::configureFilters() {
+    if (!can_controller) {
+        return false;
     }
     
-    // Convert to float using union
-    union {
-        uint32_t i;
-        float f;
-    } converter;
-    converter.i = raw_value;
-    
-    return converter.f;
-}
-
-uint64_t HolleySniper::extractUint64(const uint8_t* data, uint8_t start_byte, bool big_endian) {
-    uint64_t result = 0;
-    
-    if (big_endian) {
-        for (int i = 0; i < 8; i++) {
-            result = (result << 8) | data[start_byte + i];
-        }
-    } else {
-        for (int i = 7; i >= 0; i--) {
-            result = (result << 8) | data[start_byte + i];
-        }
+    uint32_t wanted[signal_binding_count];
+    uint32_t known[HolleyDBC::MESSAGE_COUNT];
+    for (size_t i = 0; i < signal_binding_count; i++) {
+        wanted[i] = signal_bindings[i].id;
     }
-    
-    return result;
-}
-
-bool HolleySniper::isDataFresh(uint32_t timestamp, uint32_t max_age_ms) const {
-    uint32_t current_time = to_ms_since_boot(get_absolute_time());
-    return (current_time - timestamp) <= max_age_ms;
-}
-
-void HolleySniper::processRPMMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        // RPM is a 32-bit float starting at bit 24 (byte 3), big endian
-        engine_data.rpm = extractFloat32(frame.data, 3, true);
-        engine_data.rpm_valid = true;
-        engine_data.last_rpm_time = to_ms_since_boot(get_absolute_time());
-        
-        // Status byte at bit 56 (byte 7)
-        if (frame.dlc >= 8) {
-            uint8_t status = frame.data[7];
-            // You can interpret status bits here if needed
-        }
-    }
-}
-
-void HolleySniper::processCoolantTempMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        // CTS is a 32-bit float starting at bit 24 (byte 3), big endian
-        engine_data.coolant_temp = extractFloat32(frame.data, 3, true);
-        engine_data.coolant_temp_valid = true;
-        engine_data.last_coolant_time = to_ms_since_boot(get_absolute_time());
-        
-        // Status byte at bit 56 (byte 7)
-        if (frame.dlc >= 8) {
-            uint8_t status = frame.data[7];
-            // You can interpret status bits here if needed
-        }
-    }
-}
-
-void HolleySniper::processFuelFlowMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        // Fuel_Flow is a 32-bit float starting at bit 24 (byte 3), big endian
-        engine_data.fuel_flow = extractFloat32(frame.data, 3, true);
-        engine_data.fuel_flow_valid = true;
-        engine_data.last_fuel_flow_time = to_ms_since_boot(get_absolute_time());
-        
-        // Status byte at bit 56 (byte 7)
-        if (frame.dlc >= 8) {
-            uint8_t status = frame.data[7];
-            // You can interpret status bits here if needed
-        }
+    for (size_t i = 0; i < HolleyDBC::MESSAGE_COUNT; i++) {
+        known[i] = HolleyDBC::MESSAGES[i].id;
     }
-}
-
-void HolleySniper::processMAPMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.map_pressure = extractFloat32(frame.data, 3, true);
-        engine_data.map_valid = true;
+    
+    if (!MCP2515::computeAcceptance(wanted, signal_binding_count, known, HolleyDBC::MESSAGE_COUNT, true, acceptance)) {
+        printf("Could not compute CAN acceptance filters\n");
+        return false;
     }
-}
-
-void HolleySniper::processTPSMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.tps_position = extractFloat32(frame.data, 3, true);
-        engine_data.tps_valid = true;
+    
+    // Every DBC ID carries the same source fields, so leaving them out of the
+    // masks accepts the wanted messages from any Holley unit
+    for (int i = 0; i < 2; i++) {
+        acceptance.masks[i] &= ~HolleyDBC::SOURCE_MASK;
     }
-}
-
-void HolleySniper::processAFRMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.air_fuel_ratio = extractFloat32(frame.data, 3, true);
-        engine_data.afr_valid = true;
+    for (int i = 0; i < 6; i++) {
+        acceptance.filters[i] &= ~HolleyDBC::SOURCE_MASK;
     }
-}
-
-void HolleySniper::processTargetAFRMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.target_afr = extractFloat32(frame.data, 3, true);
-    }
-}
-
-void HolleySniper::processIgnitionTimingMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.ignition_timing = extractFloat32(frame.data, 3, true);
-        engine_data.timing_valid = true;
+    
+    if (!can_controller->setAcceptance(acceptance)) {
+        printf("Could not program CAN acceptance filters\n");
+        return false;
     }
-}
-
-void HolleySniper::processBatteryMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.battery_voltage = extractFloat32(frame.data, 3, true);
-        engine_data.battery_valid = true;
+    
+    printf("CAN filters: RXM0=0x%08lX RXM1=0x%08lX\n", (unsigned long)acceptance.masks[0], (unsigned long)acceptance.masks[1]);
+    for (int i = 0; i < 6; i++) {
+        printf("  RXF%d=0x%08lX\n", i, (unsigned long)acceptance.filters[i]);
     }
+    printf("CAN filters accept %u of %u Holley messages for %u wanted, expected accept ratio %.2f\n",
+           acceptance.known_accepted, acceptance.known_total, acceptance.wanted, acceptance.expected_ratio);
+    return true;
 }
 
-void HolleySniper::processMATMessage(const CANFrame& frame) {
-    if (frame.dlc >= 4) {
-        engine_data.manifold_air_temp = extractFloat32(frame.data, 3, true);
-        engine_data.mat_valid = true;
-    }
+bool HolleySniper::isDataFresh(uint32_t timestamp, uint32_t max_age_ms) const {
+    uint32_t current_time = to_ms_since_boot(get_absolute_time());
+    return (current_time - timestamp) <= max_age_ms;
 }
 
 bool HolleySniper::processCANMessages() {
@@ -171,10 +129,23 @@ bool HolleySniper::processCANMessages() {
     
     bool processed_any = false;
     CANFrame frame;
+    uint32_t first_decode = 0;
+    
+    // Frames lost inside the controller never reach the ring, only EFLG tells
+    if (can_controller->checkRxOverflow()) {
+        overflow_events++;
+    }
     
     // Process all available messages
     while (can_controller->readFrame(frame)) {
+        uint32_t decode_time = time_us_32();
+        frames_read++;
+        period_bits += frameBits(frame);
         if (processCANMessage(frame)) {
+            if (!processed_any) {
+                first_decode = decode_time;
+            }
+            frames_used++;
             processed_any = true;
         }
     }
@@ -184,61 +155,83 @@ bool HolleySniper::processCANMessages() {
     
     if (processed_any) {
         engine_data.last_update_time = to_ms_since_boot(get_absolute_time());
+        
+        // Decoded values become visible to the UI here
+        uint32_t latency = time_us_32() - first_decode;
+        decode_to_publish_sum += latency;
+        if (latency > decode_to_publish_max) {
+            decode_to_publish_max = latency;
+        }
+        publish_samples++;
     }
     
     return processed_any;
 }
 
+void HolleySniper::recordFrame(const CANFrame& frame, size_t binding, uint32_t decode_time) {
+    HolleyMessageStats& stats = message_stats[binding];
+    
+    uint32_t latency = decode_time - frame.timestamp;
+    receive_to_decode_sum += latency;
+    if (latency > receive_to_decode_max) {
+        receive_to_decode_max = latency;
+    }
+    latency_samples++;
+    
+    if (stats.frames > 0) {
+        uint32_t interval = frame.timestamp - stats.last_arrival;
+        
+        // Exponential average over ~8 intervals, seeded with the first one
+        if (stats.mean_interval == 0) {
+            stats.mean_interval = interval;
+        } else {
+            stats.mean_interval += ((int32_t)interval - (int32_t)stats.mean_interval) / 8;
+        }
+        
+        uint32_t jitter = interval > stats.mean_interval ? interval - stats.mean_interval : stats.mean_interval - interval;
+        int bucket = 0;
+        while (bucket < HOLLEY_JITTER_BUCKETS - 1 && jitter >= jitter_bounds[bucket]) {
+            bucket++;
+        }
+        stats.jitter[bucket]++;
+    }
+    
+    stats.frames++;
+    stats.period_frames++;
+    stats.last_arrival = frame.timestamp;
+}
+
 bool HolleySniper::processCANMessage(const CANFrame& frame) {
     // Only process extended frames (29-bit IDs)
     if (!frame.extended) {
         return false;
     }
     
-    switch (frame.id) {
-        case HOLLEY_RPM_ID:
-            processRPMMessage(frame);
-            return true;
-            
-        case HOLLEY_CTS_ID:
-            processCoolantTempMessage(frame);
-            return true;
-            
-        case HOLLEY_FUEL_FLOW_ID:
-            processFuelFlowMessage(frame);
-            return true;
-            
-        case HOLLEY_MAP_ID:
-            processMAPMessage(frame);
-            return true;
-            
-        case HOLLEY_TPS_ID:
-            processTPSMessage(frame);
-            return true;
-            
-        case HOLLEY_AIRFUEL_RATIO_ID:
-            processAFRMessage(frame);
-            return true;
-            
-        case HOLLEY_TARGET_AFR_ID:
-            processTargetAFRMessage(frame);
-            return true;
-            
-        case HOLLEY_IGNITION_TIMING_ID:
-            processIgnitionTimingMessage(frame);
-            return true;
-            
-        case HOLLEY_BATTERY_ID:
-            processBatteryMessage(frame);
-            return true;
-            
-        case HOLLEY_MAT_ID:
-            processMATMessage(frame);
-            return true;
-            
-        default:
-            return false;  // Unknown message ID
+    // The source fields carry the sender's serial, look the message up without them
+    int index = HolleyDBC::messageIndexAnySource(frame.id);
+    if (index < 0 || binding_index[index] < 0) {
+        return false;  // Unknown or unused message ID
+    }
+    
+    HolleyDBC::Address source = HolleyDBC::decodeAddress(frame.id);
+    if (source_serial_filter >= 0 && source.source_serial != source_serial_filter) {
+        return false;  // Another Holley unit on the bus
+    }
+    
+    if (frame.dlc < HolleyDBC::MESSAGES[index].dlc) {
+        return false;
+    }
+    
+    const HolleySignalBinding& binding = signal_bindings[binding_index[index]];
+    recordFrame(frame, binding_index[index], time_us_32());
+    engine_data.*binding.value = binding.decode(frame.data);
+    engine_data.*binding.valid = true;
+    engine_data.last_source = source;
+    if (binding.timestamp) {
+        engine_data.*binding.timestamp = to_ms_since_boot(get_absolute_time());
     }
+    
+    return true;
 }
 
 bool HolleySniper::isEngineDataValid() const {
@@ -295,6 +288,56 @@ void HolleySniper::printEngineData() const {
         printf("MAT: %.1f°F\n", engine_data.manifold_air_temp);
     }
     
+    printf("Source: ID %u serial %u\n", engine_data.last_source.source_id, engine_data.last_source.source_serial);
     printf("Data Valid: %s\n", engine_data.data_valid ? "YES" : "NO");
     printf("================================\n");
 }
+
+// USB-CDC dump of the reception statistics. Rates, bus load and latencies
+// cover the period since the previous call, which starts a new one.
+void HolleySniper::printCANStats() {
+    uint32_t now = time_us_32();
+    float elapsed = (now - period_start) / 1000000.0f;
+    if (elapsed <= 0.0f) {
+        return;
+    }
+    
+    // Only frames passing the acceptance filters reach the MCU, so this is a
+    // lower bound of the real bus load
+    float bus_load = 100.0f * period_bits / (HOLLEY_CAN_BITRATE * elapsed);
+    
+    printf("CAN: %lu frames read, %lu used, accept ratio %.2f (expected %.2f)\n",
+           (unsigned long)frames_read, (unsigned long)frames_used,
+           getMeasuredAcceptRatio(), acceptance.expected_ratio);
+    printf("CAN: bus load %.1f%%, RX overflow events %lu, ring drops %lu\n",
+           bus_load, (unsigned long)overflow_events, (unsigned long)can_controller->getRxDroppedCount());
+    printf("CAN: receive->decode avg %lu us max %lu us, decode->publish avg %lu us max %lu us\n",
+           (unsigned long)(latency_samples ? receive_to_decode_sum / latency_samples : 0),
+           (unsigned long)receive_to_decode_max,
+           (unsigned long)(publish_samples ? decode_to_publish_sum / publish_samples : 0),
+           (unsigned long)decode_to_publish_max);
+    
+    printf("  %-10s %8s %8s %8s %9s  jitter <100/<500/<1k/<5k/<20k/more us\n", "ID", "frames", "rate/s", "age ms", "mean us");
+    for (size_t i = 0; i < signal_binding_count; i++) {
+        HolleyMessageStats& stats = message_stats[i];
+        printf("  0x%08lX %8lu %8.1f ", (unsigned long)signal_bindings[i].id,
+               (unsigned long)stats.frames, stats.period_frames / elapsed);
+        if (stats.frames > 0) {
+            printf("%8lu ", (unsigned long)((now - stats.last_arrival) / 1000));
+        } else {
+            printf("%8s ", "-");
+        }
+        printf("%9lu ", (unsigned long)stats.mean_interval);
+        for (int j = 0; j < HOLLEY_JITTER_BUCKETS; j++) {
+            printf(" %lu", (unsigned long)stats.jitter[j]);
+        }
+        printf("\n");
+        stats.period_frames = 0;
+    }
+    
+    period_start = now;
+    period_bits = 0;
+    receive_to_decode_sum = receive_to_decode_max = 0;
+    decode_to_publish_sum = decode_to_publish_max = 0;
+    latency_samples = publish_samples = 0;
+}
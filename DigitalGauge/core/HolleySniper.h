@@ -4,38 +4,9 @@
 #include "MCP2515.h"
 #include <cstring>
 
-// Holley Sniper CAN IDs (from JSON - extended frame format)
-#define HOLLEY_RTC_ID               503320576   // 0x1E000000
-#define HOLLEY_RPM_ID               503336960   // 0x1E004000  
-#define HOLLEY_INJ_PW_ID            503353344   // 0x1E008000
-#define HOLLEY_DUTY_CYCLE_ID        503369728   // 0x1E00C000
-#define HOLLEY_CL_COMP_ID           503386112   // 0x1E010000
-#define HOLLEY_TARGET_AFR_ID        503402496   // 0x1E014000
-#define HOLLEY_AIRFUEL_RATIO_ID     503418880   // 0x1E018000
-#define HOLLEY_AIR_TEMP_ENR_ID      503435264   // 0x1E01C000
-#define HOLLEY_COOLANT_ENR_ID       503451648   // 0x1E020000
-#define HOLLEY_COOLANT_AFR_OFFSET_ID 503468032  // 0x1E024000
-#define HOLLEY_AFTERSTART_ENR_ID    503484416   // 0x1E028000
-#define HOLLEY_CURRENT_LEARN_ID     503500800   // 0x1E02C000
-#define HOLLEY_CL_STATUS_ID         503517184   // 0x1E030000
-#define HOLLEY_LEARN_STATUS_ID      503533568   // 0x1E034000
-#define HOLLEY_FUEL_FLOW_ID         503549952   // 0x1E038000 - FUEL CONSUMPTION
-#define HOLLEY_MAP_ROC_ID           503566336   // 0x1E03C000
-#define HOLLEY_TPS_ROC_ID           503582720   // 0x1E040000
-#define HOLLEY_ESTIMATED_VE_ID      503599104   // 0x1E044000
-#define HOLLEY_IGNITION_TIMING_ID   503615488   // 0x1E048000
-#define HOLLEY_MAIN_REV_LIMIT_ID    503631872   // 0x1E04C000
-#define HOLLEY_REV_LIMIT_1_ID       503648256   // 0x1E050000
-#define HOLLEY_LAUNCH_RETARD_ID     503664640   // 0x1E054000
-#define HOLLEY_IAC_POSITION_ID      503681024   // 0x1E058000
-#define HOLLEY_MAP_ID               503697408   // 0x1E05C000
-#define HOLLEY_TPS_ID               503713792   // 0x1E060000
-#define HOLLEY_MAT_ID               503730176   // 0x1E064000
-#define HOLLEY_CTS_ID               503746560   // 0x1E068000 - ENGINE TEMPERATURE
-#define HOLLEY_BATTERY_ID           503762944   // 0x1E06C000
-#define HOLLEY_CUSTOM1_ID           503779328   // 0x1E070000
-#define HOLLEY_CUSTOM2_ID           503795712   // 0x1E074000
-#define HOLLEY_CUSTOM3_ID           503812096   // 0x1E078000
+// Holley Sniper message IDs and decoders are generated at build time from
+// assets/HolleySniper/Sniper_V2.dbc (see tools/dbc_to_header.py)
+#include "HolleySniperDBC.h"
 
 // Engine data structure
 struct HolleyEngineData {
@@ -59,6 +30,7 @@ struct HolleyEngineData {
     bool map_valid;
     bool tps_valid;
     bool afr_valid;
+    bool target_afr_valid;
     bool timing_valid;
     bool battery_valid;
     bool mat_valid;
@@ -68,6 +40,28 @@ struct HolleyEngineData {
     uint32_t last_coolant_time;
     uint32_t last_fuel_flow_time;
     uint32_t last_update_time;
+    
+    // Sender of the last decoded frame
+    HolleyDBC::Address last_source;
+};
+
+// Number of entries in the signal bindings table (HolleySniper.cpp)
+#define HOLLEY_BOUND_MESSAGES   10
+
+// Inter-arrival jitter histogram: |interval - mean interval| in microseconds,
+// bucket i counts values below HOLLEY_JITTER_BOUNDS[i], the last one the rest
+#define HOLLEY_JITTER_BUCKETS   6
+#define HOLLEY_JITTER_BOUNDS    {100, 500, 1000, 5000, 20000, UINT32_MAX}
+
+#define HOLLEY_CAN_BITRATE      500000
+
+// Reception statistics of one bound message
+struct HolleyMessageStats {
+    uint32_t frames;
+    uint32_t period_frames;     // Frames since the last stats dump
+    uint32_t last_arrival;      // time_us_32() of the last frame
+    uint32_t mean_interval;     // Exponential average inter-arrival time (us)
+    uint32_t jitter[HOLLEY_JITTER_BUCKETS];
 };
 
 class HolleySniper {
@@ -75,22 +69,29 @@ private:
     MCP2515* can_controller;
     HolleyEngineData engine_data;
     
-    // Data parsing helpers
-    float extractFloat32(const uint8_t* data, uint8_t start_byte, bool big_endian = true);
-    uint64_t extractUint64(const uint8_t* data, uint8_t start_byte, bool big_endian = true);
-    bool isDataFresh(uint32_t timestamp, uint32_t max_age_ms = 5000) const;  // 5 second timeout
+    // Maps a generated message index to its entry in the signal bindings table
+    int8_t binding_index[HolleyDBC::MESSAGE_COUNT];
+    
+    // Frames read from the controller and frames that updated engine data
+    uint32_t frames_read;
+    uint32_t frames_used;
+    MCP2515Acceptance acceptance;
+    int32_t source_serial_filter;   // -1 accepts every Holley unit
     
-    // Message processing
-    void processRPMMessage(const CANFrame& frame);
-    void processCoolantTempMessage(const CANFrame& frame);
-    void processFuelFlowMessage(const CANFrame& frame);
-    void processMAPMessage(const CANFrame& frame);
-    void processTPSMessage(const CANFrame& frame);  
-    void processAFRMessage(const CANFrame& frame);
-    void processTargetAFRMessage(const CANFrame& frame);
-    void processIgnitionTimingMessage(const CANFrame& frame);
-    void processBatteryMessage(const CANFrame& frame);
-    void processMATMessage(const CANFrame& frame);
+    // Bus load, overflow and latency figures for the current stats period
+    HolleyMessageStats message_stats[HOLLEY_BOUND_MESSAGES];
+    uint32_t period_start;
+    uint32_t period_bits;
+    uint32_t overflow_events;
+    uint32_t receive_to_decode_sum;
+    uint32_t receive_to_decode_max;
+    uint32_t decode_to_publish_sum;
+    uint32_t decode_to_publish_max;
+    uint32_t latency_samples;
+    uint32_t publish_samples;
+    
+    void recordFrame(const CANFrame& frame, size_t binding, uint32_t decode_time);
+    bool isDataFresh(uint32_t timestamp, uint32_t max_age_ms = 5000) const;  // 5 second timeout
     
 public:
     // Constructor
@@ -98,6 +99,11 @@ public:
     
     // Initialization
     bool init();
+    bool configureFilters();
+    
+    // Restricts decoding to the unit with this serial (-1 for any), for buses
+    // carrying more than one Holley controller
+    void setSourceSerial(int32_t serial) { source_serial_filter = serial; }
     
     // Data processing
     bool processCANMessages();
@@ -126,12 +132,15 @@ public:
     
     // Utility functions
     float convertCelsiusToFahrenheit(float celsius) const { return (celsius * 9.0f / 5.0f) + 32.0f; }
-    float convertFahrenheitToCelsius(float fahrenheit) const { return (fahrenheit - 32.0f) * 5.0f / 9.0f; }
-    float convertLbHrToGalHr(float lb_hr, float fuel_density = 6.0f) const { return lb_hr / fuel_density; } // Gasoline ~6 lb/gal
+    static float convertFahrenheitToCelsius(float fahrenheit) { return (fahrenheit - 32.0f) * 5.0f / 9.0f; }
+    static float convertLbHrToGalHr(float lb_hr, float fuel_density = 6.0f) { return lb_hr / fuel_density; } // Gasoline ~6 lb/gal
     
     // Diagnostic functions
     void printEngineData() const;
+    void printCANStats();
+    float getMeasuredAcceptRatio() const { return frames_read ? (float)frames_used / frames_read : 0.0f; }
     uint32_t getLastUpdateTime() const { return engine_data.last_update_time; }
+    const HolleyDBC::Address& getLastSource() const { return engine_data.last_source; }
 };
 
 #endif // HOLLEY_SNIPER_H
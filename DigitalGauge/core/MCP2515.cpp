@@ -1,5 +1,6 @@
 #include "MCP2515.h"
 #include <cstring>
+#include <vector>
 
 // Configuration values for different bit rates (8MHz crystal)
 struct BitRateConfig {
@@ -27,16 +28,29 @@ const BitRateConfig bitRateConfigs[] = {
     {0x00, 0x80, 0x80}   // 1000KBPS
 };
 
+// GPIO interrupt callbacks are plain functions, so the driver that owns the INT
+// pin is kept here
+static MCP2515* irq_instance = nullptr;
+
 MCP2515::MCP2515(spi_inst_t* spi, uint8_t cs, uint8_t interrupt_pin) 
-    : spi_port(spi), pin_cs(cs), pin_int(interrupt_pin) {
+    : spi_port(spi), pin_cs(cs), pin_int(interrupt_pin),
+      rx_irq_enabled(false), irq_state(0), rx_irq_count(0) {
 }
 
+// Main context transactions mask interrupts so the INT handler never starts a
+// burst read in the middle of them
 void MCP2515::selectChip() {
+    if (rx_irq_enabled) {
+        irq_state = save_and_disable_interrupts();
+    }
     gpio_put(pin_cs, 0);
 }
 
 void MCP2515::deselectChip() {
     gpio_put(pin_cs, 1);
+    if (rx_irq_enabled) {
+        restore_interrupts(irq_state);
+    }
 }
 
 uint8_t MCP2515::spiTransfer(uint8_t data) {
@@ -53,6 +67,14 @@ void MCP2515::spiRead(uint8_t* data, size_t len) {
     spi_read_blocking(spi_port, 0x00, data, len);
 }
 
+// One chip select cycle for a whole command. Only called with interrupts
+// already masked (from the INT handler or between selectChip/deselectChip users)
+void MCP2515::burstTransfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+    gpio_put(pin_cs, 0);
+    spi_write_read_blocking(spi_port, tx, rx, len);
+    gpio_put(pin_cs, 1);
+}
+
 uint8_t MCP2515::readRegister(uint8_t reg) {
     selectChip();
     spiTransfer(MCP2515_READ);
@@ -232,27 +254,11 @@ bool MCP2515::sendFrame(uint32_t id, uint8_t* data, uint8_t dlc, bool extended)
     return sendFrame(frame);
 }
 
-bool MCP2515::readFrame(CANFrame& frame) {
-    uint8_t status = getStatus();
-    
-    uint8_t buffer_offset;
-    if (status & 0x01) {        // Message in RX buffer 0
-        buffer_offset = 0x00;
-    } else if (status & 0x02) { // Message in RX buffer 1
-        buffer_offset = 0x04;
-    } else {
-        return false;  // No message available
-    }
-    
-    // Read RX buffer
-    selectChip();
-    spiTransfer(MCP2515_READ_RX_BUFFER | buffer_offset);
-    
-    // Read ID
-    uint8_t sidh = spiTransfer(0x00);
-    uint8_t sidl = spiTransfer(0x00);
-    uint8_t eid8 = spiTransfer(0x00);
-    uint8_t eid0 = spiTransfer(0x00);
+void MCP2515::decodeRxBuffer(const uint8_t* raw, CANFrame& frame) {
+    uint8_t sidh = raw[0];
+    uint8_t sidl = raw[1];
+    uint8_t eid8 = raw[2];
+    uint8_t eid0 = raw[3];
     
     // Check if extended frame
     if (sidl & 0x08) {
@@ -269,26 +275,100 @@ bool MCP2515::readFrame(CANFrame& frame) {
         frame.id = ((uint32_t)sidh << 3) | (sidl >> 5);
     }
     
-    // Read DLC and RTR
-    uint8_t dlc_rtr = spiTransfer(0x00);
-    frame.dlc = dlc_rtr & 0x0F;
-    frame.remote = (dlc_rtr & 0x40) != 0;
+    // DLC and RTR
+    frame.dlc = raw[4] & 0x0F;
+    if (frame.dlc > 8) frame.dlc = 8;
+    frame.remote = (raw[4] & 0x40) != 0;
     
-    // Read data
-    for (uint8_t i = 0; i < frame.dlc && i < 8; i++) {
-        frame.data[i] = spiTransfer(0x00);
-    }
+    memcpy(frame.data, &raw[5], 8);
+}
+
+// Reads the oldest pending RX buffer (RXB0 first, it rolls over into RXB1) in a
+// single READ_RX_BUFFER burst. Raising CS clears the buffer's RXnIF flag.
+bool MCP2515::readRxBuffer(uint8_t status, CANFrame& frame) {
+    uint8_t tx[1 + MCP2515_RX_BUFFER_SIZE] = {0};
+    uint8_t rx[1 + MCP2515_RX_BUFFER_SIZE];
     
-    deselectChip();
+    if (status & 0x01) {        // Message in RX buffer 0
+        tx[0] = MCP2515_READ_RX_BUFFER | 0x00;
+    } else if (status & 0x02) { // Message in RX buffer 1
+        tx[0] = MCP2515_READ_RX_BUFFER | 0x04;
+    } else {
+        return false;  // No message available
+    }
     
+    burstTransfer(tx, rx, sizeof(tx));
+    decodeRxBuffer(&rx[1], frame);
+    frame.timestamp = time_us_32();
     return true;
 }
 
+bool MCP2515::readFrame(CANFrame& frame) {
+    if (rx_irq_enabled) {
+        return rx_ring.pop(frame);
+    }
+    
+    uint8_t status = getStatus();
+    return readRxBuffer(status, frame);
+}
+
 bool MCP2515::frameAvailable() {
+    if (rx_irq_enabled) {
+        return !rx_ring.empty();
+    }
+    
     uint8_t status = getStatus();
     return (status & 0x03) != 0;  // Check if either RX buffer has data
 }
 
+bool MCP2515::enableRxInterrupt() {
+    // Only RX interrupts drive the INT pin, anything else would hold it low
+    // with nobody clearing the flag
+    if (!setMode(MCP2515_MODE_CONFIG)) {
+        return false;
+    }
+    modifyRegister(MCP2515_RXB0CTRL, MCP2515_RXB0CTRL_BUKT, MCP2515_RXB0CTRL_BUKT);
+    writeRegister(MCP2515_CANINTE, MCP2515_INT_RX0IF | MCP2515_INT_RX1IF);
+    writeRegister(MCP2515_CANINTF, 0x00);
+    if (!setNormalMode()) {
+        return false;
+    }
+    
+    irq_instance = this;
+    rx_irq_enabled = true;
+    gpio_set_irq_enabled_with_callback(pin_int, GPIO_IRQ_EDGE_FALL, true, &MCP2515::gpioCallback);
+    
+    // Frames that arrived before the edge detector was armed
+    uint32_t state = save_and_disable_interrupts();
+    handleInterrupt();
+    restore_interrupts(state);
+    return true;
+}
+
+void MCP2515::gpioCallback(uint gpio, uint32_t events) {
+    if (irq_instance && gpio == irq_instance->pin_int) {
+        irq_instance->handleInterrupt();
+    }
+}
+
+// Runs in interrupt context. INT is edge triggered, so keep draining until the
+// chip releases the line or a frame arriving mid-drain would never raise a new edge.
+void MCP2515::handleInterrupt() {
+    rx_irq_count++;
+    
+    const uint8_t status_cmd[2] = {MCP2515_READ_STATUS, 0x00};
+    uint8_t status_rx[2];
+    CANFrame frame;
+    
+    while (gpio_get(pin_int) == 0) {
+        burstTransfer(status_cmd, status_rx, sizeof(status_cmd));
+        if (!readRxBuffer(status_rx[1], frame)) {
+            break;
+        }
+        rx_ring.push(frame);
+    }
+}
+
 uint8_t MCP2515::getStatus() {
     selectChip();
     spiTransfer(MCP2515_READ_STATUS);
@@ -309,6 +389,16 @@ uint8_t MCP2515::getErrorFlags() {
     return readRegister(MCP2515_EFLG);
 }
 
+// Returns the RX overflow flags raised since the last call and clears them,
+// the chip keeps RXnOVR set until software does
+uint8_t MCP2515::checkRxOverflow() {
+    uint8_t overflow = readRegister(MCP2515_EFLG) & (MCP2515_EFLG_RX0OVR | MCP2515_EFLG_RX1OVR);
+    if (overflow) {
+        modifyRegister(MCP2515_EFLG, overflow, 0x00);
+    }
+    return overflow;
+}
+
 uint8_t MCP2515::getTxErrorCount() {
     return readRegister(MCP2515_TEC);
 }
@@ -329,6 +419,24 @@ void MCP2515::disableInterrupts(uint8_t interrupts) {
     modifyRegister(MCP2515_CANINTE, interrupts, 0x00);
 }
 
+// Filter and mask registers share the TX/RX buffer ID layout
+static const uint8_t filter_regs[6] = {0x00, 0x04, 0x08, 0x10, 0x14, 0x18};  // RXF0-RXF5
+static const uint8_t mask_regs[2] = {0x20, 0x24};                             // RXM0, RXM1
+
+void MCP2515::writeIdRegisters(uint8_t base_reg, uint32_t id, bool extended) {
+    if (extended) {
+        writeRegister(base_reg, (uint8_t)(id >> 21));
+        writeRegister(base_reg + 1, (uint8_t)(((id >> 13) & 0xE0) | 0x08 | ((id >> 16) & 0x03)));
+        writeRegister(base_reg + 2, (uint8_t)(id >> 8));
+        writeRegister(base_reg + 3, (uint8_t)(id));
+    } else {
+        writeRegister(base_reg, (uint8_t)(id >> 3));
+        writeRegister(base_reg + 1, (uint8_t)(id << 5));
+        writeRegister(base_reg + 2, 0x00);
+        writeRegister(base_reg + 3, 0x00);
+    }
+}
+
 bool MCP2515::setFilter(uint8_t filter_num, uint32_t filter_id, bool extended) {
     if (filter_num > 5) return false;
     
@@ -336,27 +444,7 @@ bool MCP2515::setFilter(uint8_t filter_num, uint32_t filter_id, bool extended) {
         return false;
     }
     
-    uint8_t base_reg = 0x00;
-    switch (filter_num) {
-        case 0: base_reg = 0x00; break;  // RXF0
-        case 1: base_reg = 0x04; break;  // RXF1
-        case 2: base_reg = 0x08; break;  // RXF2
-        case 3: base_reg = 0x10; break;  // RXF3
-        case 4: base_reg = 0x14; break;  // RXF4
-        case 5: base_reg = 0x18; break;  // RXF5
-    }
-    
-    if (extended) {
-        writeRegister(base_reg, (uint8_t)(filter_id >> 21));
-        writeRegister(base_reg + 1, (uint8_t)(((filter_id >> 13) & 0xE0) | 0x08 | ((filter_id >> 16) & 0x03)));
-        writeRegister(base_reg + 2, (uint8_t)(filter_id >> 8));
-        writeRegister(base_reg + 3, (uint8_t)(filter_id));
-    } else {
-        writeRegister(base_reg, (uint8_t)(filter_id >> 3));
-        writeRegister(base_reg + 1, (uint8_t)(filter_id << 5));
-        writeRegister(base_reg + 2, 0x00);
-        writeRegister(base_reg + 3, 0x00);
-    }
+    writeIdRegisters(filter_regs[filter_num], filter_id, extended);
     
     return setNormalMode();
 }
@@ -368,19 +456,194 @@ bool MCP2515::setMask(uint8_t mask_num, uint32_t mask_value, bool extended) {
         return false;
     }
     
-    uint8_t base_reg = (mask_num == 0) ? 0x20 : 0x24;  // RXM0 or RXM1
+    writeIdRegisters(mask_regs[mask_num], mask_value, extended);
     
-    if (extended) {
-        writeRegister(base_reg, (uint8_t)(mask_value >> 21));
-        writeRegister(base_reg + 1, (uint8_t)(((mask_value >> 13) & 0xE0) | 0x08 | ((mask_value >> 16) & 0x03)));
-        writeRegister(base_reg + 2, (uint8_t)(mask_value >> 8));
-        writeRegister(base_reg + 3, (uint8_t)(mask_value));
-    } else {
-        writeRegister(base_reg, (uint8_t)(mask_value >> 3));
-        writeRegister(base_reg + 1, (uint8_t)(mask_value << 5));
-        writeRegister(base_reg + 2, 0x00);
-        writeRegister(base_reg + 3, 0x00);
+    return setNormalMode();
+}
+
+bool MCP2515::setAcceptance(const MCP2515Acceptance& acceptance) {
+    if (!setMode(MCP2515_MODE_CONFIG)) {
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < 2; i++) {
+        writeIdRegisters(mask_regs[i], acceptance.masks[i], acceptance.extended);
+    }
+    for (uint8_t i = 0; i < 6; i++) {
+        writeIdRegisters(filter_regs[i], acceptance.filters[i], acceptance.extended);
     }
     
     return setNormalMode();
 }
+
+// Counts distinct values of (id & mask) over the IDs selected by members,
+// stopping once more than limit are found. Values are stored in classes.
+static size_t collectClasses(const uint32_t* ids, size_t count, uint32_t members, uint32_t mask,
+                             uint32_t* classes, size_t limit) {
+    size_t class_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!(members & (1u << i))) continue;
+        uint32_t value = ids[i] & mask;
+        size_t j = 0;
+        while (j < class_count && classes[j] != value) j++;
+        if (j == class_count) {
+            if (class_count == limit) return limit + 1;
+            classes[class_count++] = value;
+        }
+    }
+    return class_count;
+}
+
+// Unwanted known IDs that pass any of the given filter values
+static uint16_t countFalseAccepts(const std::vector<uint32_t>& unwanted,
+                                  uint32_t mask, const uint32_t* classes, size_t class_count) {
+    uint16_t count = 0;
+    for (uint32_t id : unwanted) {
+        for (size_t c = 0; c < class_count; c++) {
+            if ((id & mask) == classes[c]) {
+                count++;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// Exhaustive search over mask pairs. Every candidate mask keeps all ID bits the
+// wanted IDs agree on and drops a subset of the bits they differ in; a mask with
+// every differing bit dropped is always feasible. Filters are the distinct
+// (id & mask) values: up to 2 for RXB0 and the remaining ones (up to 4) for RXB1.
+// Cost is the number of other known IDs let through, then the size of the
+// accepted ID space, so unknown traffic is kept out as well.
+bool MCP2515::computeAcceptance(const uint32_t* wanted, size_t wanted_count,
+                                const uint32_t* known, size_t known_count,
+                                bool extended, MCP2515Acceptance& result) {
+    if (wanted_count == 0 || wanted_count > MCP2515_ACCEPTANCE_MAX_IDS) {
+        return false;
+    }
+    
+    const uint32_t width = extended ? 0x1FFFFFFF : 0x7FF;
+    uint32_t any = 0, all = width;
+    for (size_t i = 0; i < wanted_count; i++) {
+        any |= wanted[i] & width;
+        all &= wanted[i] & width;
+    }
+    uint32_t differing = any ^ all;
+    
+    std::vector<uint32_t> unwanted;
+    for (size_t k = 0; k < known_count; k++) {
+        bool is_wanted = false;
+        for (size_t i = 0; i < wanted_count && !is_wanted; i++) {
+            is_wanted = (known[k] & width) == (wanted[i] & width);
+        }
+        if (!is_wanted) unwanted.push_back(known[k] & width);
+    }
+    
+    // Bits searched exhaustively, lowest differing ones first
+    uint8_t search_bits[MCP2515_ACCEPTANCE_SEARCH_BITS];
+    uint8_t search_count = 0;
+    for (uint8_t bit = 0; bit < 29 && search_count < MCP2515_ACCEPTANCE_SEARCH_BITS; bit++) {
+        if (differing & (1u << bit)) search_bits[search_count++] = bit;
+    }
+    
+    uint32_t candidates[(1 << MCP2515_ACCEPTANCE_SEARCH_BITS) + 1];
+    size_t candidate_count = 0;
+    for (uint32_t subset = 0; subset < (1u << search_count); subset++) {
+        uint32_t dropped = 0;
+        for (uint8_t b = 0; b < search_count; b++) {
+            if (subset & (1u << b)) dropped |= 1u << search_bits[b];
+        }
+        candidates[candidate_count++] = width & ~dropped;
+    }
+    if (search_count < __builtin_popcount(differing)) {
+        candidates[candidate_count++] = width & ~differing;
+    }
+    
+    const uint32_t all_members = wanted_count == 32 ? 0xFFFFFFFF : ((1u << wanted_count) - 1);
+    bool found = false;
+    uint32_t best_false = 0xFFFFFFFF;
+    uint64_t best_space = 0;
+    
+    for (size_t c0 = 0; c0 < candidate_count; c0++) {
+        uint32_t m0 = candidates[c0];
+        uint32_t classes0[MCP2515_ACCEPTANCE_MAX_IDS];
+        size_t count0 = collectClasses(wanted, wanted_count, all_members, m0, classes0, MCP2515_ACCEPTANCE_MAX_IDS);
+        uint64_t space0 = 1ULL << __builtin_popcount(width & ~m0);
+        
+        // RXB0 takes none, one or two of the classes under RXM0
+        for (size_t a = 0; a <= count0; a++) {
+            for (size_t b = a; b <= count0; b++) {
+                if (b == a && a != count0) continue;    // (a, a) only for the empty choice
+                uint32_t chosen0[2] = {0, 0};
+                size_t chosen0_count = 0;
+                if (a < count0) chosen0[chosen0_count++] = classes0[a];
+                if (b < count0 && b != a) chosen0[chosen0_count++] = classes0[b];
+                
+                uint32_t rest = 0;
+                for (size_t i = 0; i < wanted_count; i++) {
+                    bool covered = false;
+                    for (size_t k = 0; k < chosen0_count; k++) {
+                        covered |= (wanted[i] & m0) == chosen0[k];
+                    }
+                    if (!covered) rest |= 1u << i;
+                }
+                uint32_t false0 = countFalseAccepts(unwanted, m0, chosen0, chosen0_count);
+                if (false0 > best_false) continue;
+                
+                for (size_t c1 = 0; c1 < candidate_count; c1++) {
+                    uint32_t m1 = candidates[c1];
+                    uint32_t classes1[4] = {0, 0, 0, 0};
+                    size_t count1 = collectClasses(wanted, wanted_count, rest, m1, classes1, 4);
+                    if (count1 > 4) continue;
+                    
+                    uint32_t false_accepts = false0 + countFalseAccepts(unwanted, m1, classes1, count1);
+                    uint64_t space = space0 * chosen0_count + (1ULL << __builtin_popcount(width & ~m1)) * count1;
+                    if (found && (false_accepts > best_false || (false_accepts == best_false && space >= best_space))) {
+                        continue;
+                    }
+                    
+                    found = true;
+                    best_false = false_accepts;
+                    best_space = space;
+                    result.masks[0] = m0;
+                    result.masks[1] = m1;
+                    // Unused filter slots repeat a used one so they accept nothing new,
+                    // an unused buffer mirrors the other one instead of accepting everything
+                    for (size_t k = 0; k < 2; k++) {
+                        result.filters[k] = chosen0[k < chosen0_count ? k : 0];
+                    }
+                    for (size_t k = 0; k < 4; k++) {
+                        result.filters[2 + k] = classes1[k < count1 ? k : 0];
+                    }
+                    if (chosen0_count == 0) {
+                        result.masks[0] = m1;
+                        result.filters[0] = result.filters[1] = classes1[0];
+                    } else if (count1 == 0) {
+                        result.masks[1] = m0;
+                        result.filters[2] = result.filters[3] = result.filters[4] = result.filters[5] = chosen0[0];
+                    }
+                }
+            }
+        }
+    }
+    
+    if (!found) {
+        return false;
+    }
+    
+    // Exact figures for the chosen configuration
+    result.extended = extended;
+    result.wanted = (uint16_t)wanted_count;
+    result.known_total = (uint16_t)known_count;
+    result.known_accepted = 0;
+    for (size_t k = 0; k < known_count; k++) {
+        for (size_t f = 0; f < 6; f++) {
+            if ((known[k] & result.masks[f < 2 ? 0 : 1]) == result.filters[f]) {
+                result.known_accepted++;
+                break;
+            }
+        }
+    }
+    result.expected_ratio = result.known_accepted ? (float)wanted_count / result.known_accepted : 1.0f;
+    return true;
+}
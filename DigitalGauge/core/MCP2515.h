@@ -4,6 +4,8 @@
 #include "pico/stdlib.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include "SPSCRing.h"
 
 // MCP2515 Commands
 #define MCP2515_RESET           0xC0
@@ -70,6 +72,16 @@
 #define MCP2515_RXB1DLC         0x75
 #define MCP2515_RXB1DATA        0x76
 
+// RXB0CTRL bits
+#define MCP2515_RXB0CTRL_BUKT   0x04    // Roll over into RXB1 when RXB0 is full
+
+// Size of one RX buffer burst read: SIDH, SIDL, EID8, EID0, DLC and 8 data bytes
+#define MCP2515_RX_BUFFER_SIZE  13
+
+// Frames buffered between the INT handler and the main loop (power of two).
+// Covers one 100ms UI frame at 100% load on a 500kbps bus (~385 frames)
+#define MCP2515_RX_RING_SIZE    512
+
 // Control register bits
 #define MCP2515_MODE_NORMAL     0x00
 #define MCP2515_MODE_SLEEP      0x20
@@ -88,6 +100,10 @@
 #define MCP2515_INT_WAKIF       0x40
 #define MCP2515_INT_MERRF       0x80
 
+// Error flags
+#define MCP2515_EFLG_RX0OVR     0x40
+#define MCP2515_EFLG_RX1OVR     0x80
+
 // CAN frame structure
 struct CANFrame {
     uint32_t id;
@@ -95,8 +111,26 @@ struct CANFrame {
     uint8_t data[8];
     bool extended;      // Extended frame format
     bool remote;        // Remote transmission request
+    uint32_t timestamp; // time_us_32() when read from the controller
+};
+
+// Acceptance mask/filter set for the MCP2515 RX structure: RXM0 with RXF0-1
+// feeds RXB0, RXM1 with RXF2-5 feeds RXB1
+struct MCP2515Acceptance {
+    uint32_t masks[2];
+    uint32_t filters[6];
+    bool extended;
+    uint16_t wanted;            // IDs the configuration was computed for
+    uint16_t known_accepted;    // Known bus IDs that pass (wanted ones included)
+    uint16_t known_total;       // Known bus IDs considered
+    float expected_ratio;       // wanted / known_accepted, with every known ID at the same rate
 };
 
+// Wanted IDs handled by computeAcceptance() and the number of ID bits it tries
+// as don't-care bits exhaustively (bounds the search to ~2^6 masks per buffer)
+#define MCP2515_ACCEPTANCE_MAX_IDS      32
+#define MCP2515_ACCEPTANCE_SEARCH_BITS  6
+
 // CAN bit rates (for 8MHz crystal)
 enum CANBitRate {
     CAN_5KBPS = 0,
@@ -123,12 +157,22 @@ private:
     uint8_t pin_cs;
     uint8_t pin_int;
     
+    // Interrupt driven reception
+    SPSCRing<CANFrame, MCP2515_RX_RING_SIZE> rx_ring;
+    volatile bool rx_irq_enabled;
+    uint32_t irq_state;         // Saved interrupt state while the main context owns the bus
+    uint32_t rx_irq_count;
+    
     // Low-level SPI communication
     void selectChip();
     void deselectChip();
     uint8_t spiTransfer(uint8_t data);
     void spiWrite(uint8_t* data, size_t len);
     void spiRead(uint8_t* data, size_t len);
+    void burstTransfer(const uint8_t* tx, uint8_t* rx, size_t len);
+    bool readRxBuffer(uint8_t status, CANFrame& frame);
+    static void decodeRxBuffer(const uint8_t* raw, CANFrame& frame);
+    static void gpioCallback(uint gpio, uint32_t events);
     
     // Register operations
     uint8_t readRegister(uint8_t reg);
@@ -140,6 +184,7 @@ private:
     uint8_t getMode();
     bool setMode(uint8_t mode);
     void configureBitRate(CANBitRate bitRate);
+    void writeIdRegisters(uint8_t base_reg, uint32_t id, bool extended);
     
 public:
     // Constructor
@@ -161,11 +206,19 @@ public:
     bool readFrame(CANFrame& frame);
     bool frameAvailable();
     
+    // Interrupt driven reception: the INT handler burst reads every frame into
+    // a ring buffer and readFrame() consumes from it instead of polling the chip
+    bool enableRxInterrupt();
+    void handleInterrupt();
+    uint32_t getRxDroppedCount() const { return rx_ring.droppedCount(); }
+    uint32_t getRxInterruptCount() const { return rx_irq_count; }
+    
     // Status and diagnostics
     uint8_t getStatus();
     uint8_t getInterruptFlags();
     void clearInterruptFlags(uint8_t flags = 0xFF);
     uint8_t getErrorFlags();
+    uint8_t checkRxOverflow();
     uint8_t getTxErrorCount();
     uint8_t getRxErrorCount();
     
@@ -177,6 +230,13 @@ public:
     // Filters and masks (for advanced filtering)
     bool setFilter(uint8_t filter_num, uint32_t filter_id, bool extended = false);
     bool setMask(uint8_t mask_num, uint32_t mask_value, bool extended = false);
+    
+    // Computes the 2 mask / 6 filter set accepting every wanted ID while letting
+    // through the fewest other known bus IDs, then programs it in one config cycle
+    static bool computeAcceptance(const uint32_t* wanted, size_t wanted_count,
+                                  const uint32_t* known, size_t known_count,
+                                  bool extended, MCP2515Acceptance& result);
+    bool setAcceptance(const MCP2515Acceptance& acceptance);
 };
 
 #endif // MCP2515_H
@@ -0,0 +1,103 @@
+#include "PackedImage.h"
+
+PackedImageDecoder::PackedImageDecoder(const PackedImage& image) : image(image) {
+    rewind();
+}
+
+void PackedImageDecoder::rewind() {
+    src = image.data;
+    end = image.data + image.data_size;
+    remaining = 0;
+    run = false;
+    high_nibble = true;
+    value = 0;
+    pixels_left = (uint32_t)image.width * image.height;
+}
+
+// Out of range indices (a damaged stream) decode as black
+uint16_t PackedImageDecoder::color(uint8_t index) const {
+    return index < image.palette_size ? image.palette[index] : 0;
+}
+
+bool PackedImageDecoder::nextPacket() {
+    if (src >= end) {
+        return false;
+    }
+    
+    uint8_t control = *src++;
+    run = (control & 0x80) != 0;
+    remaining = (control & 0x7F) + 1;
+    high_nibble = true;
+    
+    if (run) {
+        switch (image.format) {
+        case PACKED_IMAGE_RGB565:
+            if (end - src < 2) return false;
+            value = (uint16_t)(src[0] | (src[1] << 8));
+            src += 2;
+            break;
+        default:
+            if (src >= end) return false;
+            value = color(image.format == PACKED_IMAGE_INDEX4 ? (*src & 0x0F) : *src);
+            src++;
+            break;
+        }
+    }
+    return true;
+}
+
+uint32_t PackedImageDecoder::read(uint16_t* out, uint32_t count) {
+    if (count > pixels_left) {
+        count = pixels_left;
+    }
+    
+    uint32_t written = 0;
+    while (written < count) {
+        if (remaining == 0 && !nextPacket()) {
+            break;
+        }
+        
+        uint32_t n = count - written;
+        if (n > remaining) n = remaining;
+        
+        if (run) {
+            for (uint32_t i = 0; i < n; i++) {
+                out[written + i] = value;
+            }
+        } else if (image.format == PACKED_IMAGE_RGB565) {
+            if ((uint32_t)(end - src) < n * 2) break;
+            for (uint32_t i = 0; i < n; i++) {
+                out[written + i] = (uint16_t)(src[0] | (src[1] << 8));
+                src += 2;
+            }
+        } else if (image.format == PACKED_IMAGE_INDEX8) {
+            if ((uint32_t)(end - src) < n) break;
+            for (uint32_t i = 0; i < n; i++) {
+                out[written + i] = color(*src++);
+            }
+        } else {
+            // Literal nibbles are packed high first, a packet starts on a byte
+            uint32_t needed = high_nibble ? (n + 1) / 2 : (n + 2) / 2;
+            if ((uint32_t)(end - src) < needed) break;
+            for (uint32_t i = 0; i < n; i++) {
+                if (high_nibble) {
+                    out[written + i] = color(*src >> 4);
+                } else {
+                    out[written + i] = color(*src++ & 0x0F);
+                }
+                high_nibble = !high_nibble;
+            }
+            // The last odd nibble of a packet leaves its byte behind
+            if (remaining == n && !high_nibble) {
+                src++;
+                high_nibble = true;
+            }
+        }
+        
+        remaining -= n;
+        written += n;
+    }
+    
+    pixels_left -= written;
+    return written;
+}
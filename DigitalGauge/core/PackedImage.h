@@ -0,0 +1,51 @@
+#ifndef PACKED_IMAGE_H
+#define PACKED_IMAGE_H
+
+#include "pico/stdlib.h"
+
+// Pixel encodings of a packed image (see tools/image_pack.py)
+#define PACKED_IMAGE_RGB565 0       // 2 bytes per value, panel byte order
+#define PACKED_IMAGE_INDEX8 1       // 1 byte palette index per value
+#define PACKED_IMAGE_INDEX4 2       // Nibble palette index, literals 2 per byte
+
+// Run-length coded image kept in flash. The stream is a sequence of packets
+// with a control byte n: bit 7 set is a run of (n & 0x7F) + 1 copies of one
+// value, clear is n + 1 literal values. Runs may cross row boundaries.
+struct PackedImage {
+    uint16_t width, height;
+    uint8_t format;
+    uint16_t palette_size;
+    const uint16_t* palette;    // Panel byte order, nullptr for RGB565
+    const uint8_t* data;
+    uint32_t data_size;
+};
+
+// Streams the pixels of a PackedImage in row-major order, a buffer at a time
+class PackedImageDecoder {
+private:
+    const PackedImage& image;
+    const uint8_t* src;
+    const uint8_t* end;
+    uint8_t remaining;          // Values left in the current packet
+    bool run;                   // Current packet is a run of value
+    bool high_nibble;           // Next INDEX4 literal is in the high nibble
+    uint16_t value;
+    uint32_t pixels_left;
+    
+    uint16_t color(uint8_t index) const;
+    bool nextPacket();
+    
+public:
+    explicit PackedImageDecoder(const PackedImage& image);
+    
+    void rewind();
+    
+    // Expands up to count pixels (panel byte order) into out, returns how
+    // many were written; fewer than asked only at the end of the image or on
+    // a truncated stream
+    uint32_t read(uint16_t* out, uint32_t count);
+    
+    uint32_t pixelsLeft() const { return pixels_left; }
+};
+
+#endif // PACKED_IMAGE_H
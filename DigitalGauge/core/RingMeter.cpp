@@ -0,0 +1,154 @@
+#include "RingMeter.h"
+#include <cmath>
+#include <cstdlib>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+RingMeter::RingMeter(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t inner_radius, uint16_t outer_radius,
+                     float start_angle, float end_angle)
+    : display(display), cx(cx), cy(cy), inner_radius(inner_radius), outer_radius(outer_radius),
+      start_angle(start_angle), segments(nullptr), segment_count(0), angles(nullptr), pixel_count(0) {
+    float span = end_angle - start_angle;
+    if (span < 0.0f) span = 0.0f;
+    if (span > 360.0f) span = 360.0f;
+    sweep = (uint32_t)(span / 360.0f * (RING_METER_TURN - 1));
+}
+
+RingMeter::~RingMeter() {
+    free(segments);
+    free(angles);
+}
+
+// Two passes over the annulus bounding box: count, then fill. Along a row
+// the angle seen from the centre is monotonic, so a segment only breaks at
+// the inner hole, at the meter's start (where relative angles wrap) or
+// where pixels leave the sweep.
+bool RingMeter::build() {
+    if (angles) {
+        return true;
+    }
+    
+    // Pixel rings inner_radius..outer_radius inclusive, judged at pixel centres
+    float inner_edge = inner_radius > 0 ? inner_radius - 0.5f : 0.0f;
+    float outer_edge = outer_radius + 0.5f;
+    float inner_sq = inner_edge * inner_edge;
+    float outer_sq = outer_edge * outer_edge;
+    int32_t start = (int32_t)lroundf(start_angle / 360.0f * RING_METER_TURN);
+    
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t pixels = 0;
+        uint16_t count = 0;
+        
+        for (int32_t y = (int32_t)cy - outer_radius; y <= (int32_t)cy + outer_radius; y++) {
+            if (y < 0 || y >= GC9A01_HEIGHT) continue;
+            
+            bool open = false;
+            int32_t last_x = -2;
+            uint16_t last_angle = 0;
+            
+            for (int32_t x = (int32_t)cx - outer_radius; x <= (int32_t)cx + outer_radius; x++) {
+                if (x < 0 || x >= GC9A01_WIDTH) continue;
+                
+                float dx = x - (float)cx;
+                float dy = y - (float)cy;
+                float dist_sq = dx * dx + dy * dy;
+                if (dist_sq < inner_sq || dist_sq > outer_sq) continue;
+                
+                int32_t absolute = (int32_t)lroundf(atan2f(dy, dx) / (2.0f * M_PI) * RING_METER_TURN);
+                uint16_t angle = (uint16_t)((absolute - start) & (RING_METER_TURN - 1));
+                if (angle > sweep) {
+                    open = false;
+                    continue;
+                }
+                
+                // A jump of more than half a turn is the wrap at the start
+                bool wrapped = open && abs((int32_t)angle - (int32_t)last_angle) > RING_METER_TURN / 2;
+                if (!open || x != last_x + 1 || wrapped) {
+                    if (pass == 1) {
+                        segments[count] = {(uint16_t)y, (uint16_t)x, 0, false, pixels};
+                    }
+                    count++;
+                    open = true;
+                }
+                
+                if (pass == 1) {
+                    RingSegment& segment = segments[count - 1];
+                    if (segment.count == 1) {
+                        segment.descending = angle < angles[segment.first];
+                    }
+                    angles[pixels] = angle;
+                    segment.count++;
+                }
+                pixels++;
+                last_x = x;
+                last_angle = angle;
+            }
+        }
+        
+        if (pass == 0) {
+            segments = (RingSegment*)malloc(count * sizeof(RingSegment));
+            angles = (uint16_t*)malloc(pixels * sizeof(uint16_t));
+            if (!segments || !angles) {
+                free(segments);
+                free(angles);
+                segments = nullptr;
+                angles = nullptr;
+                return false;
+            }
+        }
+        segment_count = count;
+        pixel_count = pixels;
+    }
+    return true;
+}
+
+uint32_t RingMeter::position(float fraction) const {
+    // A NaN (a missing signal, or min == max) or infinite value shows empty
+    if (!std::isfinite(fraction)) return 0;
+    if (fraction < 0.0f) fraction = 0.0f;
+    if (fraction > 1.0f) fraction = 1.0f;
+    return (uint32_t)lroundf(fraction * (sweep + 1));
+}
+
+// Pixels of a segment with lo <= angle < hi, as [begin, end) indices. The
+// angles are sorted along the segment, so both ends are binary searches.
+void RingMeter::spanRange(const RingSegment& segment, uint32_t lo, uint32_t hi, uint16_t& begin, uint16_t& end) const {
+    const uint16_t* a = &angles[segment.first];
+    
+    // First index whose angle is inside (ascending) or below hi (descending)
+    auto search = [&](uint32_t bound) {
+        uint16_t left = 0, right = segment.count;
+        while (left < right) {
+            uint16_t mid = (left + right) / 2;
+            bool before = segment.descending ? a[mid] >= bound : a[mid] < bound;
+            if (before) left = mid + 1;
+            else right = mid;
+        }
+        return left;
+    };
+    
+    if (segment.descending) {
+        begin = search(hi);
+        end = search(lo);
+    } else {
+        begin = search(lo);
+        end = search(hi);
+    }
+}
+
+void RingMeter::fill(uint32_t lo, uint32_t hi, uint16_t color) {
+    if (lo >= hi || !build()) {
+        return;
+    }
+    
+    for (uint16_t i = 0; i < segment_count; i++) {
+        const RingSegment& segment = segments[i];
+        uint16_t begin, end;
+        spanRange(segment, lo, hi, begin, end);
+        if (begin < end) {
+            display.fillRect(segment.x0 + begin, segment.y, end - begin, 1, color);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef RING_METER_H
+#define RING_METER_H
+
+#include "GC9A01.h"
+
+// Angles in the polar map are fractions of a turn, 65536 per revolution
+#define RING_METER_TURN 65536
+
+// One run of annulus pixels on a row, with angles that only grow or only
+// shrink along it
+struct RingSegment {
+    uint16_t y;
+    uint16_t x0;
+    uint16_t count;
+    bool descending;
+    uint32_t first;             // Index of its first pixel in the angle map
+};
+
+// Ring meter on an annulus of the round panel (pixel rings inner_radius to
+// outer_radius). A one-time polar map stores,
+// row by row, the angle of every annulus pixel relative to the start of the
+// meter, so filling positions lo..hi is one binary search and at most one
+// span per segment. Positions run clockwise from the start angle (degrees,
+// 0 is 3 o'clock) over the sweep; a pixel is lit below the current position.
+class RingMeter {
+private:
+    GC9A01& display;
+    uint16_t cx, cy;
+    uint16_t inner_radius, outer_radius;
+    float start_angle;
+    uint32_t sweep;             // Meter length in map units
+    
+    RingSegment* segments;
+    uint16_t segment_count;
+    uint16_t* angles;           // Per pixel, relative to the start
+    uint32_t pixel_count;
+    
+    void spanRange(const RingSegment& segment, uint32_t lo, uint32_t hi, uint16_t& begin, uint16_t& end) const;
+    
+public:
+    RingMeter(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t inner_radius, uint16_t outer_radius,
+              float start_angle, float end_angle);
+    ~RingMeter();
+    
+    // Precomputes the polar map (floating point, once). fill() builds it on
+    // first use; call it up front to keep that out of the first frame.
+    bool build();
+    
+    uint32_t getSweep() const { return sweep; }
+    uint32_t position(float fraction) const;
+    
+    // Paints the pixels at positions lo <= p < hi, one fillRect per segment
+    void fill(uint32_t lo, uint32_t hi, uint16_t color);
+    
+    uint32_t getPixelCount() const { return pixel_count; }
+    uint32_t getMapBytes() const { return pixel_count * sizeof(uint16_t) + segment_count * sizeof(RingSegment); }
+};
+
+#endif // RING_METER_H
@@ -0,0 +1,48 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single producer / single consumer ring buffer. The producer is
+// typically an interrupt handler and the consumer the main loop, so neither
+// side ever blocks: a push into a full ring is dropped and counted.
+template <typename T, size_t N>
+class SPSCRing {
+    static_assert((N & (N - 1)) == 0, "SPSCRing size must be a power of two");
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head{0};     // Next slot to write (producer only)
+    std::atomic<uint32_t> tail{0};     // Next slot to read (consumer only)
+    std::atomic<uint32_t> dropped{0};  // Items rejected because the ring was full
+
+public:
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = items[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    uint32_t droppedCount() const { return dropped.load(std::memory_order_relaxed); }
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,56 @@
+#ifndef SNAPSHOT_BUFFER_H
+#define SNAPSHOT_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single writer / single reader latest-value exchange, meant for
+// handing state from one core to the other. The writer alternates between two
+// slots, each guarded by its own sequence count (odd while being written), so
+// a reader only retries if the writer laps it twice during one copy.
+template <typename T>
+class SnapshotBuffer {
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence{0};
+        T value;
+    };
+    Slot slots[2];
+    std::atomic<uint32_t> version{0};  // Snapshots published so far
+    std::atomic<uint32_t> retries{0};  // Reads that raced the writer
+
+public:
+    void publish(const T& value) {
+        uint32_t next = version.load(std::memory_order_relaxed) + 1;
+        Slot& slot = slots[next & 1];
+        uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.value = value;
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        version.store(next, std::memory_order_release);
+    }
+
+    // Copies the newest snapshot and returns its version (0: none published yet)
+    uint32_t read(T& value) {
+        while (true) {
+            uint32_t current = version.load(std::memory_order_acquire);
+            const Slot& slot = slots[current & 1];
+            uint32_t before = slot.sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                value = slot.value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                    return current;
+                }
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t getVersion() const { return version.load(std::memory_order_acquire); }
+    uint32_t retryCount() const { return retries.load(std::memory_order_relaxed); }
+};
+
+#endif // SNAPSHOT_BUFFER_H
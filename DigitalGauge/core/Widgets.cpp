@@ -0,0 +1,173 @@
+#include "Widgets.h"
+#include <cstdio>
+#include <cstring>
+
+Widget::Widget(GC9A01& display, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t bg)
+    : display(display), x(x), y(y), width(width), height(height), bg(bg), visible(true), needs_redraw(true) {
+}
+
+void Widget::setVisible(bool visible) {
+    if (this->visible != visible) {
+        this->visible = visible;
+        needs_redraw = true;
+    }
+}
+
+void Widget::erase() {
+    display.fillRect(x, y, width, height, bg);
+}
+
+bool Widget::render() {
+    if (!needs_redraw) {
+        return false;
+    }
+    
+    if (visible) {
+        draw();
+    } else {
+        erase();
+    }
+    needs_redraw = false;
+    return true;
+}
+
+Label::Label(GC9A01& display, uint16_t x, uint16_t y, const char* text, uint16_t color, uint16_t bg, sFONT* font)
+    : Widget(display, x, y, display.textWidth(text, font), font->Height, bg), text(text), color(color), font(font) {
+}
+
+void Label::draw() {
+    display.print(x, y, text, color, bg, font);
+}
+
+Readout::Readout(GC9A01& display, uint16_t x, uint16_t y, uint16_t width, sFONT* font, const char* format,
+                 uint16_t bg, WidgetAlign align)
+    : Widget(display, x, y, width, font->Height, bg), format(format), font(font), align(align), color(bg) {
+    text[0] = '\0';
+}
+
+void Readout::setValue(float value, uint16_t color) {
+    char formatted[WIDGET_TEXT_SIZE];
+    snprintf(formatted, sizeof(formatted), format, value);
+    setText(formatted, color);
+}
+
+void Readout::setText(const char* text, uint16_t color) {
+    if (this->color == color && strcmp(this->text, text) == 0) {
+        return;
+    }
+    strncpy(this->text, text, sizeof(this->text) - 1);
+    this->text[sizeof(this->text) - 1] = '\0';
+    this->color = color;
+    needs_redraw = true;
+}
+
+// Text plus background padding on either side, so the field is repainted in
+// one pass without clearing it first
+void Readout::draw() {
+    uint16_t text_width = display.textWidth(text, font);
+    if (text_width > width) text_width = width;
+    
+    uint16_t pad = 0;
+    if (align == ALIGN_CENTER) pad = (width - text_width) / 2;
+    else if (align == ALIGN_RIGHT) pad = width - text_width;
+    
+    if (pad > 0) {
+        display.fillRect(x, y, pad, height, bg);
+    }
+    display.printField(x + pad, y, width - pad, text, color, bg, font);
+}
+
+StatusDot::StatusDot(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t radius, uint16_t color, uint16_t bg)
+    : Widget(display, cx - radius, cy - radius, radius * 2 + 1, radius * 2 + 1, bg), radius(radius), color(color) {
+}
+
+void StatusDot::setColor(uint16_t color) {
+    if (this->color != color) {
+        this->color = color;
+        needs_redraw = true;
+    }
+}
+
+void StatusDot::draw() {
+    display.fillCircle(x + radius, y + radius, radius, color);
+}
+
+ArcGauge::ArcGauge(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t radius, uint8_t thickness,
+                   int16_t start_angle, int16_t end_angle, float min_value, float max_value,
+                   uint16_t track_color, uint16_t bg)
+    : Widget(display, cx - radius, cy - radius, radius * 2 + 1, radius * 2 + 1, bg),
+      ring(display, cx, cy, radius - thickness + 1, radius, start_angle, end_angle),
+      min_value(min_value), max_value(max_value), track_color(track_color),
+      position(0), color(track_color), drawn_position(-1), drawn_color(track_color) {
+}
+
+void ArcGauge::setValue(float value, uint16_t color) {
+    uint32_t new_position = ring.position((value - min_value) / (max_value - min_value));
+    if (new_position != position || color != this->color) {
+        position = new_position;
+        this->color = color;
+        needs_redraw = true;
+    }
+}
+
+void ArcGauge::draw() {
+    uint32_t end = ring.getSweep() + 1;
+    
+    // First paint (or after being hidden): filled part, then the track
+    if (drawn_position < 0) {
+        ring.fill(0, position, color);
+        ring.fill(position, end, track_color);
+    } else if (color != drawn_color) {
+        // Colour band changed, the whole filled part is repainted
+        ring.fill(0, position, color);
+        if ((uint32_t)drawn_position > position) {
+            ring.fill(position, drawn_position, track_color);
+        }
+    } else if (position > (uint32_t)drawn_position) {
+        ring.fill(drawn_position, position, color);
+    } else {
+        ring.fill(position, drawn_position, track_color);
+    }
+    
+    drawn_position = position;
+    drawn_color = color;
+}
+
+// The bounding box holds the whole circle, only the ring itself is cleared
+void ArcGauge::erase() {
+    ring.fill(0, ring.getSweep() + 1, bg);
+    drawn_position = -1;
+}
+
+void ArcGauge::invalidate() {
+    drawn_position = -1;
+    needs_redraw = true;
+}
+
+WidgetScreen::WidgetScreen() : count(0), redraws(0) {
+}
+
+bool WidgetScreen::add(Widget& widget) {
+    if (count >= WIDGET_SCREEN_MAX) {
+        return false;
+    }
+    widgets[count++] = &widget;
+    return true;
+}
+
+void WidgetScreen::invalidateAll() {
+    for (uint8_t i = 0; i < count; i++) {
+        widgets[i]->invalidate();
+    }
+}
+
+uint8_t WidgetScreen::render() {
+    uint8_t drawn = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (widgets[i]->render()) {
+            drawn++;
+        }
+    }
+    redraws += drawn;
+    return drawn;
+}
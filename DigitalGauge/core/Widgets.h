@@ -0,0 +1,142 @@
+#ifndef WIDGETS_H
+#define WIDGETS_H
+
+#include "GC9A01.h"
+#include "RingMeter.h"
+
+// Widgets a WidgetScreen can hold
+#define WIDGET_SCREEN_MAX 24
+
+// Longest formatted readout text, including the terminator
+#define WIDGET_TEXT_SIZE 16
+
+enum WidgetAlign {
+    ALIGN_LEFT,
+    ALIGN_CENTER,
+    ALIGN_RIGHT
+};
+
+// Retained-mode widget: keeps what it last drew and only repaints its own
+// bounding box when that changes. Setters just record the new state, the
+// drawing happens in render().
+class Widget {
+protected:
+    GC9A01& display;
+    uint16_t x, y, width, height;   // Bounding box
+    uint16_t bg;
+    bool visible;
+    bool needs_redraw;
+    
+    virtual void draw() = 0;
+    virtual void erase();           // Paints what draw() drew with bg
+    
+public:
+    Widget(GC9A01& display, uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t bg);
+    virtual ~Widget() {}
+    
+    void setVisible(bool visible);
+    virtual void invalidate() { needs_redraw = true; }
+    bool isVisible() const { return visible; }
+    
+    // Repaints the widget if its output changed, returns whether it did
+    bool render();
+};
+
+// Static text
+class Label : public Widget {
+private:
+    const char* text;
+    uint16_t color;
+    sFONT* font;
+    
+protected:
+    void draw() override;
+    
+public:
+    Label(GC9A01& display, uint16_t x, uint16_t y, const char* text, uint16_t color, uint16_t bg, sFONT* font);
+};
+
+// Formatted value in a fixed width field. Output is compared as text, so a
+// value that moves below the shown precision costs nothing.
+class Readout : public Widget {
+private:
+    const char* format;             // printf format for a single float
+    sFONT* font;
+    WidgetAlign align;
+    char text[WIDGET_TEXT_SIZE];
+    uint16_t color;
+    
+protected:
+    void draw() override;
+    
+public:
+    Readout(GC9A01& display, uint16_t x, uint16_t y, uint16_t width, sFONT* font, const char* format,
+            uint16_t bg, WidgetAlign align = ALIGN_LEFT);
+    
+    void setValue(float value, uint16_t color);
+    void setText(const char* text, uint16_t color);
+};
+
+// Filled circle whose colour reflects a state
+class StatusDot : public Widget {
+private:
+    uint16_t radius;
+    uint16_t color;
+    
+protected:
+    void draw() override;
+    
+public:
+    StatusDot(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t radius, uint16_t color, uint16_t bg);
+    
+    void setColor(uint16_t color);
+};
+
+// Bar bent along an arc of the round panel, drawn through a RingMeter. A
+// change only repaints the row spans between the old and new end. Angles are
+// in degrees, clockwise from 3 o'clock.
+class ArcGauge : public Widget {
+private:
+    RingMeter ring;
+    float min_value, max_value;
+    uint16_t track_color;
+    
+    uint32_t position;              // Current end of the filled part
+    uint16_t color;
+    int32_t drawn_position;         // What the panel shows, -1: nothing yet
+    uint16_t drawn_color;
+    
+protected:
+    void draw() override;
+    void erase() override;
+    
+public:
+    ArcGauge(GC9A01& display, uint16_t cx, uint16_t cy, uint16_t radius, uint8_t thickness,
+             int16_t start_angle, int16_t end_angle, float min_value, float max_value,
+             uint16_t track_color, uint16_t bg);
+    
+    void setValue(float value, uint16_t color);
+    void invalidate() override;
+};
+
+// Ordered set of widgets rendered together once per frame
+class WidgetScreen {
+private:
+    Widget* widgets[WIDGET_SCREEN_MAX];
+    uint8_t count;
+    uint32_t redraws;               // Widget repaints since the last resetStats()
+    
+public:
+    WidgetScreen();
+    
+    bool add(Widget& widget);
+    void invalidateAll();
+    
+    // Repaints every widget whose output changed, returns how many did
+    uint8_t render();
+    
+    uint32_t getRedraws() const { return redraws; }
+    void resetStats() { redraws = 0; }
+};
+
+#endif // WIDGETS_H
@@ -8,6 +8,8 @@ DigitalGauge::DigitalGauge(/* args */)
 
     loopInterval = config->get<useconds_t>("loop_interval");
     logoTime = config->get<uint16_t>("logo_time");
+    partialFlush = config->get<bool>("partial_flush");
+    statsInterval = config->get<uint64_t>("stats_interval");
 
     logger->info("Initializing Round Display.");
     /* Module Init */
@@ -29,6 +31,11 @@ DigitalGauge::DigitalGauge(/* args */)
         BlackImage = NULL;
     }
 
+    if ((BackgroundImage = (UWORD *)malloc(Imagesize)) == NULL)
+    {
+        logger->error("Failed to apply for background memory...");
+    }
+
     setScreen(TORINO_LOGO);
     showLogo();
     std::this_thread::sleep_for(std::chrono::milliseconds(logoTime));
@@ -41,6 +48,8 @@ DigitalGauge::~DigitalGauge()
 {
     free(BlackImage);
     BlackImage = NULL;
+    free(BackgroundImage);
+    BackgroundImage = NULL;
     DEV_ModuleExit();
 }
 
@@ -48,7 +57,7 @@ void DigitalGauge::drawBmpFile(const char *pathToImageFile)
 {
     clear();
     GUI_ReadBmp(pathToImageFile);
-    LCD_1IN28_Display(BlackImage);
+    flush();
 }
 
 void DigitalGauge::setScreen(Screen screen)
@@ -57,12 +66,29 @@ void DigitalGauge::setScreen(Screen screen)
     {
     case DIGITAL_GAUGE:
         clear();
-        drawBmpFile(BACKGROUND.c_str());
-        Paint_DrawString_EN(TEMP_LABEL_X, TEMP_LABEL_Y, TEMP_LABEL, &LABELS_FONT, BLACK, WHITE);
-        Paint_DrawString_EN(KML_LABEL_X, KML_LABEL_Y, KML_LABEL, &LABELS_FONT, BLACK, WHITE);
-        Paint_DrawString_EN(VOLTS_LABEL_X, VOLTS_LABEL_Y, VOLTS_LABEL, &LABELS_FONT, BLACK, WHITE);
-        Paint_DrawString_EN(FUEL_CONS_LABEL_X, FUEL_CONS_LABEL_Y, FUEL_CONS_LABEL, &LABELS_FONT, BLACK, WHITE);
-        LCD_1IN28_Display(BlackImage);
+        // The background is read once, later switches copy it back
+        if (backgroundReady)
+        {
+            memcpy(BlackImage, BackgroundImage, Imagesize);
+            Paint_AddDamage(0, 0, LCD_1IN28_WIDTH, LCD_1IN28_HEIGHT);
+        }
+        else
+        {
+            GUI_ReadBmp(BACKGROUND.c_str());
+            // Labels over the artwork, FONT_BACKGROUND leaves the clear bits alone
+            Paint_DrawString_EN(TEMP_LABEL_X, TEMP_LABEL_Y, TEMP_LABEL, &LABELS_FONT, FONT_BACKGROUND, WHITE);
+            Paint_DrawString_EN(KML_LABEL_X, KML_LABEL_Y, KML_LABEL, &LABELS_FONT, FONT_BACKGROUND, WHITE);
+            Paint_DrawString_EN(VOLTS_LABEL_X, VOLTS_LABEL_Y, VOLTS_LABEL, &LABELS_FONT, FONT_BACKGROUND, WHITE);
+            Paint_DrawString_EN(FUEL_CONS_LABEL_X, FUEL_CONS_LABEL_Y, FUEL_CONS_LABEL, &LABELS_FONT, FONT_BACKGROUND, WHITE);
+            if (BackgroundImage != NULL)
+            {
+                memcpy(BackgroundImage, BlackImage, Imagesize);
+                backgroundReady = true;
+            }
+        }
+        Paint_SetBackground(BackgroundImage);
+        resetReadouts();
+        flush();
         break;
     default:
         break;
@@ -75,32 +101,110 @@ void DigitalGauge::showLogo()
 {
     clear();
     drawBmpFile(TORINO_LOGO_PATH.c_str());
-    LCD_1IN28_Display(BlackImage);
+    flush();
+}
+
+// Readouts are redrawn in full on the next loop
+void DigitalGauge::resetReadouts()
+{
+    lastKmlValue = -1;
+    lastTempValue = -1;
+    lastVoltsValue = -1;
+    lastFuelConsValue = -1;
+    kmlArea = {};
+    tempArea = {};
+    voltsArea = {};
+    fuelConsArea = {};
 }
 
 void DigitalGauge::clear()
 {
     Paint_NewImage(BlackImage, LCD_1IN28_WIDTH, LCD_1IN28_HEIGHT, 0, BLACK, 16);
     Paint_Clear(BLACK);
-    LCD_1IN28_Display(BlackImage);
+    flush();
+}
+
+// Sends what was drawn since the last flush, nothing at all when nothing was
+void DigitalGauge::flush()
+{
+    const PAINT_DAMAGE *damage = Paint_GetDamage();
+
+    if (damage->Count == 0)
+    {
+        skippedFlushes++;
+    }
+    else if (!partialFlush)
+    {
+        LCD_1IN28_Display(BlackImage);
+        spiBytes += LCD_1IN28_WINDOW_BYTES + Imagesize;
+        windows++;
+    }
+    else
+    {
+        for (UBYTE i = 0; i < damage->Count; i++)
+        {
+            const PAINT_RECT &rect = damage->Rect[i];
+            spiBytes += LCD_1IN28_DisplayWindows(rect.Xstart, rect.Ystart, rect.Xend, rect.Yend, BlackImage);
+        }
+        windows += damage->Count;
+    }
+
+    flushes++;
+    Paint_ClearDamage();
+}
+
+void DigitalGauge::logStats()
+{
+    uint64_t now = System::uptime();
+    double elapsed = (now - lastStatsTime) / 1000000.0;
+
+    if (elapsed > 0)
+    {
+        logger->info("SPI: " + std::to_string((uint64_t)(spiBytes / elapsed)) + " bytes/s, " +
+                     std::to_string(windows) + " windows in " + std::to_string(flushes) + " flushes, " +
+                     std::to_string(skippedFlushes) + " without damage");
+    }
+
+    lastStatsTime = now;
+    spiBytes = 0;
+    flushes = 0;
+    skippedFlushes = 0;
+    windows = 0;
 }
 
 void DigitalGauge::loop()
 {
+    lastStatsTime = System::uptime();
+    spiBytes = 0;
+    flushes = 0;
+    skippedFlushes = 0;
+    windows = 0;
+
     while (!terminateFlag.load())
     {
         switch (currentScreen)
         {
         case DIGITAL_GAUGE:
+        {
+            // Holley values when they are being received, local sensors otherwise
+            double cts, battery;
             drawKml(engineValues->kml);
-            drawTemp(coolantTempSensorData->temp);
-            drawVolts(engineValues->volts);
+            double temp = readFreshEngineSignal(engineSignals, SIGNAL_CTS, cts) ? (cts - 32) * 5 / 9 : coolantTempSensorData->temp;
+            // drawTemp takes 0..255, below freezing (a cold start) shows 0
+            drawTemp(std::isfinite(temp) ? (uint8_t)std::clamp(temp, 0.0, 255.0) : 0);
+            drawVolts(readFreshEngineSignal(engineSignals, SIGNAL_BATTERY, battery) ? battery : engineValues->volts);
             break;
+        }
         default:
             break;
         }
 
-        LCD_1IN28_Display(BlackImage);
+        flush();
+
+        if (statsInterval > 0 && System::uptime() - lastStatsTime >= statsInterval * 1000000)
+        {
+            logStats();
+        }
 
         std::this_thread::sleep_for(std::chrono::microseconds(loopInterval));
     }
@@ -119,7 +223,6 @@ void DigitalGauge::drawTemp(uint8_t temp)
 
     if (temp < 10)
     {
-        Paint_DrawString_EN(TEMP_X, TEMP_Y, "   ", &TEMP_FONT, BLACK, fontColor);
         _tempX = TEMP_X + TEMP_FONT.Width - 2;
     }
     else if (temp < TEMP_DANGER_THRESHOLD)
@@ -128,7 +231,6 @@ void DigitalGauge::drawTemp(uint8_t temp)
         {
             fontColor = YELLOW;
         }
-        Paint_DrawString_EN(TEMP_X, TEMP_Y, "   ", &TEMP_FONT, BLACK, fontColor);
         _tempX = TEMP_X + TEMP_FONT.Width / 2 - 3;
     }
     else
@@ -136,7 +238,7 @@ void DigitalGauge::drawTemp(uint8_t temp)
         fontColor = RED;
     }
 
-    Paint_DrawString_EN(_tempX, TEMP_Y, buffer, &TEMP_FONT, BLACK, fontColor);
+    Paint_DrawString_Layer(_tempX, TEMP_Y, buffer, &TEMP_FONT, fontColor, &tempArea);
     lastTempValue = temp;
 }
 
@@ -147,7 +249,6 @@ void DigitalGauge::drawKml(float kml)
 
     uint16_t fontColor = WHITE;
     uint8_t kmlX = LCD_1IN28_WIDTH / 2 - KML_FONT.Width * 1.7;
-    uint8_t textWidth;
     char buffer[16];
 
     if (kml < KML_DANGER_THRESHOLD)
@@ -164,11 +265,9 @@ void DigitalGauge::drawKml(float kml)
     if (kml < 10)
     {
         kmlX = LCD_1IN28_WIDTH / 2 - KML_FONT.Width * 1.2;
-        textWidth = KML_FONT.Width * 2.4;
-        Paint_DrawRectangle(kmlX, KML_Y, kmlX + textWidth, KML_FONT.Height, BLACK, DOT_PIXEL_2X2, DRAW_FILL_FULL);
     }
 
-    Paint_DrawString_EN(kmlX, KML_Y, buffer, &KML_FONT, BLACK, fontColor);
+    Paint_DrawString_Layer(kmlX, KML_Y, buffer, &KML_FONT, fontColor, &kmlArea);
     lastKmlValue = kml;
 }
 
@@ -202,11 +301,10 @@ void DigitalGauge::drawVolts(float volts)
 
     if (volts < 10)
     {
-        Paint_DrawString_EN(VOLTS_X, VOLTS_Y, "    ", &VOLTS_FONT, BLACK, fontColor);
         _voltsX = VOLTS_X + VOLTS_FONT.Width / 2;
     }
 
-    Paint_DrawString_EN(_voltsX, VOLTS_Y, buffer, &VOLTS_FONT, BLACK, fontColor);
+    Paint_DrawString_Layer(_voltsX, VOLTS_Y, buffer, &VOLTS_FONT, fontColor, &voltsArea);
     lastVoltsValue = volts;
 }
 
@@ -217,7 +315,6 @@ void DigitalGauge::drawFuelConsumption(float fuelConsumption)
 
     uint16_t fontColor = WHITE;
     uint8_t fuelConsX = LCD_1IN28_WIDTH / 2 - FUEL_CONS_FONT.Width * 2.2;
-    uint8_t textWidth;
     char buffer[16];
 
     snprintf(buffer, sizeof(buffer), "%.1f", fuelConsumption);
@@ -225,16 +322,12 @@ void DigitalGauge::drawFuelConsumption(float fuelConsumption)
     if (fuelConsumption < 10)
     {
         fuelConsX = LCD_1IN28_WIDTH / 2 - FUEL_CONS_FONT.Width * 1.2;
-        textWidth = FUEL_CONS_FONT.Width * 2.4;
-        Paint_DrawRectangle(fuelConsX, FUEL_CONS_Y, fuelConsX + textWidth, FUEL_CONS_FONT.Height, BLACK, DOT_PIXEL_2X2, DRAW_FILL_FULL);
     }
     else if (fuelConsumption < 100)
     {
         fuelConsX = LCD_1IN28_WIDTH / 2 - FUEL_CONS_FONT.Width * 1.7;
-        textWidth = FUEL_CONS_FONT.Width * 3.4;
-        Paint_DrawRectangle(fuelConsX, FUEL_CONS_Y, fuelConsX + textWidth, FUEL_CONS_FONT.Height, BLACK, DOT_PIXEL_2X2, DRAW_FILL_FULL);
     }
 
-    Paint_DrawString_EN(fuelConsX, FUEL_CONS_Y, buffer, &FUEL_CONS_FONT, BLACK, fontColor);
+    Paint_DrawString_Layer(fuelConsX, FUEL_CONS_Y, buffer, &FUEL_CONS_FONT, fontColor, &fuelConsArea);
     lastFuelConsValue = fuelConsumption;
 }
\ No newline at end of file
@@ -5,18 +5,24 @@
 #include <iostream>
 #include <string>
 #include <cmath>
+#include <algorithm>
 
 #include "Process.h"
 #include "common.h"
 #include "Logger.h"
+#include "System.h"
 
 extern volatile EngineValues *engineValues;
 extern volatile CoolantTempSensorData *coolantTempSensorData;
+extern volatile EngineSignals *engineSignals;
 
 class DigitalGauge : public Process
 {
 private:
   UWORD *BlackImage;
+  // The artwork and labels, the readouts are drawn over it
+  UWORD *BackgroundImage;
+  bool backgroundReady = false;
   UDOUBLE Imagesize = LCD_1IN28_HEIGHT * LCD_1IN28_WIDTH * 2;
   uint8_t lowerCaseOffset = 97;
   uint8_t upperCaseOffset = 65;
@@ -28,6 +34,15 @@ private:
 
   uint16_t logoTime;
 
+  // Only the areas the Paint layer damaged are sent, unless partial_flush is off
+  bool partialFlush = true;
+  uint64_t statsInterval = 0;
+  uint64_t lastStatsTime = 0;
+  uint64_t spiBytes = 0;
+  uint32_t flushes = 0;
+  uint32_t skippedFlushes = 0;
+  uint32_t windows = 0;
+
   sFONT LABELS_FONT = LiberationSansNarrow_Bold16;
 
   sFONT KML_FONT = LiberationSansNarrow_Bold48;
@@ -39,6 +54,7 @@ private:
   const float KML_DANGER_THRESHOLD = 6;
   const float KML_WARN_THRESHOLD = 8;
   float lastKmlValue = -1;
+  PAINT_RECT kmlArea = {};
 
   sFONT TEMP_FONT = LiberationSansNarrow_Bold36;
   const uint8_t TEMP_X = 30;
@@ -49,6 +65,7 @@ private:
   const uint8_t TEMP_WARN_THRESHOLD = 90;
   const uint8_t TEMP_DANGER_THRESHOLD = 100;
   uint8_t lastTempValue = -1;
+  PAINT_RECT tempArea = {};
 
   sFONT VOLTS_FONT = LiberationSansNarrow_Bold36;
   const uint8_t VOLTS_X = 143;
@@ -60,6 +77,7 @@ private:
   const float VOLTS_DANGER_THRESHOLD_LOW = 12;
   const float VOLTS_DANGER_THRESHOLD_HIGH = 15;
   float lastVoltsValue = -1;
+  PAINT_RECT voltsArea = {};
 
   sFONT FUEL_CONS_FONT = LiberationSansNarrow_Bold36;
   const uint8_t FUEL_CONS_X = 0;
@@ -68,11 +86,15 @@ private:
   const uint8_t FUEL_CONS_LABEL_X = (LCD_1IN28_WIDTH - LABELS_FONT.Width * strlen(FUEL_CONS_LABEL)) / 2;
   const uint8_t FUEL_CONS_LABEL_Y = FUEL_CONS_Y - LABELS_FONT.Height;
   float lastFuelConsValue = -1;
+  PAINT_RECT fuelConsArea = {};
 
   void drawTemp(uint8_t);
   void drawKml(float);
   void drawFuelConsumption(float);
+  void resetReadouts();
   void clear();
+  void flush();
+  void logStats();
 
 public:
   DigitalGauge(/* args */);
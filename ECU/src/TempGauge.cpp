@@ -44,7 +44,12 @@ void TempGauge::loop()
 {
     while (!terminateFlag.load())
     {
-        currentTemp = coolantTempSensorData->temp;
+        // Prefer the Holley coolant temperature (°F) when it is being received
+        double cts;
+        if (readFreshEngineSignal(engineSignals, SIGNAL_CTS, cts))
+            currentTemp = (cts - 32) * 5 / 9;
+        else
+            currentTemp = coolantTempSensorData->temp;
 
         if (!currentTemp || currentTemp < 0)
             currentTemp = 0;
@@ -17,6 +17,7 @@
 #include "STEPPER.h"
 
 extern volatile CoolantTempSensorData *coolantTempSensorData;
+extern volatile EngineSignals *engineSignals;
 class TempGauge : public Process, public Gauge
 {
 private:
@@ -0,0 +1,87 @@
+#include "CANReplay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+static constexpr std::chrono::microseconds CAN_REPLAY_SPIN(200);
+
+CANReplay::CANReplay(CANTraceReader &reader, double speed) : reader(reader), speed(speed > 0 ? speed : 0)
+{
+}
+
+// Each record is released at its slot on the replay clock and the sink is
+// called right away. The reported latency runs from the slot to the sink
+// returning, so scheduling delays and decode time both count.
+CANReplayStats CANReplay::run(const std::function<void(const CANTraceRecord &)> &sink, const std::atomic<bool> *stop)
+{
+    using Clock = std::chrono::steady_clock;
+
+    CANReplayStats stats = {};
+    std::vector<uint32_t> latencies;
+    latencies.reserve(reader.recordCount());
+
+    CANTraceRecord record;
+    uint64_t firstTimestamp = 0;
+    uint64_t latencySum = 0;
+    Clock::duration busy = Clock::duration::zero();
+    Clock::time_point start = Clock::now();
+
+    reader.rewind();
+    while ((!stop || !stop->load()) && reader.next(record))
+    {
+        Clock::time_point release = Clock::now();
+
+        if (speed > 0)
+        {
+            if (stats.frames == 0)
+            {
+                firstTimestamp = record.timestamp;
+            }
+
+            uint64_t offset = record.timestamp > firstTimestamp ? record.timestamp - firstTimestamp : 0;
+            release = start + std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds((uint64_t)(offset / speed)));
+
+            // Sleep overshoots by tens of microseconds, so spin out the last stretch
+            if (release - Clock::now() > CAN_REPLAY_SPIN)
+            {
+                std::this_thread::sleep_until(release - CAN_REPLAY_SPIN);
+            }
+            while (Clock::now() < release)
+            {
+            }
+        }
+
+        Clock::time_point begin = Clock::now();
+        sink(record);
+        Clock::time_point done = Clock::now();
+
+        uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(done - release).count();
+        latencies.push_back(latency > UINT32_MAX ? UINT32_MAX : latency);
+        latencySum += latency;
+        stats.latencyMax = std::max(stats.latencyMax, latency);
+        if (speed > 0 && begin - release > std::chrono::milliseconds(1))
+        {
+            stats.lateFrames++;
+        }
+
+        busy += done - begin;
+        stats.frames++;
+    }
+
+    stats.elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    double busySeconds = std::chrono::duration<double>(busy).count();
+
+    if (stats.frames > 0)
+    {
+        stats.framesPerSecond = stats.elapsed > 0 ? stats.frames / stats.elapsed : 0;
+        stats.decodePerSecond = busySeconds > 0 ? stats.frames / busySeconds : 0;
+        stats.latencyAvg = (double)latencySum / stats.frames;
+
+        size_t p99 = (latencies.size() - 1) * 99 / 100;
+        std::nth_element(latencies.begin(), latencies.begin() + p99, latencies.end());
+        stats.latencyP99 = latencies[p99];
+    }
+
+    return stats;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cstdint>
+
+#include "CANTrace.h"
+
+struct CANReplayStats
+{
+    uint64_t frames;
+    double elapsed;             // Wall time of the whole replay (s)
+    double framesPerSecond;     // Delivered frames per wall second
+    double decodePerSecond;     // Frames per second of time spent in the sink
+    double latencyAvg;          // Scheduled release -> sink done (us)
+    uint64_t latencyP99;
+    uint64_t latencyMax;
+    uint64_t lateFrames;        // Released more than 1 ms after their slot
+};
+
+// Feeds the records of a trace to a sink, either at the recorded timing scaled
+// by speed (1 = original, 2 = twice as fast) or back to back when speed is 0.
+class CANReplay
+{
+private:
+    CANTraceReader &reader;
+    double speed;
+
+public:
+    CANReplay(CANTraceReader &, double);
+
+    CANReplayStats run(const std::function<void(const CANTraceRecord &)> &, const std::atomic<bool> * = nullptr);
+};
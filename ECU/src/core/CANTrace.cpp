@@ -0,0 +1,412 @@
+#include "CANTrace.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static std::string segmentPath(const std::string &directory, uint32_t index)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "trace-%06u.bin", index);
+    return directory + "/" + name;
+}
+
+// Segment files of a trace directory in write order
+std::vector<std::string> CANTraceReader::listSegments(const std::string &directory)
+{
+    std::vector<std::string> segments;
+    std::error_code error;
+
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        std::string name = entry.path().filename().string();
+        if (entry.is_regular_file() && name.starts_with("trace-") && name.ends_with(".bin"))
+        {
+            segments.push_back(entry.path().string());
+        }
+    }
+
+    // Zero padded indexes sort lexicographically
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+CANTraceWriter::CANTraceWriter()
+{
+}
+
+CANTraceWriter::~CANTraceWriter()
+{
+    close();
+}
+
+// Starts a new segment after the ones already in the directory, existing
+// recordings are never overwritten.
+bool CANTraceWriter::open(const std::string &path, uint32_t framesPerSegment)
+{
+    close();
+
+    std::error_code error;
+    std::filesystem::create_directories(path, error);
+    if (error)
+    {
+        std::cerr << "Error: Could not create trace directory " << path << ": " << error.message() << std::endl;
+        return false;
+    }
+
+    directory = path;
+    segmentFrames = framesPerSegment > 0 ? framesPerSegment : CAN_TRACE_SEGMENT_FRAMES;
+    segmentIndex = 0;
+    written = 0;
+
+    std::vector<std::string> existing = CANTraceReader::listSegments(directory);
+    if (!existing.empty())
+    {
+        unsigned int last = 0;
+        if (sscanf(std::filesystem::path(existing.back()).filename().c_str(), "trace-%u.bin", &last) == 1)
+        {
+            segmentIndex = last + 1;
+        }
+    }
+
+    return openSegment();
+}
+
+bool CANTraceWriter::openSegment()
+{
+    std::string path = segmentPath(directory, segmentIndex);
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not create trace segment " << path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Size the file up front so appends are plain stores into the mapping
+    mappedSize = sizeof(CANTraceSegmentHeader) + (size_t)segmentFrames * sizeof(CANTraceRecord);
+    if (ftruncate(fd, mappedSize) < 0)
+    {
+        std::cerr << "Error: Could not size trace segment " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    void *base = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map trace segment " << path << ": " << strerror(errno) << std::endl;
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    header = static_cast<CANTraceSegmentHeader *>(base);
+    records = reinterpret_cast<CANTraceRecord *>(header + 1);
+    memset(header, 0, sizeof(CANTraceSegmentHeader));
+    header->magic = CAN_TRACE_MAGIC;
+    header->version = CAN_TRACE_VERSION;
+    header->recordSize = sizeof(CANTraceRecord);
+    header->capacity = segmentFrames;
+    return true;
+}
+
+// Trims the unused tail so closed segments only hold written records
+void CANTraceWriter::closeSegment()
+{
+    if (!header)
+    {
+        return;
+    }
+
+    size_t used = sizeof(CANTraceSegmentHeader) + (size_t)header->count * sizeof(CANTraceRecord);
+    munmap(header, mappedSize);
+    if (ftruncate(fd, used) < 0)
+    {
+        std::cerr << "Error: Could not trim trace segment: " << strerror(errno) << std::endl;
+    }
+    ::close(fd);
+
+    fd = -1;
+    header = nullptr;
+    records = nullptr;
+    mappedSize = 0;
+}
+
+bool CANTraceWriter::append(const struct can_frame &frame, uint64_t timestamp)
+{
+    CANTraceRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = timestamp;
+    record.canID = frame.can_id;
+    record.dlc = frame.can_dlc > 8 ? 8 : frame.can_dlc;
+    memcpy(record.data, frame.data, record.dlc);
+    return append(record);
+}
+
+bool CANTraceWriter::append(const CANTraceRecord &record)
+{
+    if (!header)
+    {
+        return false;
+    }
+
+    if (header->count == header->capacity)
+    {
+        closeSegment();
+        segmentIndex++;
+        if (!openSegment())
+        {
+            return false;
+        }
+    }
+
+    uint32_t count = header->count;
+    records[count] = record;
+
+    // Publish the record only once it is complete, a reader of a live
+    // segment (or one left behind by a crash) never sees a torn record
+    __atomic_store_n(&header->count, count + 1, __ATOMIC_RELEASE);
+    written++;
+    return true;
+}
+
+void CANTraceWriter::close()
+{
+    closeSegment();
+}
+
+// Appends every classic CAN frame of a candump log ("(sec.usec) iface ID#DATA",
+// as written by candump -l). Returns the number of imported frames.
+size_t CANTraceWriter::importCandump(std::istream &input)
+{
+    std::string line;
+    size_t imported = 0;
+
+    while (std::getline(input, line))
+    {
+        unsigned long long seconds = 0, micros = 0;
+        char interface[32];
+        char frameText[128];
+
+        if (sscanf(line.c_str(), " (%llu.%llu) %31s %127s", &seconds, &micros, interface, frameText) != 4)
+        {
+            continue;
+        }
+
+        std::string text(frameText);
+        size_t separator = text.find('#');
+        if (separator == std::string::npos || text.compare(separator, 2, "##") == 0)
+        {
+            continue; // Not a frame or CAN FD
+        }
+
+        CANTraceRecord record;
+        memset(&record, 0, sizeof(record));
+        record.timestamp = seconds * 1000000000ULL + micros * 1000ULL;
+        record.canID = strtoul(text.substr(0, separator).c_str(), nullptr, 16);
+
+        // candump prints 3 digits for standard IDs and 8 for extended or error frames
+        if (separator == 8 && !(record.canID & CAN_ERR_FLAG))
+        {
+            record.canID |= CAN_EFF_FLAG;
+        }
+
+        std::string payload = text.substr(separator + 1);
+        if (!payload.empty() && payload[0] == 'R')
+        {
+            record.canID |= CAN_RTR_FLAG;
+            record.dlc = payload.size() > 1 ? std::min(8, atoi(payload.c_str() + 1)) : 0;
+        }
+        else
+        {
+            for (size_t i = 0; i + 1 < payload.size() && record.dlc < 8; i += 2)
+            {
+                record.data[record.dlc++] = strtoul(payload.substr(i, 2).c_str(), nullptr, 16);
+            }
+        }
+
+        if (!append(record))
+        {
+            break;
+        }
+        imported++;
+    }
+
+    return imported;
+}
+
+CANTraceReader::CANTraceReader()
+{
+}
+
+CANTraceReader::~CANTraceReader()
+{
+    close();
+}
+
+bool CANTraceReader::open(const std::string &directory)
+{
+    close();
+
+    segments = listSegments(directory);
+    if (segments.empty())
+    {
+        std::cerr << "Error: No trace segments in " << directory << std::endl;
+        return false;
+    }
+
+    total = 0;
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (!mapSegment(i))
+        {
+            close();
+            return false;
+        }
+        total += header->count;
+    }
+
+    rewind();
+    return true;
+}
+
+bool CANTraceReader::mapSegment(size_t index)
+{
+    unmapSegment();
+
+    int fd = ::open(segments[index].c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Error: Could not open trace segment " << segments[index] << std::endl;
+        return false;
+    }
+
+    size_t size = lseek(fd, 0, SEEK_END);
+    if (size < sizeof(CANTraceSegmentHeader))
+    {
+        std::cerr << "Error: Truncated trace segment " << segments[index] << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (base == MAP_FAILED)
+    {
+        std::cerr << "Error: Could not map trace segment " << segments[index] << std::endl;
+        return false;
+    }
+
+    const CANTraceSegmentHeader *mapped = static_cast<const CANTraceSegmentHeader *>(base);
+    if (mapped->magic != CAN_TRACE_MAGIC || mapped->version != CAN_TRACE_VERSION ||
+        mapped->recordSize != sizeof(CANTraceRecord) ||
+        sizeof(CANTraceSegmentHeader) + (size_t)mapped->count * sizeof(CANTraceRecord) > size)
+    {
+        std::cerr << "Error: Invalid trace segment " << segments[index] << std::endl;
+        munmap(base, size);
+        return false;
+    }
+
+    // Records are read sequentially exactly once
+    madvise(base, size, MADV_SEQUENTIAL);
+
+    header = mapped;
+    records = reinterpret_cast<const CANTraceRecord *>(header + 1);
+    mappedSize = size;
+    segmentIndex = index;
+    position = 0;
+    return true;
+}
+
+void CANTraceReader::unmapSegment()
+{
+    if (header)
+    {
+        munmap(const_cast<CANTraceSegmentHeader *>(header), mappedSize);
+    }
+    header = nullptr;
+    records = nullptr;
+    mappedSize = 0;
+}
+
+bool CANTraceReader::next(CANTraceRecord &record)
+{
+    while (header)
+    {
+        if (position < __atomic_load_n(&header->count, __ATOMIC_ACQUIRE))
+        {
+            record = records[position++];
+            return true;
+        }
+
+        if (segmentIndex + 1 >= segments.size() || !mapSegment(segmentIndex + 1))
+        {
+            return false;
+        }
+    }
+    return false;
+}
+
+void CANTraceReader::rewind()
+{
+    if (!segments.empty())
+    {
+        mapSegment(0);
+    }
+}
+
+void CANTraceReader::close()
+{
+    unmapSegment();
+    segments.clear();
+    segmentIndex = 0;
+    position = 0;
+    total = 0;
+}
+
+// Writes the remaining records in candump -l format. Returns the number of frames written.
+size_t CANTraceReader::exportCandump(std::ostream &output, const std::string &interface)
+{
+    CANTraceRecord record;
+    size_t exported = 0;
+    char line[96];
+
+    while (next(record))
+    {
+        int length = snprintf(line, sizeof(line), "(%llu.%06llu) %s ",
+                              (unsigned long long)(record.timestamp / 1000000000ULL),
+                              (unsigned long long)(record.timestamp % 1000000000ULL / 1000), interface.c_str());
+
+        if (record.canID & (CAN_EFF_FLAG | CAN_ERR_FLAG))
+        {
+            length += snprintf(line + length, sizeof(line) - length, "%08X#", record.canID & (CAN_EFF_MASK | CAN_ERR_FLAG));
+        }
+        else
+        {
+            length += snprintf(line + length, sizeof(line) - length, "%03X#", record.canID & CAN_SFF_MASK);
+        }
+
+        if (record.canID & CAN_RTR_FLAG)
+        {
+            length += snprintf(line + length, sizeof(line) - length, "R");
+        }
+        else
+        {
+            for (uint8_t i = 0; i < record.dlc && i < 8; i++)
+            {
+                length += snprintf(line + length, sizeof(line) - length, "%02X", record.data[i]);
+            }
+        }
+
+        output << line << '\n';
+        exported++;
+    }
+
+    return exported;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <linux/can.h>
+
+// Binary CAN trace: a directory of append-only, memory mapped segment files
+// (trace-000000.bin, trace-000001.bin, ...), each a header followed by
+// fixed-size records in reception order.
+
+#define CAN_TRACE_MAGIC 0x45435254 // "TRCE"
+#define CAN_TRACE_VERSION 1
+#define CAN_TRACE_SEGMENT_FRAMES 65536
+
+struct CANTraceSegmentHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t capacity; // Records the segment was sized for
+    uint32_t count;    // Records written, published after each record
+    uint64_t reserved[2];
+};
+
+struct CANTraceRecord
+{
+    uint64_t timestamp; // Receive time in ns (CLOCK_REALTIME, as reported by the socket)
+    uint32_t canID;     // SocketCAN ID including the EFF/RTR/ERR flags
+    uint8_t dlc;
+    uint8_t reserved[3];
+    uint8_t data[8];
+};
+
+static_assert(sizeof(CANTraceSegmentHeader) == 32, "Unexpected trace header size");
+static_assert(sizeof(CANTraceRecord) == 24, "Unexpected trace record size");
+
+class CANTraceWriter
+{
+private:
+    std::string directory;
+    uint32_t segmentFrames = CAN_TRACE_SEGMENT_FRAMES;
+    uint32_t segmentIndex = 0;
+    int fd = -1;
+    size_t mappedSize = 0;
+    CANTraceSegmentHeader *header = nullptr;
+    CANTraceRecord *records = nullptr;
+    uint64_t written = 0;
+
+    bool openSegment();
+    void closeSegment();
+
+public:
+    CANTraceWriter();
+    ~CANTraceWriter();
+
+    bool open(const std::string &, uint32_t = CAN_TRACE_SEGMENT_FRAMES);
+    bool append(const struct can_frame &, uint64_t);
+    bool append(const CANTraceRecord &);
+    void close();
+    bool isOpen() const { return header != nullptr; }
+    uint64_t recordCount() const { return written; }
+
+    size_t importCandump(std::istream &);
+};
+
+class CANTraceReader
+{
+private:
+    std::vector<std::string> segments;
+    size_t segmentIndex = 0;
+    size_t mappedSize = 0;
+    const CANTraceSegmentHeader *header = nullptr;
+    const CANTraceRecord *records = nullptr;
+    uint32_t position = 0;
+    uint64_t total = 0;
+
+    bool mapSegment(size_t);
+    void unmapSegment();
+
+public:
+    CANTraceReader();
+    ~CANTraceReader();
+
+    bool open(const std::string &);
+    bool next(CANTraceRecord &);
+    void rewind();
+    void close();
+    uint64_t recordCount() const { return total; }
+
+    size_t exportCandump(std::ostream &, const std::string & = "can0");
+
+    static std::vector<std::string> listSegments(const std::string &);
+};
@@ -1,5 +1,12 @@
 #include "DBCParser.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Largest signal count of a single message, used for stack decode buffers.
+#define DBC_MAX_SIGNALS_PER_MESSAGE 16
+
 DBCParser::DBCParser()
 {
 }
@@ -8,68 +15,226 @@ DBCParser::~DBCParser()
 {
 }
 
-bool DBCParser::loadDBC(const std::string &filename)
+// Builds the decode tables from the descriptors generated at build time from the
+// DBC file.
+bool DBCParser::loadGenerated(const HolleyDBC::MessageDescriptor *descriptors, size_t count)
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
+    messages.clear();
+    signals.clear();
+    names.clear();
+
+    for (size_t i = 0; i < count; i++)
     {
-        std::cerr << "Error: Could not open " << filename << std::endl;
-        return false;
+        const HolleyDBC::MessageDescriptor &descriptor = descriptors[i];
+
+        if (descriptor.signal_count > DBC_MAX_SIGNALS_PER_MESSAGE)
+        {
+            std::cerr << "Error: Too many signals in message " << descriptor.name << std::endl;
+            return false;
+        }
+
+        DBCMessage message;
+        message.id = descriptor.id;
+        message.extended = descriptor.extended;
+        message.firstSignal = signals.size();
+        message.signalCount = descriptor.signal_count;
+        message.nameIndex = names.size();
+        names.push_back(descriptor.name);
+
+        for (uint8_t j = 0; j < descriptor.signal_count; j++)
+        {
+            const HolleyDBC::SignalDescriptor &generated = descriptor.signals[j];
+            DBCSignal signal;
+
+            signal.factor = generated.factor;
+            signal.offset = generated.offset;
+            signal.length = generated.length;
+            signal.shift = generated.shift;
+            signal.bigEndian = generated.big_endian;
+            signal.isFloat = generated.is_float;
+            signal.isSigned = generated.is_signed;
+            signal.mask = signal.length >= 64 ? ~0ULL : ((1ULL << signal.length) - 1);
+            signal.nameIndex = names.size();
+            names.push_back(generated.name);
+            signals.push_back(signal);
+        }
+
+        messages.push_back(message);
     }
-    file >> dbcData;
-    file.close();
 
-    // Populate CAN ID to message mapping
-    for (const auto &msg : dbcData["messages"])
+    sortMessages();
+    return true;
+}
+
+void DBCParser::sortMessages()
+{
+    uint32_t keyMask = ~ignoredBits;
+    std::sort(messages.begin(), messages.end(), [keyMask](const DBCMessage &a, const DBCMessage &b)
+              { return (a.id & keyMask) < (b.id & keyMask); });
+}
+
+// Makes lookups ignore the given ID bits, e.g. the Holley source ID/serial so
+// frames from any unit resolve to the same message. Message indexes may change.
+void DBCParser::setIgnoredIDBits(uint32_t bits)
+{
+    ignoredBits = bits & CAN_EFF_MASK;
+    sortMessages();
+}
+
+const DBCMessage *DBCParser::findMessage(uint32_t canID) const
+{
+    uint32_t keyMask = ~ignoredBits;
+    canID &= CAN_EFF_MASK & keyMask;
+    auto it = std::lower_bound(messages.begin(), messages.end(), canID, [keyMask](const DBCMessage &message, uint32_t id)
+                               { return (message.id & keyMask) < id; });
+
+    if (it == messages.end() || (it->id & keyMask) != canID)
     {
-        uint32_t canID = msg["id"];
-        std::string name = msg["name"];
-        messageMap[canID] = name;
+        return nullptr;
     }
+    return &(*it);
+}
 
-    return true;
+const DBCMessage *DBCParser::findMessageByName(const std::string &name) const
+{
+    for (const DBCMessage &message : messages)
+    {
+        if (names[message.nameIndex] == name)
+        {
+            return &message;
+        }
+    }
+    return nullptr;
 }
 
 std::string DBCParser::getMessageName(uint32_t canID)
 {
-    if (messageMap.find(canID) != messageMap.end())
+    const DBCMessage *message = findMessage(canID);
+    if (message)
     {
-        return messageMap[canID];
+        return names[message->nameIndex];
     }
     return "Unknown Message";
 }
 
-void DBCParser::parseCANData(uint32_t canID, uint8_t *data, uint8_t len)
+const std::string &DBCParser::getSignalName(const DBCSignal &signal) const
 {
-    if (messageMap.find(canID) == messageMap.end())
+    return names[signal.nameIndex];
+}
+
+// Decodes every signal of a frame into the caller's buffer without allocating.
+// Returns the number of decoded signals (0 for unknown IDs).
+size_t DBCParser::decode(uint32_t canID, const uint8_t *data, uint8_t len, DecodedSignal *out, size_t maxOut) const
+{
+    const DBCMessage *message = findMessage(canID);
+    if (!message)
     {
-        std::cout << "Unknown CAN ID: " << std::hex << canID << std::dec << std::endl;
-        return;
+        return 0;
+    }
+
+    uint8_t payload[8] = {0};
+    memcpy(payload, data, len > 8 ? 8 : len);
+
+    uint64_t bigEndianWord = 0;
+    uint64_t littleEndianWord = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        bigEndianWord = (bigEndianWord << 8) | payload[i];
+        littleEndianWord |= (uint64_t)payload[i] << (i * 8);
     }
 
-    std::cout << "Parsing Message: " << messageMap[canID] << std::endl;
+    size_t count = std::min<size_t>(message->signalCount, maxOut);
+    const DBCSignal *signal = &signals[message->firstSignal];
 
-    for (const auto &msg : dbcData["messages"])
+    for (size_t i = 0; i < count; i++, signal++)
     {
-        if (msg["id"] == canID)
+        uint64_t raw = ((signal->bigEndian ? bigEndianWord : littleEndianWord) >> signal->shift) & signal->mask;
+        double value;
+
+        if (signal->isFloat)
         {
-            for (const auto &signal : msg["signals"])
+            if (signal->length == 32)
+            {
+                uint32_t bits = (uint32_t)raw;
+                float f;
+                memcpy(&f, &bits, sizeof(f));
+                value = f;
+            }
+            else
             {
-                std::string name = signal["name"];
-                // int startBit = signal["start_bit"];
-                int length = signal["bit_length"];
-                float factor = signal["factor"];
-                float offset = signal["offset"];
-
-                uint32_t rawValue = 0;
-                for (int i = 0; i < length / 8; i++)
-                {
-                    rawValue |= (data[i] << (i * 8));
-                }
-
-                float value = (rawValue * factor) + offset;
-                std::cout << name << ": " << value << std::endl;
+                double d;
+                memcpy(&d, &raw, sizeof(d));
+                value = d;
             }
         }
+        else if (signal->isSigned && signal->length < 64 && (raw >> (signal->length - 1)) & 1)
+        {
+            value = (double)(int64_t)(raw | ~signal->mask);
+        }
+        else if (signal->isSigned)
+        {
+            value = (double)(int64_t)raw;
+        }
+        else
+        {
+            value = (double)raw;
+        }
+
+        out[i].signal = signal;
+        out[i].value = value * signal->factor + signal->offset;
+    }
+
+    return count;
+}
+
+void DBCParser::parseCANData(uint32_t canID, uint8_t *data, uint8_t len, uint64_t timestamp)
+{
+    DecodedSignal decoded[DBC_MAX_SIGNALS_PER_MESSAGE];
+    size_t count = decode(canID, data, len, decoded, DBC_MAX_SIGNALS_PER_MESSAGE);
+
+    if (count == 0)
+    {
+        std::cout << "Unknown CAN ID: " << std::hex << canID << std::dec << std::endl;
+        return;
+    }
+
+    std::cout << "Parsing Message: " << getMessageName(canID);
+    if (timestamp)
+    {
+        std::cout << " @ " << timestamp / 1000 << " us";
+    }
+    std::cout << std::endl;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        std::cout << getSignalName(*decoded[i].signal) << ": " << decoded[i].value << std::endl;
+    }
+}
+
+// Decodes synthetic frames for every loaded message and returns frames per second.
+double DBCParser::benchmark(uint64_t frames)
+{
+    if (messages.empty() || frames == 0)
+    {
+        return 0;
+    }
+
+    DecodedSignal decoded[DBC_MAX_SIGNALS_PER_MESSAGE];
+    uint8_t data[8] = {0x45, 0xBB, 0x80, 0x00, 0x00, 0x00, 0x00, 0x01}; // 6000.0f RPM, status 1
+    volatile double sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < frames; i++)
+    {
+        const DBCMessage &message = messages[i % messages.size()];
+        data[7] = (uint8_t)i;
+        size_t count = decode(message.id, data, sizeof(data), decoded, DBC_MAX_SIGNALS_PER_MESSAGE);
+        if (count)
+        {
+            sink = sink + decoded[0].value;
+        }
     }
-}
\ No newline at end of file
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return elapsed > 0 ? frames / elapsed : 0;
+}
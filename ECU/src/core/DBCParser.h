@@ -1,23 +1,67 @@
 #pragma once
 
 #include <iostream>
-#include <fstream>
-#include <nlohmann/json.hpp>
-#include <unordered_map>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <linux/can.h>
 
-using json = nlohmann::json;
+#include "HolleySniperDBC.h"
+
+// Hot-path signal descriptor compiled once from the generated DBC tables. Kept
+// small and contiguous so a frame decode only touches a couple of cache lines.
+struct DBCSignal
+{
+    float factor;
+    float offset;
+    uint64_t mask;   // Raw value mask (bit_length ones)
+    uint8_t shift;   // Right shift applied to the 64-bit payload word
+    uint8_t length;  // bit_length
+    bool bigEndian;  // Motorola byte order
+    bool isFloat;    // IEEE754 payload (32 or 64 bits)
+    bool isSigned;   // Two's complement integer
+    uint16_t nameIndex;
+};
+
+struct DBCMessage
+{
+    uint32_t id;
+    uint16_t firstSignal;
+    uint16_t signalCount;
+    uint16_t nameIndex;
+    bool extended;   // 29-bit identifier
+};
+
+struct DecodedSignal
+{
+    const DBCSignal *signal;
+    double value;
+};
 
 class DBCParser
 {
 private:
-    json dbcData;
-    std::unordered_map<uint32_t, std::string> messageMap;
+    // Sorted by CAN ID, looked up with a binary search.
+    std::vector<DBCMessage> messages;
+    std::vector<DBCSignal> signals;
+    std::vector<std::string> names;
+    // ID bits left out of lookups (sender fields that vary between units)
+    uint32_t ignoredBits = 0;
+
+    void sortMessages();
 
 public:
     DBCParser();
     ~DBCParser();
 
-    bool loadDBC(const std::string &);
+    bool loadGenerated(const HolleyDBC::MessageDescriptor *, size_t);
+    void setIgnoredIDBits(uint32_t);
+    const DBCMessage *findMessage(uint32_t) const;
+    const DBCMessage *findMessageByName(const std::string &) const;
+    const std::vector<DBCMessage> &getMessages() const { return messages; }
     std::string getMessageName(uint32_t);
-    void parseCANData(uint32_t, uint8_t *, uint8_t);
+    const std::string &getSignalName(const DBCSignal &) const;
+    size_t decode(uint32_t, const uint8_t *, uint8_t, DecodedSignal *, size_t) const;
+    void parseCANData(uint32_t, uint8_t *, uint8_t, uint64_t timestamp = 0);
+    double benchmark(uint64_t);
 };
@@ -37,6 +37,7 @@ private:
         {"GPS", {{"loop_interval", "1000000"}, {"baud_rate", "9600"}}},
         {"SpeedSensor", {{"loop_interval", "10"}, {"differential_pinion", "13"}, {"differential_crown", "43"}, {"tire_width", "215"}, {"aspect_ratio", "60"}, {"rim_diameter", "15"}, {"transitions_per_lap", "4"}}},
         {"Speedometer", {{"loop_interval", "1000"}, {"step_offset", "0"}}},
+        {"MCP2515", {{"loop_interval", "1000"}, {"benchmark_enabled", "false"}, {"benchmark_frames", "1000000"}, {"interface", "can0"}, {"receive_buffer_size", "0"}, {"stats_interval", "60"}, {"bitrate", "500000"}, {"subscribed_messages", "all"}, {"filter_merge", "true"}, {"log_frames", "false"}, {"source_serial", "any"}, {"record_trace", "false"}, {"trace_directory", "/var/torino-ecu/traces"}, {"trace_segment_frames", "65536"}, {"replay_trace", "none"}, {"replay_speed", "1"}}},
     };
     std::string dataPath;
     std::string totalMileageFileName;
@@ -7,8 +7,8 @@
 
 #define ASSETS_PATH "./src/assets"
 #define IMAGES_PATH ASSETS_PATH "/images"
+#define ASSET_BUNDLE_FILE ASSETS_PATH "/assets.bundle"
 #define HOLLEY_SNIPER_PATH ASSETS_PATH "/HolleySniper"
-#define HOLLEY_SNIPER_DBC_FILE HOLLEY_SNIPER_PATH "/Sniper_V2.json"
 
 #ifndef CHILD_PROCESS_H_
 #define CHILD_PROCESS_H_
@@ -29,6 +29,81 @@ typedef struct alignas(64) _engineValues
 } EngineValues;
 #endif
 
+#ifndef ENGINE_SIGNALS_H_
+#define ENGINE_SIGNALS_H_
+// Decoded Holley Sniper signals, in the units the ECU sends them
+enum EngineSignalId
+{
+    SIGNAL_RPM,             // RPM
+    SIGNAL_CTS,             // Coolant temperature (°F)
+    SIGNAL_FUEL_FLOW,       // Fuel flow (lb/h)
+    SIGNAL_MAP,             // Manifold pressure (kPa)
+    SIGNAL_TPS,             // Throttle position (%)
+    SIGNAL_AFR,             // Air/fuel ratio
+    SIGNAL_TARGET_AFR,      // Target air/fuel ratio
+    SIGNAL_IGNITION_TIMING, // Ignition timing (°)
+    SIGNAL_BATTERY,         // Battery voltage (V)
+    SIGNAL_MAT,             // Manifold air temperature (°F)
+    ENGINE_SIGNAL_COUNT
+};
+
+// Signals older than this (microseconds) are treated as missing
+#define ENGINE_SIGNAL_TIMEOUT 2000000
+
+typedef struct _engineSignal
+{
+    double value;
+    uint64_t timestamp; // System::uptime() when the frame was received
+    bool valid;
+} EngineSignal;
+
+// Written by the MCP2515 process only. sequence is odd while an update is in
+// progress; readers use readEngineSignal() and never block the writer.
+typedef struct alignas(64) _engineSignals
+{
+    uint32_t sequence;
+    uint64_t framesDecoded;
+    EngineSignal signals[ENGINE_SIGNAL_COUNT];
+} EngineSignals;
+#endif
+
+#ifndef CAN_STATS_H_
+#define CAN_STATS_H_
+#define CAN_STATS_MAX_MESSAGES 128
+// Inter-arrival jitter buckets, upper bounds in microseconds (last one open ended)
+#define CAN_JITTER_BUCKETS 8
+#define CAN_JITTER_BOUNDS {50, 100, 250, 500, 1000, 5000, 10000, UINT32_MAX}
+
+typedef struct _canMessageStats
+{
+    uint32_t id;
+    uint64_t frames;
+    double rate;                         // Frames per second over the last stats period
+    uint64_t lastSeen;                   // System::uptime() of the last frame, 0 if never seen
+    uint32_t meanInterval;               // Average inter-arrival time (us)
+    uint64_t jitter[CAN_JITTER_BUCKETS]; // |interval - meanInterval| histogram
+} CANMessageStats;
+
+// Written by the MCP2515 process once per second, guarded by a seqlock
+typedef struct alignas(64) _canStats
+{
+    uint32_t sequence;
+    uint64_t updated;           // System::uptime() of the last update
+    double busLoad;             // % of the bitrate used by received frames (no stuff bits)
+    uint64_t framesReceived;
+    uint64_t framesDropped;     // Socket queue overflows (SO_RXQ_OVFL)
+    uint64_t rxOverflows;       // Controller RX buffer overflows (EFLG RXnOVR error frames)
+    uint64_t errorFrames;
+    uint64_t unknownFrames;
+    double receiveToDecodeAvg;  // Kernel timestamp to user space decode (us), last period
+    double receiveToDecodeMax;
+    double decodeToPublishAvg;  // Decode to EngineSignals publish (us), last period
+    double decodeToPublishMax;
+    uint32_t messageCount;
+    CANMessageStats messages[CAN_STATS_MAX_MESSAGES];
+} CANStats;
+#endif
+
 #ifndef SPEED_SENSOR_DATA_H_
 #define SPEED_SENSOR_DATA_H_
 typedef struct alignas(64) _speedSensorData
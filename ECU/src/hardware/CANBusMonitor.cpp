@@ -0,0 +1,161 @@
+#include "CANBusMonitor.h"
+
+CANBusMonitor::CANBusMonitor(volatile CANStats *stats, uint32_t bitrate)
+    : stats(stats), bitrate(bitrate)
+{
+}
+
+void CANBusMonitor::begin(const std::vector<DBCMessage> &messages)
+{
+    size_t count = std::min<size_t>(messages.size(), CAN_STATS_MAX_MESSAGES);
+
+    lastArrival.assign(count, 0);
+    periodFrames.assign(count, 0);
+    periodStart = System::uptime();
+
+    seqlockWriteBegin(&stats->sequence);
+    stats->messageCount = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        stats->messages[i].id = messages[i].id;
+    }
+    seqlockWriteEnd(&stats->sequence);
+}
+
+// Kernel receive timestamps are CLOCK_REALTIME, so latencies are measured on it too
+uint64_t CANBusMonitor::now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+// Nominal frame length on the wire, stuff bits not included
+uint32_t CANBusMonitor::frameBits(const struct can_frame &frame)
+{
+    uint8_t length = frame.can_dlc > 8 ? 8 : frame.can_dlc;
+    return ((frame.can_id & CAN_EFF_FLAG) ? 67 : 47) + ((frame.can_id & CAN_RTR_FLAG) ? 0 : 8 * length);
+}
+
+// Per message counters are updated while frames are processed, inside one
+// seqlock write section per receive batch
+void CANBusMonitor::beginBatch()
+{
+    seqlockWriteBegin(&stats->sequence);
+}
+
+// Called for every frame of a known message. timestamp is the kernel receive
+// time (0 when unavailable) and decodeTime the time the batch was picked up.
+void CANBusMonitor::frameReceived(size_t index, const struct can_frame &frame, uint64_t timestamp, uint64_t decodeTime)
+{
+    static const uint32_t bounds[CAN_JITTER_BUCKETS] = CAN_JITTER_BOUNDS;
+
+    periodBits += frameBits(frame);
+
+    uint64_t arrival = timestamp ? timestamp : decodeTime;
+    if (timestamp && decodeTime > timestamp)
+    {
+        uint64_t latency = (decodeTime - timestamp) / 1000;
+        receiveToDecodeSum += latency;
+        receiveToDecodeMax = std::max(receiveToDecodeMax, latency);
+        receiveToDecodeSamples++;
+    }
+
+    if (index >= lastArrival.size())
+    {
+        return;
+    }
+
+    volatile CANMessageStats &message = stats->messages[index];
+    message.frames = message.frames + 1;
+    message.lastSeen = System::uptime();
+    periodFrames[index]++;
+
+    if (lastArrival[index] && arrival > lastArrival[index])
+    {
+        uint32_t interval = (arrival - lastArrival[index]) / 1000;
+        uint32_t mean = message.meanInterval;
+
+        // Exponential average over ~8 intervals, seeded with the first one
+        mean = mean ? mean + ((int64_t)interval - (int64_t)mean) / 8 : interval;
+        message.meanInterval = mean;
+
+        uint32_t jitter = interval > mean ? interval - mean : mean - interval;
+        size_t bucket = 0;
+        while (bucket < CAN_JITTER_BUCKETS - 1 && jitter >= bounds[bucket])
+        {
+            bucket++;
+        }
+        message.jitter[bucket] = message.jitter[bucket] + 1;
+    }
+    lastArrival[index] = arrival;
+}
+
+void CANBusMonitor::unknownFrame(const struct can_frame &frame)
+{
+    periodBits += frameBits(frame);
+    unknownFrames++;
+}
+
+void CANBusMonitor::errorFrame(const struct can_frame &frame)
+{
+    errorFrames++;
+
+    // The mcp251x driver reports EFLG RX0OVR/RX1OVR as controller RX overflows
+    if ((frame.can_id & CAN_ERR_CRTL) && (frame.data[1] & CAN_ERR_CRTL_RX_OVERFLOW))
+    {
+        rxOverflows++;
+    }
+}
+
+void CANBusMonitor::endBatch(uint64_t decodeTime, uint64_t publishTime)
+{
+    seqlockWriteEnd(&stats->sequence);
+
+    if (publishTime > decodeTime)
+    {
+        uint64_t latency = (publishTime - decodeTime) / 1000;
+        decodeToPublishSum += latency;
+        decodeToPublishMax = std::max(decodeToPublishMax, latency);
+        decodeToPublishSamples++;
+    }
+}
+
+// Publishes the period figures. Per message counters are updated as frames
+// arrive; this derives rates, bus load and latencies and starts a new period.
+void CANBusMonitor::update(const CANSocketStats &socketStats)
+{
+    uint64_t uptime = System::uptime();
+    double elapsed = (uptime - periodStart) / 1000000.0;
+    if (elapsed <= 0)
+    {
+        return;
+    }
+
+    seqlockWriteBegin(&stats->sequence);
+
+    for (size_t i = 0; i < periodFrames.size(); i++)
+    {
+        stats->messages[i].rate = periodFrames[i] / elapsed;
+        periodFrames[i] = 0;
+    }
+
+    stats->updated = uptime;
+    stats->busLoad = bitrate ? 100.0 * periodBits / (bitrate * elapsed) : 0;
+    stats->framesReceived = socketStats.framesReceived;
+    stats->framesDropped = socketStats.framesDropped;
+    stats->rxOverflows = rxOverflows;
+    stats->errorFrames = errorFrames;
+    stats->unknownFrames = unknownFrames;
+    stats->receiveToDecodeAvg = receiveToDecodeSamples ? (double)receiveToDecodeSum / receiveToDecodeSamples : 0;
+    stats->receiveToDecodeMax = receiveToDecodeMax;
+    stats->decodeToPublishAvg = decodeToPublishSamples ? (double)decodeToPublishSum / decodeToPublishSamples : 0;
+    stats->decodeToPublishMax = decodeToPublishMax;
+
+    seqlockWriteEnd(&stats->sequence);
+
+    periodStart = uptime;
+    periodBits = 0;
+    receiveToDecodeSum = receiveToDecodeMax = receiveToDecodeSamples = 0;
+    decodeToPublishSum = decodeToPublishMax = decodeToPublishSamples = 0;
+}
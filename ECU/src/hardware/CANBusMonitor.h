@@ -0,0 +1,60 @@
+/*
+ * CANBusMonitor.h
+ *
+ *  Created on: 2026-10-17
+ *
+ *  Keeps the CANStats shared memory block up to date: per message rate,
+ *  inter-arrival jitter and last seen time, bus load, overflows and the
+ *  reception -> decode -> publish latency of the MCP2515 process.
+ */
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <linux/can.h>
+#include <linux/can/error.h>
+
+#include "common.h"
+#include "helpers.h"
+#include "CANSocket.h"
+#include "DBCParser.h"
+#include "System.h"
+
+class CANBusMonitor
+{
+private:
+    volatile CANStats *stats;
+    uint32_t bitrate;
+
+    // Working state kept out of shared memory
+    std::vector<uint64_t> lastArrival;  // Last frame timestamp per message (ns)
+    std::vector<uint64_t> periodFrames; // Frames per message in the current period
+    uint64_t periodStart = 0;
+    uint64_t periodBits = 0;
+    uint64_t receiveToDecodeSum = 0;
+    uint64_t receiveToDecodeMax = 0;
+    uint64_t receiveToDecodeSamples = 0;
+    uint64_t decodeToPublishSum = 0;
+    uint64_t decodeToPublishMax = 0;
+    uint64_t decodeToPublishSamples = 0;
+    uint64_t unknownFrames = 0;
+    uint64_t errorFrames = 0;
+    uint64_t rxOverflows = 0;
+
+    static uint32_t frameBits(const struct can_frame &);
+
+public:
+    CANBusMonitor(volatile CANStats *, uint32_t);
+
+    void begin(const std::vector<DBCMessage> &);
+    static uint64_t now();
+    void beginBatch();
+    void frameReceived(size_t, const struct can_frame &, uint64_t, uint64_t);
+    void unknownFrame(const struct can_frame &);
+    void errorFrame(const struct can_frame &);
+    void endBatch(uint64_t, uint64_t);
+    void update(const CANSocketStats &);
+};
@@ -0,0 +1,370 @@
+#include "CANSocket.h"
+
+#include <algorithm>
+
+CANSocket::CANSocket()
+    : description("CANSocket"), logger(std::make_unique<Logger>(description))
+{
+}
+
+CANSocket::~CANSocket()
+{
+    close();
+}
+
+bool CANSocket::open(const std::string &interfaceName, int receiveBufferSize)
+{
+    sock = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (sock < 0)
+    {
+        logger->error("Unable to create CAN socket!");
+        return false;
+    }
+
+    struct ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interfaceName.c_str(), IFNAMSIZ - 1);
+    if (ioctl(sock, SIOCGIFINDEX, &ifr) < 0)
+    {
+        logger->error("Unknown CAN interface " + interfaceName);
+        close();
+        return false;
+    }
+
+    // Kernel receive timestamps, hardware ones when the controller provides them
+    int timestamping = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                       SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &timestamping, sizeof(timestamping)) < 0)
+    {
+        logger->warning("SO_TIMESTAMPING not supported, frames will not carry kernel timestamps.");
+    }
+
+    // Report the number of frames dropped because the receive queue was full
+    int enable = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0)
+    {
+        logger->warning("SO_RXQ_OVFL not supported, dropped frames will not be counted.");
+    }
+
+    if (receiveBufferSize > 0 &&
+        setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &receiveBufferSize, sizeof(receiveBufferSize)) < 0)
+    {
+        logger->warning("Unable to set the CAN socket receive buffer size.");
+    }
+
+    struct sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+
+    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        logger->error("Unable to bind CAN socket to " + interfaceName);
+        close();
+        return false;
+    }
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0)
+    {
+        logger->error("Unable to create epoll instance!");
+        close();
+        return false;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = sock;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, sock, &event) < 0)
+    {
+        logger->error("Unable to register CAN socket with epoll!");
+        close();
+        return false;
+    }
+
+    for (size_t i = 0; i < CAN_SOCKET_BATCH_SIZE; i++)
+    {
+        iovecs[i].iov_base = &frames[i];
+        iovecs[i].iov_len = sizeof(struct can_frame);
+    }
+
+    logger->info("CAN socket bound to " + interfaceName);
+    return true;
+}
+
+void CANSocket::close()
+{
+    if (epollFd >= 0)
+    {
+        ::close(epollFd);
+        epollFd = -1;
+    }
+
+    if (sock >= 0)
+    {
+        ::close(sock);
+        sock = -1;
+    }
+}
+
+// Drains up to maxFrames frames without blocking.
+size_t CANSocket::readBatch(CANSocketFrame *out, size_t maxFrames)
+{
+    size_t batchSize = maxFrames < CAN_SOCKET_BATCH_SIZE ? maxFrames : CAN_SOCKET_BATCH_SIZE;
+
+    for (size_t i = 0; i < batchSize; i++)
+    {
+        memset(&messages[i], 0, sizeof(struct mmsghdr));
+        messages[i].msg_hdr.msg_iov = &iovecs[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_control = control[i];
+        messages[i].msg_hdr.msg_controllen = sizeof(control[i]);
+    }
+
+    int received = recvmmsg(sock, messages, batchSize, MSG_DONTWAIT, nullptr);
+    if (received <= 0)
+    {
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            stats.errors++;
+        }
+        return 0;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < received; i++)
+    {
+        struct msghdr &header = messages[i].msg_hdr;
+
+        if (messages[i].msg_len < sizeof(struct can_frame) || (header.msg_flags & MSG_TRUNC))
+        {
+            stats.truncated++;
+            continue;
+        }
+
+        uint64_t timestamp = 0;
+        for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&header); cmsg; cmsg = CMSG_NXTHDR(&header, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET)
+                continue;
+
+            if (cmsg->cmsg_type == SO_TIMESTAMPING)
+            {
+                struct timespec stamps[3];
+                memcpy(stamps, CMSG_DATA(cmsg), sizeof(stamps));
+                // stamps[0] is the software timestamp, stamps[2] the raw hardware one
+                const struct timespec &stamp = (stamps[2].tv_sec || stamps[2].tv_nsec) ? stamps[2] : stamps[0];
+                timestamp = (uint64_t)stamp.tv_sec * 1000000000ULL + stamp.tv_nsec;
+            }
+            else if (cmsg->cmsg_type == SO_RXQ_OVFL)
+            {
+                uint32_t dropCounter;
+                memcpy(&dropCounter, CMSG_DATA(cmsg), sizeof(dropCounter));
+                stats.framesDropped += (uint32_t)(dropCounter - lastDropCounter);
+                lastDropCounter = dropCounter;
+            }
+        }
+
+        out[count].frame = frames[i];
+        out[count].timestamp = timestamp;
+        count++;
+    }
+
+    stats.framesReceived += count;
+    stats.batches++;
+    if (count > stats.largestBatch)
+    {
+        stats.largestBatch = count;
+    }
+
+    return count;
+}
+
+// Returns the next batch of frames, waiting in epoll up to timeoutMs when the
+// socket queue is empty. Returns 0 on timeout or signal.
+size_t CANSocket::receive(CANSocketFrame *out, size_t maxFrames, int timeoutMs)
+{
+    if (sock < 0 || maxFrames == 0)
+    {
+        return 0;
+    }
+
+    size_t count = readBatch(out, maxFrames);
+    if (count > 0)
+    {
+        return count;
+    }
+
+    struct epoll_event event;
+    int ready = epoll_wait(epollFd, &event, 1, timeoutMs);
+    if (ready <= 0)
+    {
+        return 0;
+    }
+
+    return readBatch(out, maxFrames);
+}
+
+// Replaces the socket's receive filter list. Frames that match none of the
+// filters are discarded by the kernel and never wake the receive loop.
+bool CANSocket::setFilters(const std::vector<struct can_filter> &filters)
+{
+    if (sock < 0)
+    {
+        return false;
+    }
+
+    if (filters.size() > CAN_RAW_FILTER_MAX)
+    {
+        logger->error("Too many CAN filters: " + std::to_string(filters.size()));
+        return false;
+    }
+
+    if (setsockopt(sock, SOL_CAN_RAW, CAN_RAW_FILTER, filters.data(), filters.size() * sizeof(struct can_filter)) < 0)
+    {
+        logger->error("Unable to install CAN filters: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    return true;
+}
+
+// Selects the error classes delivered as error frames (CAN_ERR_FLAG set)
+bool CANSocket::setErrorFilter(can_err_mask_t mask)
+{
+    if (sock < 0 || setsockopt(sock, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &mask, sizeof(mask)) < 0)
+    {
+        logger->warning("Unable to enable CAN error frames.");
+        return false;
+    }
+    return true;
+}
+
+// Builds a filter list that accepts exactly the given IDs (CAN_EFF_FLAG set for
+// 29-bit identifiers), data frames only. Without merging there is one filter per
+// ID. With merging, IDs that differ in a single bit are combined into a don't-care
+// bit (Quine-McCluskey) and a greedy cover picks the fewest resulting id/mask
+// pairs, so the kernel still accepts no ID outside the list. Merged filters may
+// overlap; CAN_RAW delivers a frame once however many filters it matches.
+std::vector<struct can_filter> CANSocket::buildFilters(const std::vector<uint32_t> &ids, bool merge)
+{
+    struct Term
+    {
+        uint32_t value;
+        uint32_t care;
+    };
+
+    const uint32_t fullMask = CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_EFF_MASK;
+
+    std::vector<uint32_t> unique;
+    for (uint32_t id : ids)
+    {
+        uint32_t value = id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+        if (std::find(unique.begin(), unique.end(), value) == unique.end())
+        {
+            unique.push_back(value);
+        }
+    }
+
+    std::vector<struct can_filter> filters;
+    if (!merge)
+    {
+        for (uint32_t value : unique)
+        {
+            filters.push_back({value, fullMask});
+        }
+        return filters;
+    }
+
+    // Collect the prime implicants of the ID set
+    std::vector<Term> current;
+    std::vector<Term> primes;
+    for (uint32_t value : unique)
+    {
+        current.push_back({value, fullMask});
+    }
+
+    while (!current.empty())
+    {
+        std::vector<Term> next;
+        std::vector<bool> combined(current.size(), false);
+
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            for (size_t j = i + 1; j < current.size(); j++)
+            {
+                uint32_t diff = (current[i].value ^ current[j].value) & current[i].care;
+                if (current[i].care != current[j].care || !std::has_single_bit(diff))
+                {
+                    continue;
+                }
+
+                Term term = {current[i].value & ~diff, current[i].care & ~diff};
+                combined[i] = combined[j] = true;
+
+                bool exists = false;
+                for (const Term &other : next)
+                {
+                    if (other.value == term.value && other.care == term.care)
+                    {
+                        exists = true;
+                        break;
+                    }
+                }
+                if (!exists)
+                {
+                    next.push_back(term);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            if (!combined[i])
+            {
+                primes.push_back(current[i]);
+            }
+        }
+        current = std::move(next);
+    }
+
+    // Greedy cover: repeatedly take the implicant matching the most uncovered IDs
+    std::vector<bool> covered(unique.size(), false);
+    size_t remaining = unique.size();
+
+    while (remaining > 0)
+    {
+        const Term *best = nullptr;
+        size_t bestCount = 0;
+
+        for (const Term &term : primes)
+        {
+            size_t count = 0;
+            for (size_t i = 0; i < unique.size(); i++)
+            {
+                if (!covered[i] && (unique[i] & term.care) == term.value)
+                {
+                    count++;
+                }
+            }
+            if (count > bestCount)
+            {
+                best = &term;
+                bestCount = count;
+            }
+        }
+
+        for (size_t i = 0; i < unique.size(); i++)
+        {
+            if (!covered[i] && (unique[i] & best->care) == best->value)
+            {
+                covered[i] = true;
+                remaining--;
+            }
+        }
+        filters.push_back({best->value, best->care});
+    }
+
+    return filters;
+}
@@ -0,0 +1,80 @@
+/*
+ * CANSocket.h
+ *
+ *  Created on: 2026-10-17
+ *
+ *  Batched, event driven SocketCAN receiver. Waits in epoll, drains the
+ *  socket with recvmmsg and attaches the kernel receive timestamp to every
+ *  frame. Tracks the kernel drop counter (SO_RXQ_OVFL) and can install a
+ *  CAN_RAW_FILTER list so unwanted IDs never leave the kernel.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <bit>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <unistd.h>
+
+#include "Logger.h"
+
+#define CAN_SOCKET_BATCH_SIZE 64
+
+struct CANSocketFrame
+{
+    struct can_frame frame;
+    uint64_t timestamp; // Kernel receive time in nanoseconds (CLOCK_REALTIME)
+};
+
+struct CANSocketStats
+{
+    uint64_t framesReceived = 0;
+    uint64_t batches = 0;
+    uint64_t largestBatch = 0;
+    uint64_t framesDropped = 0; // Frames the kernel dropped because the socket queue was full
+    uint64_t truncated = 0;
+    uint64_t errors = 0;
+};
+
+class CANSocket
+{
+private:
+    std::string description;
+    std::unique_ptr<Logger> logger;
+
+    int sock = -1;
+    int epollFd = -1;
+    uint32_t lastDropCounter = 0;
+    CANSocketStats stats;
+
+    // recvmmsg scratch buffers, reused for every batch
+    struct can_frame frames[CAN_SOCKET_BATCH_SIZE];
+    struct iovec iovecs[CAN_SOCKET_BATCH_SIZE];
+    struct mmsghdr messages[CAN_SOCKET_BATCH_SIZE];
+    char control[CAN_SOCKET_BATCH_SIZE][CMSG_SPACE(3 * sizeof(struct timespec)) + CMSG_SPACE(sizeof(uint32_t))];
+
+    size_t readBatch(CANSocketFrame *, size_t);
+
+public:
+    CANSocket();
+    ~CANSocket();
+
+    bool open(const std::string &, int receiveBufferSize = 0);
+    bool setFilters(const std::vector<struct can_filter> &);
+    bool setErrorFilter(can_err_mask_t);
+    static std::vector<struct can_filter> buildFilters(const std::vector<uint32_t> &, bool merge);
+    void close();
+    size_t receive(CANSocketFrame *, size_t, int);
+    int getFd() const { return sock; }
+    const CANSocketStats &getStats() const { return stats; }
+};
@@ -1,5 +1,26 @@
 #include "MCP2515.h"
 
+// Holley messages published to the EngineSignals shared memory segment
+struct EngineSignalBinding
+{
+    uint32_t id;
+    float (*decode)(const uint8_t *);
+    EngineSignalId signal;
+};
+
+static const EngineSignalBinding engineSignalBindings[] = {
+    {HolleyDBC::RPM_ID, HolleyDBC::RPM_RPM, SIGNAL_RPM},
+    {HolleyDBC::CTS_ID, HolleyDBC::CTS_CTS, SIGNAL_CTS},
+    {HolleyDBC::Fuel_Flow_ID, HolleyDBC::Fuel_Flow_Fuel_Flow, SIGNAL_FUEL_FLOW},
+    {HolleyDBC::MAP_ID, HolleyDBC::MAP_MAP, SIGNAL_MAP},
+    {HolleyDBC::TPS_ID, HolleyDBC::TPS_TPS, SIGNAL_TPS},
+    {HolleyDBC::AirFuel_Ratio_ID, HolleyDBC::AirFuel_Ratio_AirFuel_Ratio, SIGNAL_AFR},
+    {HolleyDBC::Target_AFR_ID, HolleyDBC::Target_AFR_Target_AFR, SIGNAL_TARGET_AFR},
+    {HolleyDBC::Ignition_Timing_ID, HolleyDBC::Ignition_Timing_Ignition_Timing, SIGNAL_IGNITION_TIMING},
+    {HolleyDBC::Battery_ID, HolleyDBC::Battery_Battery, SIGNAL_BATTERY},
+    {HolleyDBC::MAT_ID, HolleyDBC::MAT_MAT, SIGNAL_MAT},
+};
+
 MCP2515::MCP2515() : spiDevice(SPI1_DEVICE)
 {
     description = "MCP2515";
@@ -7,6 +28,34 @@ MCP2515::MCP2515() : spiDevice(SPI1_DEVICE)
     config = std::make_unique<Config>(description);
 
     loopInterval = config->get<useconds_t>("loop_interval");
+    benchmarkEnabled = config->get<bool>("benchmark_enabled");
+    benchmarkFrames = config->get<uint64_t>("benchmark_frames");
+    interfaceName = config->get<std::string>("interface");
+    receiveBufferSize = config->get<int>("receive_buffer_size");
+    statsInterval = config->get<uint64_t>("stats_interval");
+    bitrate = config->get<uint32_t>("bitrate");
+    subscribedMessages = config->get<std::string>("subscribed_messages");
+    filterMerge = config->get<bool>("filter_merge");
+    logFrames = config->get<bool>("log_frames");
+    std::string source = config->get<std::string>("source_serial");
+    if (source != "any")
+    {
+        char *end = nullptr;
+        long serial = strtol(source.c_str(), &end, 10);
+        if (source.empty() || *end != '\0' || serial < 0 || serial > INT_MAX)
+        {
+            logger->warning("Invalid source_serial " + source + ", decoding any unit");
+        }
+        else
+        {
+            sourceSerial = (int)serial;
+        }
+    }
+    recordTrace = config->get<bool>("record_trace");
+    traceDirectory = config->get<std::string>("trace_directory");
+    traceSegmentFrames = config->get<uint32_t>("trace_segment_frames");
+    replayTrace = config->get<std::string>("replay_trace");
+    replaySpeed = config->get<double>("replay_speed");
 
     initialized = begin();
 }
@@ -129,15 +178,7 @@ void MCP2515::parseCANMessage(struct can_frame &frame)
         return;
     }
 
-    // Apply the mask to extract the relevant fields
-    // uint32_t canID = frame.can_id & 0xFFFFF800;
-
-    // Decode CAN ID fields
-    uint8_t commandBit = (frame.can_id >> 28) & 0x1;
-    uint8_t targetID = (frame.can_id >> 25) & 0x7;
-    uint16_t targetSerial = (frame.can_id >> 14) & 0x7FF;
-    uint8_t sourceID = (frame.can_id >> 11) & 0x7;
-    uint16_t sourceSerial = frame.can_id & 0x7FF;
+    HolleyDBC::Address address = HolleyDBC::decodeAddress(frame.can_id);
 
     // Extract float values (Big Endian conversion required)
     float value1, value2;
@@ -155,60 +196,331 @@ void MCP2515::parseCANMessage(struct can_frame &frame)
     // Print parsed data
     std::cout << "Received CAN Message:" << std::endl;
     std::cout << "  CAN ID: 0x" << std::hex << frame.can_id << std::dec << std::endl;
-    std::cout << "  Command Bit: " << (int)commandBit << std::endl;
-    std::cout << "  Target ID: " << (int)targetID << std::endl;
-    std::cout << "  Target Serial: " << targetSerial << std::endl;
-    std::cout << "  Source ID: " << (int)sourceID << std::endl;
-    std::cout << "  Source Serial: " << sourceSerial << std::endl;
+    std::cout << "  Command Bit: " << (int)address.command << std::endl;
+    std::cout << "  Target ID: " << (int)address.target_id << std::endl;
+    std::cout << "  Target Serial: " << address.target_serial << std::endl;
+    std::cout << "  Source ID: " << (int)address.source_id << std::endl;
+    std::cout << "  Source Serial: " << address.source_serial << std::endl;
     std::cout << "  Value 1: " << value1 << " | Status 1: 0x" << std::hex << status1 << std::dec << std::endl;
     std::cout << "  Value 2: " << value2 << " | Status 2: 0x" << std::hex << status2 << std::dec << std::endl;
 }
 
 void MCP2515::loop()
 {
-    if (!dbc.loadDBC(HOLLEY_SNIPER_DBC_FILE))
+    if (!dbc.loadGenerated(HolleyDBC::MESSAGES, HolleyDBC::MESSAGE_COUNT))
     {
-        logger->error("Failed to load DBC file!");
+        logger->error("Failed to load DBC decoders!");
         return;
     }
-    logger->info("DBC file successfully loaded!");
+    logger->info("DBC decoders successfully loaded!");
 
-    int sock = socket(PF_CAN, SOCK_RAW, CAN_RAW);
-    if (sock < 0)
+    // Holley IDs carry the sender's serial, match messages from any unit
+    dbc.setIgnoredIDBits(HolleyDBC::SOURCE_MASK);
+
+    if (benchmarkEnabled)
     {
-        logger->error("Unable to create CAN socket!");
-        return;
+        double framesPerSecond = dbc.benchmark(benchmarkFrames);
+        logger->info("DBC decode benchmark: " + std::to_string(benchmarkFrames) + " frames at " +
+                     std::to_string(framesPerSecond) + " frames/s");
     }
-    logger->info("CAN socket created!");
 
-    struct ifreq ifr;
-    strcpy(ifr.ifr_name, "can0");
-    ioctl(sock, SIOCGIFINDEX, &ifr);
+    acceptCounts.assign(dbc.getMessages().size(), 0);
+    bindEngineSignals();
 
-    struct sockaddr_can addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.can_family = AF_CAN;
-    addr.can_ifindex = ifr.ifr_ifindex;
+    monitor = std::make_unique<CANBusMonitor>(canStats, bitrate);
+    monitor->begin(dbc.getMessages());
+
+    if (replayTrace != "none")
+    {
+        replay();
+        return;
+    }
 
-    if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    if (!canSocket.open(interfaceName, receiveBufferSize))
     {
-        logger->error("Unable to bind CAN socket!");
-        close(sock);
         return;
     }
-    logger->info("CAN socket binded!");
 
-    struct can_frame frame;
+    if (!installFilters())
+    {
+        canSocket.close();
+        return;
+    }
+
+    // Controller problems (RX overflows) and bus-off arrive as error frames
+    canSocket.setErrorFilter(CAN_ERR_CRTL | CAN_ERR_BUSOFF);
+
+    if (recordTrace)
+    {
+        if (recorder.open(traceDirectory, traceSegmentFrames))
+        {
+            logger->info("Recording CAN trace to " + traceDirectory);
+        }
+        else
+        {
+            logger->warning("Unable to record CAN trace to " + traceDirectory);
+        }
+    }
+
+    // Wait in epoll at most one loop interval so termination is noticed promptly
+    int receiveTimeout = loopInterval / 1000 > 0 ? loopInterval / 1000 : 1;
+    uint64_t lastMonitorTime = System::uptime();
+    lastStatsTime = System::uptime();
+
     while (!terminateFlag.load())
     {
-        int nbytes = read(sock, &frame, sizeof(struct can_frame));
-        if (nbytes > 0)
+        size_t count = canSocket.receive(rxFrames, CAN_SOCKET_BATCH_SIZE, receiveTimeout);
+
+        if (count > 0)
         {
-            dbc.parseCANData(frame.can_id, frame.data, frame.can_dlc);
+            processFrames(rxFrames, count);
         }
 
-        std::this_thread::sleep_for(std::chrono::microseconds(loopInterval));
+        if (System::uptime() - lastMonitorTime >= 1000000)
+        {
+            monitor->update(canSocket.getStats());
+            lastMonitorTime = System::uptime();
+        }
+
+        if (statsInterval > 0 && System::uptime() - lastStatsTime >= statsInterval * 1000000)
+        {
+            logStats();
+        }
+    }
+
+    logStats();
+    if (recorder.isOpen())
+    {
+        logger->info("Recorded " + std::to_string(recorder.recordCount()) + " CAN frames");
+        recorder.close();
+    }
+    canSocket.close();
+}
+
+// Decodes and publishes a batch of received frames
+void MCP2515::processFrames(const CANSocketFrame *frames, size_t count)
+{
+    // One seqlock write section per batch, readers only retry when they overlap it
+    uint64_t decodeTime = CANBusMonitor::now();
+    uint64_t receiveTime = System::uptime();
+    monitor->beginBatch();
+    beginEngineSignalsWrite(engineSignals);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const struct can_frame &frame = frames[i].frame;
+        if (frame.can_id & CAN_ERR_FLAG)
+        {
+            monitor->errorFrame(frame);
+            continue;
+        }
+
+        const DBCMessage *message = dbc.findMessage(frame.can_id);
+        if (message && sourceSerial >= 0 && HolleyDBC::decodeAddress(frame.can_id).source_serial != sourceSerial)
+        {
+            message = nullptr; // Another Holley unit on the bus
+        }
+
+        if (message)
+        {
+            size_t index = message - dbc.getMessages().data();
+            acceptCounts[index]++;
+            monitor->frameReceived(index, frame, frames[i].timestamp, decodeTime);
+            publishFrame(index, frame, receiveTime);
+        }
+        else
+        {
+            unknownFrames++;
+            monitor->unknownFrame(frame);
+        }
+    }
+
+    endEngineSignalsWrite(engineSignals);
+    monitor->endBatch(decodeTime, CANBusMonitor::now());
+
+    // Recording and logging stay out of the publish latency
+    for (size_t i = 0; recorder.isOpen() && i < count; i++)
+    {
+        recorder.append(frames[i].frame, frames[i].timestamp);
     }
 
-    close(sock);
-}
\ No newline at end of file
+    for (size_t i = 0; logFrames && i < count; i++)
+    {
+        const struct can_frame &frame = frames[i].frame;
+        dbc.parseCANData(frame.can_id, const_cast<uint8_t *>(frame.data), frame.can_dlc, frames[i].timestamp);
+    }
+}
+
+// Feeds a recorded trace through the same decode and publish path as live
+// frames, so the dashboards can be exercised without the car.
+void MCP2515::replay()
+{
+    CANTraceReader reader;
+    if (!reader.open(replayTrace))
+    {
+        logger->error("Cannot open CAN trace " + replayTrace);
+        return;
+    }
+
+    logger->info("Replaying " + std::to_string(reader.recordCount()) + " CAN frames from " + replayTrace +
+                 (replaySpeed > 0 ? " at " + std::to_string(replaySpeed) + "x" : " as fast as possible"));
+
+    CANReplay replayer(reader, replaySpeed);
+    CANSocketStats socketStats;
+    uint64_t lastMonitorTime = System::uptime();
+
+    CANReplayStats stats = replayer.run([&](const CANTraceRecord &record)
+                                        {
+        CANSocketFrame frame;
+        memset(&frame, 0, sizeof(frame));
+        frame.frame.can_id = record.canID;
+        frame.frame.can_dlc = record.dlc;
+        memcpy(frame.frame.data, record.data, sizeof(record.data));
+        frame.timestamp = CANBusMonitor::now();
+
+        processFrames(&frame, 1);
+        socketStats.framesReceived++;
+        socketStats.batches++;
+
+        if (System::uptime() - lastMonitorTime >= 1000000)
+        {
+            monitor->update(socketStats);
+            lastMonitorTime = System::uptime();
+        } }, &terminateFlag);
+
+    monitor->update(socketStats);
+    logger->info("Replayed " + std::to_string(stats.frames) + " frames in " + std::to_string(stats.elapsed) +
+                 " s (" + std::to_string(stats.framesPerSecond) + " frames/s, decode " +
+                 std::to_string(stats.decodePerSecond) + " frames/s)");
+    logger->info("Replay latency: avg " + std::to_string(stats.latencyAvg) + " us, p99 " +
+                 std::to_string(stats.latencyP99) + " us, max " + std::to_string(stats.latencyMax) + " us, " +
+                 std::to_string(stats.lateFrames) + " late frames");
+}
+
+// Resolves the engine signal bindings to DBC message indexes once
+void MCP2515::bindEngineSignals()
+{
+    signalBindings.assign(dbc.getMessages().size(), -1);
+
+    for (size_t i = 0; i < sizeof(engineSignalBindings) / sizeof(engineSignalBindings[0]); i++)
+    {
+        const DBCMessage *message = dbc.findMessage(engineSignalBindings[i].id);
+        if (message)
+        {
+            signalBindings[message - dbc.getMessages().data()] = i;
+        }
+    }
+}
+
+// Stores the decoded value of a bound message. Called inside a write section.
+void MCP2515::publishFrame(size_t messageIndex, const struct can_frame &frame, uint64_t receiveTime)
+{
+    int8_t binding = signalBindings[messageIndex];
+
+    // Holley frames are always 8 bytes, anything shorter is malformed
+    if (binding < 0 || frame.can_dlc < 8)
+    {
+        return;
+    }
+
+    const EngineSignalBinding &signalBinding = engineSignalBindings[binding];
+    volatile EngineSignal &signal = engineSignals->signals[signalBinding.signal];
+
+    signal.value = signalBinding.decode(frame.data);
+    signal.timestamp = receiveTime;
+    signal.valid = true;
+    engineSignals->framesDecoded = engineSignals->framesDecoded + 1;
+}
+
+// Installs a kernel CAN_RAW_FILTER list accepting only the subscribed DBC
+// messages ("all" subscribes to every message of the DBC).
+bool MCP2515::installFilters()
+{
+    std::vector<uint32_t> ids;
+
+    if (subscribedMessages == "all")
+    {
+        for (const DBCMessage &message : dbc.getMessages())
+        {
+            ids.push_back(message.id | (message.extended ? CAN_EFF_FLAG : 0));
+        }
+    }
+    else
+    {
+        std::stringstream list(subscribedMessages);
+        std::string name;
+        while (std::getline(list, name, ','))
+        {
+            // "RPM, CTS" lists the messages with spaces after the commas
+            name = trim(name);
+            if (name.empty())
+            {
+                continue;
+            }
+            const DBCMessage *message = dbc.findMessageByName(name);
+            if (!message)
+            {
+                logger->warning("Unknown subscribed message, not in the DBC: " + name);
+                continue;
+            }
+            ids.push_back(message->id | (message->extended ? CAN_EFF_FLAG : 0));
+        }
+    }
+
+    if (ids.empty())
+    {
+        logger->error("No CAN messages subscribed!");
+        return false;
+    }
+
+    std::vector<struct can_filter> filters = CANSocket::buildFilters(ids, filterMerge);
+
+    // Accept the subscribed messages from any Holley unit, the source fields
+    // are checked in software when source_serial is set
+    for (struct can_filter &filter : filters)
+    {
+        filter.can_mask &= ~HolleyDBC::SOURCE_MASK;
+        filter.can_id &= ~HolleyDBC::SOURCE_MASK;
+    }
+    if (!canSocket.setFilters(filters))
+    {
+        return false;
+    }
+
+    logger->info("Installed " + std::to_string(filters.size()) + " CAN filters for " +
+                 std::to_string(ids.size()) + " subscribed messages");
+    return true;
+}
+
+void MCP2515::logStats()
+{
+    const CANSocketStats &stats = canSocket.getStats();
+    uint64_t now = System::uptime();
+    double elapsed = (now - lastStatsTime) / 1000000.0;
+
+    logger->info("Received " + std::to_string(stats.framesReceived) + " frames in " +
+                 std::to_string(stats.batches) + " batches (largest " + std::to_string(stats.largestBatch) +
+                 "), dropped " + std::to_string(stats.framesDropped) + ", truncated " +
+                 std::to_string(stats.truncated) + ", errors " + std::to_string(stats.errors));
+
+    if (elapsed > 0)
+    {
+        logger->info("Wakeups: " + std::to_string((stats.batches - lastBatches) / elapsed) + "/s");
+    }
+
+    const std::vector<DBCMessage> &messages = dbc.getMessages();
+    for (size_t i = 0; i < acceptCounts.size(); i++)
+    {
+        if (acceptCounts[i] > 0)
+        {
+            logger->info("  " + dbc.getMessageName(messages[i].id) + ": " + std::to_string(acceptCounts[i]) + " accepted");
+        }
+    }
+    if (unknownFrames > 0)
+    {
+        logger->info("  Unknown IDs: " + std::to_string(unknownFrames) + " accepted");
+    }
+
+    lastStatsTime = now;
+    lastBatches = stats.batches;
+}
@@ -10,12 +10,23 @@
 #include <net/if.h>
 #include <unistd.h>
 #include <cstring>
+#include <cstdlib>
+#include <climits>
 #include <iostream>
 #include <arpa/inet.h> // For byte order conversion
 
 #include "Process.h"
 #include "DBCParser.h"
+#include "CANSocket.h"
+#include "CANBusMonitor.h"
+#include "CANTrace.h"
+#include "CANReplay.h"
+#include "System.h"
 #include "common.h"
+#include "helpers.h"
+
+extern volatile EngineSignals *engineSignals;
+extern volatile CANStats *canStats;
 
 class MCP2515 : public Process
 {
@@ -27,7 +38,41 @@ private:
     const uint32_t speed = 4000000;  // SPI Speed (4 MHz)
 
     bool initialized = false;
+    bool benchmarkEnabled = false;
+    uint64_t benchmarkFrames = 0;
+    std::string interfaceName;
+    int receiveBufferSize = 0;
+    uint64_t statsInterval = 0;
+    uint32_t bitrate = 0;
+    std::string subscribedMessages;
+    bool filterMerge = false;
+    bool logFrames = false;
+    int sourceSerial = -1; // Holley unit to decode, -1 for any
+    bool recordTrace = false;
+    std::string traceDirectory;
+    uint32_t traceSegmentFrames = 0;
+    std::string replayTrace;
+    double replaySpeed = 1;
     DBCParser dbc;
+    CANSocket canSocket;
+    CANSocketFrame rxFrames[CAN_SOCKET_BATCH_SIZE];
+    std::unique_ptr<CANBusMonitor> monitor;
+    CANTraceWriter recorder;
+
+    // Frames accepted per DBC message (same order as dbc.getMessages())
+    std::vector<uint64_t> acceptCounts;
+    uint64_t unknownFrames = 0;
+    // Engine signal binding per DBC message (-1 when the message is not published)
+    std::vector<int8_t> signalBindings;
+    uint64_t lastStatsTime = 0;
+    uint64_t lastBatches = 0;
+
+    bool installFilters();
+    void bindEngineSignals();
+    void publishFrame(size_t, const struct can_frame &, uint64_t);
+    void processFrames(const CANSocketFrame *, size_t);
+    void replay();
+    void logStats();
 
 public:
     MCP2515();
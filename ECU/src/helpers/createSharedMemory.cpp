@@ -40,6 +40,8 @@ T *createSharedMemory(const char *shmName, bool create)
 
 // Explicit instantiation for required types
 template EngineValues *createSharedMemory<EngineValues>(const char *, bool);
+template EngineSignals *createSharedMemory<EngineSignals>(const char *, bool);
+template CANStats *createSharedMemory<CANStats>(const char *, bool);
 template SpeedSensorData *createSharedMemory<SpeedSensorData>(const char *, bool);
 template CoolantTempSensorData *createSharedMemory<CoolantTempSensorData>(const char *, bool);
 template FuelConsumptionData *createSharedMemory<FuelConsumptionData>(const char *, bool);
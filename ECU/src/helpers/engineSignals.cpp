@@ -0,0 +1,50 @@
+#include "helpers.h"
+#include "System.h"
+
+// EngineSignals is guarded by a seqlock. The MCP2515 process is the only
+// writer, so it never waits and readers retry when they overlap an update.
+
+void beginEngineSignalsWrite(volatile EngineSignals *engineSignals)
+{
+    seqlockWriteBegin(&engineSignals->sequence);
+}
+
+void endEngineSignalsWrite(volatile EngineSignals *engineSignals)
+{
+    seqlockWriteEnd(&engineSignals->sequence);
+}
+
+// Copies a consistent snapshot of one signal. Returns the signal's validity.
+bool readEngineSignal(const volatile EngineSignals *engineSignals, EngineSignalId id, EngineSignal &signal)
+{
+    uint32_t sequence;
+
+    do
+    {
+        sequence = seqlockReadBegin(&engineSignals->sequence);
+        signal.value = engineSignals->signals[id].value;
+        signal.timestamp = engineSignals->signals[id].timestamp;
+        signal.valid = engineSignals->signals[id].valid;
+    } while (seqlockReadRetry(&engineSignals->sequence, sequence));
+
+    return signal.valid;
+}
+
+// Reads a signal's value only when it is valid and was received within
+// ENGINE_SIGNAL_TIMEOUT.
+bool readFreshEngineSignal(const volatile EngineSignals *engineSignals, EngineSignalId id, double &value)
+{
+    EngineSignal signal;
+    if (!engineSignals || !readEngineSignal(engineSignals, id, signal))
+    {
+        return false;
+    }
+
+    if (System::uptime() - signal.timestamp > ENGINE_SIGNAL_TIMEOUT)
+    {
+        return false;
+    }
+
+    value = signal.value;
+    return true;
+}
@@ -32,6 +32,14 @@ void signalHandler(int);
 void terminateChildProcesses(std::vector<ChildProcess>);
 std::string trim(const std::string &);
 std::string getProgramName(char *);
+void seqlockWriteBegin(volatile uint32_t *);
+void seqlockWriteEnd(volatile uint32_t *);
+uint32_t seqlockReadBegin(const volatile uint32_t *);
+bool seqlockReadRetry(const volatile uint32_t *, uint32_t);
+void beginEngineSignalsWrite(volatile EngineSignals *);
+void endEngineSignalsWrite(volatile EngineSignals *);
+bool readEngineSignal(const volatile EngineSignals *, EngineSignalId, EngineSignal &);
+bool readFreshEngineSignal(const volatile EngineSignals *, EngineSignalId, double &);
 
 template <typename T>
 T *createSharedMemory(const char *, bool);
@@ -0,0 +1,36 @@
+#include "helpers.h"
+
+#include <atomic>
+
+// Sequence lock for shared memory blocks with a single writer. The counter is
+// odd while the writer is updating; readers copy the data and retry when the
+// counter was odd or changed meanwhile, so the writer never waits.
+
+void seqlockWriteBegin(volatile uint32_t *sequence)
+{
+    uint32_t value = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(sequence, value + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void seqlockWriteEnd(volatile uint32_t *sequence)
+{
+    uint32_t value = __atomic_load_n(sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(sequence, value + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t seqlockReadBegin(const volatile uint32_t *sequence)
+{
+    uint32_t value;
+    while ((value = __atomic_load_n(sequence, __ATOMIC_ACQUIRE)) & 1)
+    {
+    }
+    return value;
+}
+
+// True when the data copied since seqlockReadBegin() may be torn
+bool seqlockReadRetry(const volatile uint32_t *sequence, uint32_t begin)
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return __atomic_load_n(sequence, __ATOMIC_RELAXED) != begin;
+}
@@ -17,140 +17,339 @@
 #include <unistd.h>
 #include <stdint.h>
 #include <stdlib.h> //memset
+#include <string.h>
+#include <limits.h> //PATH_MAX
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "GUI_Paint.h"
+#include "GUI_Bundle.h"
 // #include "GUI_Cache.h"
 
-UBYTE GUI_ReadBmp(const char *path)
+/******************************************************************************
+function:	Read-only mapping of a whole file
+parameter:
+	path : File to map
+	size : Set to the size of the file
+	st   : Set to the file status, may be NULL
+return:	The mapping, NULL if the file can't be opened or is empty
+******************************************************************************/
+static const UBYTE *GUI_MapFile(const char *path, size_t *size, struct stat *st)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	void *data = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return NULL;
+
+	*size = fileStat.st_size;
+	if (st)
+		*st = fileStat;
+	return (const UBYTE *)data;
+}
+
+static int64_t GUI_Mtime(const struct stat *st)
+{
+	return (int64_t)st->st_mtim.tv_sec * 1000000000 + st->st_mtim.tv_nsec;
+}
+
+static uint64_t GUI_HashBmp(const UBYTE *data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/******************************************************************************
+function:	Convert a mapped BMP into a panel-native RGB565 surface
+parameter:
+	file   : The BMP file
+	size   : Size of the file
+	width  : Set to the width of the surface
+	height : Set to the height of the surface
+return:	The surface, top row first, to be freed by the caller. NULL if the
+		file is not a BMP this reader understands
+info:
+	1, 4 and 8 bit palettes, RGB565 (bitfields), XRGB1555, RGB888 and
+	(A/X)RGB8888 are converted, as GUI_ReadBmp always did
+******************************************************************************/
+static UWORD *GUI_ConvertBmp(const UBYTE *file, size_t size, UDOUBLE *width, UDOUBLE *height)
 {
-	FILE *fp;					 // Define a file pointer
 	BMPFILEHEADER bmpFileHeader; // Define a bmp file header structure
 	BMPINF bmpInfoHeader;		 // Define a bmp bitmap header structure
-	// UBYTE rgbReversed;
-	//  Binary file open
-	if ((fp = fopen(path, "rb")) == NULL)
-	{ // fp = 0x00426aa0
-		DEBUG("Can't open the file!\n");
-		printf("Can't open the file!");
-		return 0;
+	if (size < sizeof(BMPFILEHEADER) + sizeof(BMPINF))
+		return NULL;
+	memcpy(&bmpFileHeader, file, sizeof(BMPFILEHEADER));
+	memcpy(&bmpInfoHeader, file + sizeof(BMPFILEHEADER), sizeof(BMPINF));
+
+	UWORD bitCount = bmpInfoHeader.bBitCount;
+	if (bmpFileHeader.bType != 0x4D42 ||
+		(bitCount != 1 && bitCount != 4 && bitCount != 8 && bitCount != 16 && bitCount != 24 && bitCount != 32))
+	{
+		DEBUG("Not a supported BMP\r\n");
+		return NULL;
 	}
 
-	fseek(fp, 0, SEEK_SET);								 // Set the file pointer from the beginning
-	fread(&bmpFileHeader, sizeof(BMPFILEHEADER), 1, fp); // Gets the BMP file header
-	fread(&bmpInfoHeader, sizeof(BMPINF), 1, fp);		 // Gets BMP Info Header
-	printf("bBitCount= " + bmpInfoHeader.bBitCount);	 // Print a pixel takes several bit!!!
+	// Positive heights are stored bottom-up
+	UDOUBLE bmpWidth = bmpInfoHeader.bWidth;
+	int32_t signedHeight = (int32_t)bmpInfoHeader.bHeight;
+	UDOUBLE bmpHeight = signedHeight < 0 ? -signedHeight : signedHeight;
 
-	// Get palette information, Max 256 color information
-	// You can use the malloc function to reduce the memory required to run this program
-	/*
-			bBitCount	RGBPAD
-				1		   2
-				4		  16
-				8		 256
-	 */
-	RGBQUAD RGBPAD[256];
-	if (bmpInfoHeader.bBitCount < 16)
+	// In Windows each row data must be divisible by 4 byte
+	size_t stride = ((size_t)bmpWidth * bitCount + 31) / 32 * 4;
+	if (bmpWidth == 0 || bmpHeight == 0 || bmpFileHeader.bOffset > size ||
+		stride * bmpHeight > size - bmpFileHeader.bOffset)
 	{
+		DEBUG("Truncated BMP\r\n");
+		return NULL;
+	}
 
-		uint16_t i = 0;
-		for (i = 0; i < (1 << (bmpInfoHeader.bBitCount)); i++)
+	// Get palette information, Max 256 color information
+	UWORD palette[256] = {0};
+	if (bitCount < 16)
+	{
+		const UBYTE *table = file + sizeof(BMPFILEHEADER) + bmpInfoHeader.bInfoSize;
+		for (uint16_t i = 0; i < (1 << bitCount) && table + (i + 1) * 4 <= file + bmpFileHeader.bOffset; i++)
 		{
-			fseek(fp, (0X36) + (i * 4), SEEK_SET);
-			fread(&RGBPAD[i], sizeof(RGBQUAD), 1, fp);
+			const RGBQUAD *entry = (const RGBQUAD *)(table + i * 4);
+			palette[i] = RGB((entry->rgbRed), (entry->rgbGreen), (entry->rgbBlue));
 		}
 	}
 
-	// In Windows each row data must be divisible by 4 byte
-	// Calculate how many bytes per row of data need to be indented
-
-	int32_t indent;
-	if (bmpInfoHeader.bBitCount < 8)
-		indent = (4 - ((bmpInfoHeader.bWidth / (8 / bmpInfoHeader.bBitCount)) % 4)) % 4;
-	else
-		indent = (4 - ((bmpInfoHeader.bWidth * (bmpInfoHeader.bBitCount / 8)) % 4)) % 4;
-
-	uint32_t row, col;
-	short data; // All data formats are converted to RGB565 format
-	char pixels, temp;
-	int len = bmpInfoHeader.bBitCount / 8;
-	ARGBQUAD argb;
-	/*
-	fseek(fp, bmpFileHeader.bOffset, SEEK_SET);
-	printf("frist add:0x%x \r\n",bmpFileHeader.bOffset);
-	printf("BMP height:%d\r\n",bmpInfoHeader.bHeight);
-	printf("BMP width :%d\r\n",bmpInfoHeader.bWidth);
-	*/
-	// get bmp data and show
-	for (row = 0; row < bmpInfoHeader.bHeight; row++)
+	UWORD *surface = (UWORD *)malloc((size_t)bmpWidth * bmpHeight * sizeof(UWORD));
+	if (surface == NULL)
+		return NULL;
+
+	for (UDOUBLE row = 0; row < bmpHeight; row++)
 	{
-		for (col = 0; col < bmpInfoHeader.bWidth;)
+		const UBYTE *src = file + bmpFileHeader.bOffset + row * stride;
+		UWORD *dst = surface + (size_t)(signedHeight < 0 ? row : bmpHeight - row - 1) * bmpWidth;
+
+		for (UDOUBLE col = 0; col < bmpWidth; col++)
 		{
-			if (bmpInfoHeader.bBitCount == 16)
+			UWORD data; // All data formats are converted to RGB565 format
+			if (bitCount == 16)
 			{
-				if (fread((char *)&data, 1, len, fp) != (size_t)len)
-				{
-					// printf("get bmpdata:\r\n");
-					break;
-				}
-				// ARGB4444 format cannot be recognized for the time being. It can only be used to identify RGB565 format information!!
-				if (bmpInfoHeader.bInfoSize == 0x38)
-				{
-					Paint_SetPixel(col, bmpInfoHeader.bHeight - row - 1, data);
-				}
-				// Used to identify the XRGB1555 format
-				else if ((bmpInfoHeader.bInfoSize == 0x28) && (bmpInfoHeader.bCompression == 0x00))
-				{
+				data = src[col * 2] | (src[col * 2 + 1] << 8);
+				// Used to identify the XRGB1555 format, anything else is taken as RGB565
+				if ((bmpInfoHeader.bInfoSize == 0x28) && (bmpInfoHeader.bCompression == 0x00))
 					data = ((((long)((data >> 5) & 0x1f) * 0X3F) / 0X1F) << 5) + (data & 0x1f) + ((data & 0xEC00) << 1);
-					Paint_SetPixel(col, bmpInfoHeader.bHeight - row - 1, data);
-				}
-				col++;
 			}
 			// For RGB888 ARGB8888 XRGB8888 format uniform compression and removal of alpha
-			else if (bmpInfoHeader.bBitCount > 16)
+			else if (bitCount > 16)
 			{
-				if (fread((char *)&argb, 1, len, fp) != (size_t)len)
-				{
-					// printf("x:%d,y:%d\r\n", col, row);
-					// printf("get bmpdata: \r\n");
-					break;
-				}
-				data = RGB((argb.rgbRed), (argb.rgbGreen), (argb.rgbBlue));
-				Paint_SetPixel(col, bmpInfoHeader.bHeight - row - 1, data);
-				col++;
+				const UBYTE *argb = src + col * (bitCount / 8);
+				data = RGB((argb[2]), (argb[1]), (argb[0]));
 			}
 			// bBitCount<8 format
 			else
 			{
-				if (fread((char *)&pixels, 1, 1, fp) != 1)
-				{
-					// printf("get bmpdata:\r\n");
-					break;
-				}
-				for (temp = 0; (temp < (8 / bmpInfoHeader.bBitCount)) && (col < bmpInfoHeader.bWidth); temp++, col++)
+				UDOUBLE bit = col * bitCount;
+				UBYTE index = (src[bit / 8] >> (8 - bitCount - bit % 8)) & ((1 << bitCount) - 1);
+				data = palette[index];
+			}
+			dst[col] = ((data << 8) & 0xff00) | (data >> 8);
+		}
+	}
+
+	*width = bmpWidth;
+	*height = bmpHeight;
+	return surface;
+}
+
+/******************************************************************************
+function:	Draw a panel-native surface at the top left of the image
+parameter:
+	surface : Byte-swapped RGB565 pixels, top row first
+	width   : Width of the surface
+	height  : Height of the surface
+info:
+	Copied row by row (a single memcpy when it spans whole image rows) when
+	the image is neither rotated nor mirrored, through Paint_SetPixel otherwise
+******************************************************************************/
+void GUI_DrawSurface(const UWORD *surface, UDOUBLE width, UDOUBLE height)
+{
+	if (Paint.Depth == 16 && Paint.Rotate == ROTATE_0 && Paint.Mirror == MIRROR_NONE)
+	{
+		UDOUBLE cols = width < Paint.WidthMemory ? width : Paint.WidthMemory;
+		UDOUBLE rows = height < Paint.HeightMemory ? height : Paint.HeightMemory;
+		if (width == Paint.WidthByte)
+		{
+			memcpy(Paint.Image, surface, (size_t)cols * rows * sizeof(UWORD));
+		}
+		else
+		{
+			for (UDOUBLE row = 0; row < rows; row++)
+				memcpy(Paint.Image + (size_t)row * Paint.WidthByte, surface + (size_t)row * width, cols * sizeof(UWORD));
+		}
+		Paint_AddDamage(0, 0, cols, rows);
+		return;
+	}
+
+	for (UDOUBLE row = 0; row < height && row < Paint.Height; row++)
+	{
+		for (UDOUBLE col = 0; col < width && col < Paint.Width; col++)
+		{
+			UWORD data = surface[(size_t)row * width + col];
+			Paint_SetPixel(col, row, ((data << 8) & 0xff00) | (data >> 8));
+		}
+	}
+}
+
+/******************************************************************************
+function:	Write a converted surface next to its BMP
+parameter:
+	cachePath : Where to write it
+	header    : Filled in cache header
+	surface   : The pixels
+info:
+	Written to a temporary file and renamed, so a reader never sees half of
+	it. A read-only assets directory just means no cache
+******************************************************************************/
+static void GUI_WriteBmpCache(const char *cachePath, const BMPCACHEHEADER *header, const UWORD *surface)
+{
+	char tempPath[PATH_MAX + sizeof(".tmp")];
+	int length = snprintf(tempPath, sizeof(tempPath), "%s.tmp", cachePath);
+	if (length < 0 || (size_t)length >= sizeof(tempPath))
+	{
+		DEBUG("BMP cache path too long: %s\r\n", cachePath);
+		return;
+	}
+
+	int fd = open(tempPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		DEBUG("Can't write the BMP cache %s\r\n", cachePath);
+		return;
+	}
+
+	size_t pixelBytes = (size_t)header->bWidth * header->bHeight * sizeof(UWORD);
+	bool written = write(fd, header, sizeof(BMPCACHEHEADER)) == (ssize_t)sizeof(BMPCACHEHEADER) &&
+				   write(fd, surface, pixelBytes) == (ssize_t)pixelBytes;
+	close(fd);
+
+	if (!written || rename(tempPath, cachePath) != 0)
+	{
+		DEBUG("Can't write the BMP cache %s\r\n", cachePath);
+		unlink(tempPath);
+	}
+}
+
+/******************************************************************************
+function:	Draw a BMP file into the image
+parameter:
+	path : The BMP file
+info:
+	A BMP that is in the open asset bundle (by file name) is drawn from it.
+	Otherwise the first load converts the BMP to a panel-native surface and
+	caches it as <path>.rgb565. Later loads map the cache and copy it into
+	the image.
+	The cache is used while the BMP keeps its size and mtime; when only the
+	mtime changed (a copy, a touch) the BMP's hash decides, and a match
+	refreshes the cached mtime
+******************************************************************************/
+UBYTE GUI_ReadBmp(const char *path)
+{
+	const char *name = strrchr(path, '/');
+	if (GUI_DrawBundleImage(name ? name + 1 : path) == 0)
+		return 0;
+
+	struct stat sourceStat;
+	if (stat(path, &sourceStat) != 0)
+	{
+		DEBUG("Can't open the file!\n");
+		printf("Can't open the file!");
+		return 0;
+	}
+
+	// A path too long for the suffix is drawn without a cache
+	char cachePath[PATH_MAX];
+	int length = snprintf(cachePath, sizeof(cachePath), "%s" BMP_CACHE_SUFFIX, path);
+	bool cacheable = length >= 0 && (size_t)length < sizeof(cachePath);
+
+	size_t sourceSize = 0;
+	const UBYTE *source = NULL;
+	uint64_t sourceHash = 0;
+
+	size_t cacheSize = 0;
+	const UBYTE *cache = cacheable ? GUI_MapFile(cachePath, &cacheSize, NULL) : NULL;
+	if (cache)
+	{
+		BMPCACHEHEADER header = {};
+		if (cacheSize >= sizeof(header))
+			memcpy(&header, cache, sizeof(header));
+		bool valid = header.bMagic == BMP_CACHE_MAGIC &&
+					 header.bVersion == BMP_CACHE_VERSION &&
+					 cacheSize == sizeof(header) + (size_t)header.bWidth * header.bHeight * sizeof(UWORD) &&
+					 header.bSourceSize == (uint64_t)sourceStat.st_size;
+
+		if (valid && header.bSourceMtime != GUI_Mtime(&sourceStat))
+		{
+			source = GUI_MapFile(path, &sourceSize, &sourceStat);
+			sourceHash = source ? GUI_HashBmp(source, sourceSize) : 0;
+			valid = source && sourceHash == header.bSourceHash;
+			if (valid)
+			{
+				// Same content, remember the new mtime
+				header.bSourceMtime = GUI_Mtime(&sourceStat);
+				int fd = open(cachePath, O_WRONLY);
+				if (fd >= 0)
 				{
-					if (bmpInfoHeader.bBitCount == 1)
-					{
-						data = (pixels << temp) >> 7;
-						data &= 0x01;
-					}
-					else if (bmpInfoHeader.bBitCount == 4)
-					{
-						data = (pixels << (temp * 4)) >> 4;
-						data &= 0x0f;
-					}
-					else
-					{
-						data = pixels;
-					}
-					data = RGB((RGBPAD[data].rgbRed), (RGBPAD[data].rgbGreen), (RGBPAD[data].rgbBlue));
-					Paint_SetPixel(col, bmpInfoHeader.bHeight - row - 1, data);
+					if (pwrite(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header))
+						DEBUG("Can't update the BMP cache %s\r\n", cachePath);
+					close(fd);
 				}
 			}
 		}
-		// indent!4 byte alignment
-		fseek(fp, indent, SEEK_CUR);
+
+		if (valid)
+			GUI_DrawSurface((const UWORD *)(cache + sizeof(header)), header.bWidth, header.bHeight);
+		munmap((void *)cache, cacheSize);
+		if (valid)
+		{
+			if (source)
+				munmap((void *)source, sourceSize);
+			return 0;
+		}
 	}
 
-	fclose(fp);
+	if (source == NULL)
+	{
+		source = GUI_MapFile(path, &sourceSize, &sourceStat);
+		if (source == NULL)
+		{
+			DEBUG("Can't open the file!\n");
+			printf("Can't open the file!");
+			return 0;
+		}
+		sourceHash = GUI_HashBmp(source, sourceSize);
+	}
+
+	UDOUBLE width, height;
+	UWORD *surface = GUI_ConvertBmp(source, sourceSize, &width, &height);
+	munmap((void *)source, sourceSize);
+	if (surface == NULL)
+		return 0;
+
+	BMPCACHEHEADER header = {BMP_CACHE_MAGIC, BMP_CACHE_VERSION, width, height, GUI_Mtime(&sourceStat), (uint64_t)sourceSize, sourceHash};
+
+	GUI_DrawSurface(surface, header.bWidth, header.bHeight);
+	if (cacheable)
+		GUI_WriteBmpCache(cachePath, &header, surface);
+	free(surface);
 	return 0;
-}
\ No newline at end of file
+}
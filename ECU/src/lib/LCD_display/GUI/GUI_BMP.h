@@ -68,5 +68,24 @@ typedef struct ARGB_QUAD
 } __attribute__((packed)) ARGBQUAD;
 /**************************************** end ***********************************************/
 
+/*Pre-converted surface, cached next to the BMP as <path>.rgb565. The header is
+followed by bWidth * bHeight panel-native (byte-swapped) RGB565 pixels, top row
+first. It is valid while the BMP keeps its size and either its mtime or hash*/
+#define BMP_CACHE_SUFFIX ".rgb565"
+#define BMP_CACHE_MAGIC 0x35363552 // "R565"
+#define BMP_CACHE_VERSION 1
+
+typedef struct BMP_CACHE_HEADER
+{
+    UDOUBLE bMagic;       // BMP_CACHE_MAGIC
+    UDOUBLE bVersion;     // BMP_CACHE_VERSION
+    UDOUBLE bWidth;       // Width of the surface
+    UDOUBLE bHeight;      // Height of the surface
+    int64_t bSourceMtime; // Modification time of the BMP, in nanoseconds
+    uint64_t bSourceSize; // Size of the BMP
+    uint64_t bSourceHash; // FNV-1a hash of the BMP
+} __attribute__((packed)) BMPCACHEHEADER; // 40bit
+
+void GUI_DrawSurface(const UWORD *surface, UDOUBLE width, UDOUBLE height);
 UBYTE GUI_ReadBmp(const char *path);
 #endif
\ No newline at end of file
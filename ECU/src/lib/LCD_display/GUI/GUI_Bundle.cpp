@@ -0,0 +1,288 @@
+/*****************************************************************************
+ * | File      	:   GUI_Bundle.c
+ * | Function    :   Fonts and images from a memory-mapped asset bundle
+ * | Info        :
+ *                With USE_ASSET_BUNDLE the fonts of fonts.h are not compiled
+ *                in; their tables point into the bundle once it is open
+ *
+ ******************************************************************************/
+#include "GUI_Bundle.h"
+#include "GUI_BMP.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h> //malloc
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static struct
+{
+	const UBYTE *Data;
+	size_t Size;
+	const BUNDLEENTRY *Index;
+	UDOUBLE Count;
+} Bundle;
+
+#ifdef USE_ASSET_BUNDLE
+sFONT Font48;
+sFONT Font24;
+sFONT Font20;
+sFONT Font16;
+sFONT Font12;
+sFONT Font8;
+sFONT LiberationSansNarrow_Bold16;
+sFONT LiberationSansNarrow_Bold24;
+sFONT LiberationSansNarrow_Bold28;
+sFONT LiberationSansNarrow_Bold30;
+sFONT LiberationSansNarrow_Bold36;
+sFONT LiberationSansNarrow_Bold48;
+sFONT LiberationSansNarrow_Bold54;
+sFONT LiberationSansNarrow_Bold60;
+sFONT LiberationSansNarrow_Bold72;
+sFONT LiberationSansNarrow_Bold80;
+
+#define BUNDLE_SYMBOL(font) {#font, &font}
+static const struct
+{
+	const char *Name;
+	sFONT *Font;
+} BundleFonts[] = {
+	BUNDLE_SYMBOL(Font48),
+	BUNDLE_SYMBOL(Font24),
+	BUNDLE_SYMBOL(Font20),
+	BUNDLE_SYMBOL(Font16),
+	BUNDLE_SYMBOL(Font12),
+	BUNDLE_SYMBOL(Font8),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold16),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold24),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold28),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold30),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold36),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold48),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold54),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold60),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold72),
+	BUNDLE_SYMBOL(LiberationSansNarrow_Bold80),
+};
+#endif
+
+/******************************************************************************
+function:	Check an index entry against the file it came from
+parameter:
+	entry : The entry
+	size  : Size of the bundle
+return:	1 if the entry can be used
+******************************************************************************/
+static UBYTE GUI_CheckBundleEntry(const BUNDLEENTRY *entry, size_t size)
+{
+	if (memchr(entry->bName, '\0', BUNDLE_NAME_MAX) == NULL ||
+		entry->bOffset % sizeof(UWORD) != 0 ||
+		entry->bOffset > size || entry->bSize > size - entry->bOffset)
+		return 0;
+
+	if (entry->bType == BUNDLE_FONT)
+	{
+		UDOUBLE rowBytes = entry->bWidth / 8 + (entry->bWidth % 8 ? 1 : 0);
+		return entry->bCompression == BUNDLE_RAW &&
+			   entry->bSize >= (UDOUBLE)BUNDLE_FONT_CHARS * entry->bHeight * rowBytes;
+	}
+	if (entry->bType == BUNDLE_IMAGE)
+	{
+		return entry->bRawSize == (UDOUBLE)entry->bWidth * entry->bHeight * sizeof(UWORD) &&
+			   (entry->bCompression == BUNDLE_RLE ||
+				(entry->bCompression == BUNDLE_RAW && entry->bSize == entry->bRawSize));
+	}
+	return 0;
+}
+
+static const BUNDLEENTRY *GUI_FindBundleEntry(const char *name, UWORD type)
+{
+	for (UDOUBLE i = 0; i < Bundle.Count; i++)
+	{
+		const BUNDLEENTRY *entry = &Bundle.Index[i];
+		if (entry->bType == type && strcmp(entry->bName, name) == 0)
+			return entry;
+	}
+	return NULL;
+}
+
+/******************************************************************************
+function:	Unpack RGB565 run-length packets
+parameter:
+	src     : The packets
+	srcSize : Size of the packets
+	dst     : Where the pixels go
+	count   : Number of pixels expected
+return:	0 if exactly count pixels were unpacked
+info:
+	A control byte holds the packet length - 1 in its low 7 bits. With the
+	top bit set one colour follows for the whole run, otherwise one colour
+	per pixel. Colours are stored high byte first, as the panel takes them
+******************************************************************************/
+static UBYTE GUI_UnpackRle(const UBYTE *src, UDOUBLE srcSize, UWORD *dst, UDOUBLE count)
+{
+	UDOUBLE in = 0, out = 0;
+	while (in < srcSize && out < count)
+	{
+		UBYTE control = src[in++];
+		UDOUBLE length = (control & 0x7F) + 1;
+		UDOUBLE bytes = control & 0x80 ? sizeof(UWORD) : length * sizeof(UWORD);
+		if (length > count - out || bytes > srcSize - in)
+			return 1;
+
+		if (control & 0x80)
+		{
+			UWORD color;
+			memcpy(&color, src + in, sizeof(UWORD));
+			for (UDOUBLE i = 0; i < length; i++)
+				dst[out + i] = color;
+		}
+		else
+		{
+			memcpy(dst + out, src + in, bytes);
+		}
+		in += bytes;
+		out += length;
+	}
+	return out == count ? 0 : 1;
+}
+
+/******************************************************************************
+function:	Map an asset bundle
+parameter:
+	path : The bundle
+return:	0 on success, 1 if it can't be opened or is not a valid bundle
+info:
+	Meant to be called before the processes are forked, they then all share
+	the one mapping. With USE_ASSET_BUNDLE it also fails when a font of
+	fonts.h is missing
+******************************************************************************/
+UBYTE GUI_OpenBundle(const char *path)
+{
+	GUI_CloseBundle();
+
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		DEBUG("Can't open the asset bundle %s\r\n", path);
+		return 1;
+	}
+
+	struct stat bundleStat;
+	if (fstat(fd, &bundleStat) != 0 || (size_t)bundleStat.st_size < sizeof(BUNDLEHEADER))
+	{
+		DEBUG("Not an asset bundle: %s\r\n", path);
+		close(fd);
+		return 1;
+	}
+
+	size_t size = bundleStat.st_size;
+	void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		DEBUG("Can't map the asset bundle %s\r\n", path);
+		return 1;
+	}
+
+	const BUNDLEHEADER *header = (const BUNDLEHEADER *)data;
+	const BUNDLEENTRY *index = (const BUNDLEENTRY *)(header + 1);
+	UBYTE valid = header->bMagic == BUNDLE_MAGIC && header->bVersion == BUNDLE_VERSION &&
+				  header->bSize == size &&
+				  header->bCount <= (size - sizeof(BUNDLEHEADER)) / sizeof(BUNDLEENTRY);
+	for (UDOUBLE i = 0; valid && i < header->bCount; i++)
+		valid = GUI_CheckBundleEntry(&index[i], size);
+	if (!valid)
+	{
+		DEBUG("Not an asset bundle: %s\r\n", path);
+		munmap(data, size);
+		return 1;
+	}
+
+	Bundle.Data = (const UBYTE *)data;
+	Bundle.Size = size;
+	Bundle.Index = index;
+	Bundle.Count = header->bCount;
+
+#ifdef USE_ASSET_BUNDLE
+	for (size_t i = 0; i < sizeof(BundleFonts) / sizeof(BundleFonts[0]); i++)
+	{
+		if (GUI_BundleFont(BundleFonts[i].Name, BundleFonts[i].Font) != 0)
+		{
+			DEBUG("%s is not in the asset bundle\r\n", BundleFonts[i].Name);
+			GUI_CloseBundle();
+			return 1;
+		}
+	}
+#endif
+	return 0;
+}
+
+void GUI_CloseBundle(void)
+{
+	if (Bundle.Data == NULL)
+		return;
+
+#ifdef USE_ASSET_BUNDLE
+	for (size_t i = 0; i < sizeof(BundleFonts) / sizeof(BundleFonts[0]); i++)
+		memset(BundleFonts[i].Font, 0, sizeof(sFONT));
+#endif
+	munmap((void *)Bundle.Data, Bundle.Size);
+	Bundle.Data = NULL;
+	Bundle.Size = 0;
+	Bundle.Index = NULL;
+	Bundle.Count = 0;
+}
+
+/******************************************************************************
+function:	Look up a font in the open bundle
+parameter:
+	name : sFONT symbol the font was generated from, e.g. "Font24"
+	font : Set to the font, its table points into the bundle
+return:	0 on success, 1 if the font is not there
+******************************************************************************/
+UBYTE GUI_BundleFont(const char *name, sFONT *font)
+{
+	const BUNDLEENTRY *entry = GUI_FindBundleEntry(name, BUNDLE_FONT);
+	if (entry == NULL)
+		return 1;
+
+	font->table = Bundle.Data + entry->bOffset;
+	font->Width = entry->bWidth;
+	font->Height = entry->bHeight;
+	return 0;
+}
+
+/******************************************************************************
+function:	Draw an image of the open bundle at the top left of the image
+parameter:
+	name : File name of the BMP it was generated from, e.g. "torino_logo.bmp"
+return:	0 on success, 1 if the image is not there
+info:
+	Raw images are copied straight out of the mapping, run-length coded
+	ones are unpacked first
+******************************************************************************/
+UBYTE GUI_DrawBundleImage(const char *name)
+{
+	const BUNDLEENTRY *entry = GUI_FindBundleEntry(name, BUNDLE_IMAGE);
+	if (entry == NULL)
+		return 1;
+
+	const UBYTE *data = Bundle.Data + entry->bOffset;
+	if (entry->bCompression == BUNDLE_RAW)
+	{
+		GUI_DrawSurface((const UWORD *)data, entry->bWidth, entry->bHeight);
+		return 0;
+	}
+
+	UWORD *surface = (UWORD *)malloc(entry->bRawSize);
+	if (surface == NULL)
+		return 1;
+	UBYTE result = GUI_UnpackRle(data, entry->bSize, surface, (UDOUBLE)entry->bWidth * entry->bHeight);
+	if (result == 0)
+		GUI_DrawSurface(surface, entry->bWidth, entry->bHeight);
+	else
+		DEBUG("Corrupt image %s in the asset bundle\r\n", name);
+	free(surface);
+	return result;
+}
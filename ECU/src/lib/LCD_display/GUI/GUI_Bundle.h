@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * | File      	:   GUI_Bundle.h
+ * | Function    :   Fonts and images from a memory-mapped asset bundle
+ * | Info        :
+ *                The bundle is generated on the host by tools/asset_bundle.py
+ *                and mapped read-only, so its pages are loaded on first use
+ *                and shared by every process that maps it
+ *
+ ******************************************************************************/
+#ifndef __GUI_BUNDLE_H
+#define __GUI_BUNDLE_H
+
+#include <stdint.h>
+
+#include "GUI_Paint.h"
+#include "fonts.h"
+
+#define BUNDLE_MAGIC 0x444E4254 // "TBND"
+#define BUNDLE_VERSION 1
+#define BUNDLE_NAME_MAX 32
+// Fonts are stored with the glyphs from ' ' to '~'
+#define BUNDLE_FONT_CHARS 95
+
+typedef enum
+{
+    BUNDLE_FONT = 0,
+    BUNDLE_IMAGE,
+} BUNDLE_TYPE;
+
+typedef enum
+{
+    BUNDLE_RAW = 0, // Stored as is
+    BUNDLE_RLE,     // RGB565 run-length packets, see tools/image_pack.py
+} BUNDLE_COMPRESSION;
+
+/*Bundle header 16bit, followed by bCount index entries*/
+typedef struct BUNDLE_HEADER
+{
+    UDOUBLE bMagic;   // BUNDLE_MAGIC
+    UDOUBLE bVersion; // BUNDLE_VERSION
+    UDOUBLE bCount;   // Number of assets
+    UDOUBLE bSize;    // Size of the whole file
+} __attribute__((packed)) BUNDLEHEADER;
+
+/*Index entry 64bit. Sections start on a page boundary, so an image's pixels
+can be copied straight out of the mapping*/
+typedef struct BUNDLE_ENTRY
+{
+    char bName[BUNDLE_NAME_MAX]; // sFONT symbol, or BMP file name
+    UWORD bType;                 // BUNDLE_TYPE
+    UWORD bCompression;          // BUNDLE_COMPRESSION
+    UWORD bWidth;                // Glyph or image width
+    UWORD bHeight;               // Glyph or image height
+    UDOUBLE bOffset;             // Start of the data, from the start of the file
+    UDOUBLE bSize;               // Stored size of the data
+    UDOUBLE bRawSize;            // Size once unpacked: 1 bit glyph rows, or panel-native RGB565 rows
+    UBYTE bReserved[12];
+} __attribute__((packed)) BUNDLEENTRY;
+
+UBYTE GUI_OpenBundle(const char *path);
+void GUI_CloseBundle(void);
+UBYTE GUI_BundleFont(const char *name, sFONT *font);
+UBYTE GUI_DrawBundleImage(const char *name);
+#endif
@@ -40,8 +40,15 @@
 #include <stdlib.h>
 #include <string.h> //memset()
 #include <math.h>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 PAINT Paint;
+static PAINT_DAMAGE Paint_Damage;
+
+static inline int Paint_Min(int A, int B) { return A < B ? A : B; }
+static inline int Paint_Max(int A, int B) { return A > B ? A : B; }
 
 /******************************************************************************
 function: Create Image
@@ -67,6 +74,7 @@ void Paint_NewImage(UWORD *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD
 
     Paint.Rotate = Rotate;
     Paint.Mirror = MIRROR_NONE;
+    Paint.Background = NULL;
 
     if (Rotate == ROTATE_0 || Rotate == ROTATE_180)
     {
@@ -78,6 +86,8 @@ void Paint_NewImage(UWORD *image, UWORD Width, UWORD Height, UWORD Rotate, UWORD
         Paint.Width = Height;
         Paint.Height = Width;
     }
+
+    Paint_ClearDamage();
 }
 
 /******************************************************************************
@@ -128,6 +138,95 @@ void Paint_SetMirroring(UBYTE mirror)
     }
 }
 
+/******************************************************************************
+function: Record a damaged area of the image
+parameter:
+    Xstart : x starting point in memory
+    Ystart : Y starting point in memory
+    Xend   : x end point (exclusive)
+    Yend   : y end point (exclusive)
+info:
+    Merges the area into every rectangle it overlaps or nearly touches,
+    since a window costs about PAINT_DAMAGE_SLACK pixels of commands. When
+    the list is full it grows the rectangle that grows the least.
+******************************************************************************/
+#define PAINT_DAMAGE_SLACK 64
+
+static long Paint_RectArea(const PAINT_RECT *Rect)
+{
+    return (long)(Rect->Xend - Rect->Xstart) * (Rect->Yend - Rect->Ystart);
+}
+
+static PAINT_RECT Paint_RectUnion(const PAINT_RECT *A, const PAINT_RECT *B)
+{
+    PAINT_RECT Union = {
+        (UWORD)Paint_Min(A->Xstart, B->Xstart), (UWORD)Paint_Min(A->Ystart, B->Ystart),
+        (UWORD)Paint_Max(A->Xend, B->Xend), (UWORD)Paint_Max(A->Yend, B->Yend)};
+    return Union;
+}
+
+void Paint_AddDamage(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
+{
+    PAINT_RECT Rect = {Xstart, Ystart, (UWORD)Paint_Min(Xend, Paint.WidthMemory), (UWORD)Paint_Min(Yend, Paint.HeightMemory)};
+    if (Rect.Xstart >= Rect.Xend || Rect.Ystart >= Rect.Yend)
+        return;
+
+    // Already covered, the common case for pixel by pixel drawing
+    for (UBYTE i = 0; i < Paint_Damage.Count; i++)
+    {
+        const PAINT_RECT *Old = &Paint_Damage.Rect[i];
+        if (Rect.Xstart >= Old->Xstart && Rect.Ystart >= Old->Ystart && Rect.Xend <= Old->Xend && Rect.Yend <= Old->Yend)
+            return;
+    }
+
+    for (;;)
+    {
+        int Merge = -1;
+        long Best_Growth = 0;
+        for (UBYTE i = 0; i < Paint_Damage.Count; i++)
+        {
+            PAINT_RECT Union = Paint_RectUnion(&Rect, &Paint_Damage.Rect[i]);
+            long Waste = Paint_RectArea(&Union) - Paint_RectArea(&Rect) - Paint_RectArea(&Paint_Damage.Rect[i]);
+            if (Waste <= PAINT_DAMAGE_SLACK)
+            {
+                Merge = i;
+                break;
+            }
+
+            long Growth = Paint_RectArea(&Union) - Paint_RectArea(&Paint_Damage.Rect[i]);
+            if (Paint_Damage.Count == PAINT_DAMAGE_MAX && (Merge < 0 || Growth < Best_Growth))
+            {
+                Merge = i;
+                Best_Growth = Growth;
+            }
+        }
+        if (Merge < 0)
+            break;
+
+        // Take the rectangle out of the list and try again with the union
+        Rect = Paint_RectUnion(&Rect, &Paint_Damage.Rect[Merge]);
+        Paint_Damage.Rect[Merge] = Paint_Damage.Rect[--Paint_Damage.Count];
+    }
+
+    Paint_Damage.Rect[Paint_Damage.Count++] = Rect;
+}
+
+/******************************************************************************
+function: Damaged areas since the last Paint_ClearDamage
+******************************************************************************/
+const PAINT_DAMAGE *Paint_GetDamage(void)
+{
+    return &Paint_Damage;
+}
+
+/******************************************************************************
+function: Forget the damage, once it has been sent to the display
+******************************************************************************/
+void Paint_ClearDamage(void)
+{
+    Paint_Damage.Count = 0;
+}
+
 /******************************************************************************
 function: Draw Pixels
 parameter:
@@ -190,6 +289,7 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
         return;
     }
 
+    Paint_AddDamage(X, Y, X + 1, Y + 1);
     if (Paint.Depth == 1)
     {
         UDOUBLE Addr = X / 8 + Y * Paint.WidthByte;
@@ -208,22 +308,403 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color)
 }
 
 /******************************************************************************
-function: Clear the color of the picture
+function: Fill 16-bit words with one value
 parameter:
-    Color : Painted colors
+    Dst   : First word
+    Count : Number of words
+    Value : Value stored as is (no byte swap)
+info:
+    Eight words per NEON store where the compiler targets NEON (Pi 3)
 ******************************************************************************/
-void Paint_Clear(UWORD Color)
+static inline void Paint_FillWords(UWORD *Dst, UDOUBLE Count, UWORD Value)
 {
-    for (UWORD Y = 0; Y < Paint.HeightByte; Y++)
+#if defined(__ARM_NEON)
+    uint16x8_t Vector = vdupq_n_u16(Value);
+    for (; Count >= 32; Count -= 32, Dst += 32)
     {
-        for (UWORD X = 0; X < Paint.WidthByte; X++)
-        { // 8 pixel =  1 byte
-            UDOUBLE Addr = X + Y * Paint.WidthByte;
-            Paint.Image[Addr] = Color;
+        vst1q_u16(Dst, Vector);
+        vst1q_u16(Dst + 8, Vector);
+        vst1q_u16(Dst + 16, Vector);
+        vst1q_u16(Dst + 24, Vector);
+    }
+    for (; Count >= 8; Count -= 8, Dst += 8)
+        vst1q_u16(Dst, Vector);
+#endif
+    while (Count--)
+        *Dst++ = Value;
+}
+
+/******************************************************************************
+Span writers
+
+Paint_SetPixel works out the rotation and mirroring for every pixel. The
+writers below resolve both once per call instead: PaintRotation maps a logical
+point to its memory column/row and gives the direction memory moves in when
+the logical x or y grows, PaintWriter adds the mirroring on top. A logical
+rectangle is then a memory rectangle, filled row by row, and a logical span is
+a start address plus a fixed step. Coordinates reaching the writers are
+already clipped to Width() x Height().
+******************************************************************************/
+template <UWORD Rotate>
+struct PaintRotation;
+
+template <>
+struct PaintRotation<ROTATE_0>
+{
+    static int X(int Xpoint, int Ypoint) { return Xpoint; }
+    static int Y(int Xpoint, int Ypoint) { return Ypoint; }
+    static constexpr int DX_x = 1, DY_x = 0;
+    static constexpr bool Swapped = false;
+};
+
+template <>
+struct PaintRotation<ROTATE_90>
+{
+    static int X(int Xpoint, int Ypoint) { return Paint.WidthMemory - Ypoint - 1; }
+    static int Y(int Xpoint, int Ypoint) { return Xpoint; }
+    static constexpr int DX_x = 0, DY_x = 1;
+    static constexpr bool Swapped = true;
+};
+
+template <>
+struct PaintRotation<ROTATE_180>
+{
+    static int X(int Xpoint, int Ypoint) { return Paint.WidthMemory - Xpoint - 1; }
+    static int Y(int Xpoint, int Ypoint) { return Paint.HeightMemory - Ypoint - 1; }
+    static constexpr int DX_x = -1, DY_x = 0;
+    static constexpr bool Swapped = false;
+};
+
+template <>
+struct PaintRotation<ROTATE_270>
+{
+    static int X(int Xpoint, int Ypoint) { return Ypoint; }
+    static int Y(int Xpoint, int Ypoint) { return Paint.HeightMemory - Xpoint - 1; }
+    static constexpr int DX_x = 0, DY_x = -1;
+    static constexpr bool Swapped = true;
+};
+
+template <UWORD Rotate, UWORD Mirror>
+struct PaintWriter
+{
+    typedef PaintRotation<Rotate> R;
+    static constexpr bool MirrorX = Mirror & MIRROR_HORIZONTAL;
+    static constexpr bool MirrorY = Mirror & MIRROR_VERTICAL;
+    // Memory step of one logical x, +-1 when logical rows are memory rows
+    static constexpr int DX_x = MirrorX ? -R::DX_x : R::DX_x;
+    static constexpr int DY_x = MirrorY ? -R::DY_x : R::DY_x;
+
+    static int Width() { return Paint_Min(Paint.Width, R::Swapped ? Paint.HeightMemory : Paint.WidthMemory); }
+    static int Height() { return Paint_Min(Paint.Height, R::Swapped ? Paint.WidthMemory : Paint.HeightMemory); }
+
+    static int MemoryX(int Xpoint, int Ypoint)
+    {
+        int X = R::X(Xpoint, Ypoint);
+        return MirrorX ? Paint.WidthMemory - X - 1 : X;
+    }
+
+    static int MemoryY(int Xpoint, int Ypoint)
+    {
+        int Y = R::Y(Xpoint, Ypoint);
+        return MirrorY ? Paint.HeightMemory - Y - 1 : Y;
+    }
+
+    // Memory rectangle (inclusive) of logical [Xstart, Xend) x [Ystart, Yend)
+    static void MemoryRect(int Xstart, int Ystart, int Xend, int Yend, int &X0, int &Y0, int &X1, int &Y1)
+    {
+        X0 = MemoryX(Xstart, Ystart);
+        X1 = MemoryX(Xend - 1, Yend - 1);
+        Y0 = MemoryY(Xstart, Ystart);
+        Y1 = MemoryY(Xend - 1, Yend - 1);
+        if (X0 > X1)
+        {
+            int T = X0;
+            X0 = X1;
+            X1 = T;
+        }
+        if (Y0 > Y1)
+        {
+            int T = Y0;
+            Y0 = Y1;
+            Y1 = T;
+        }
+    }
+
+    static void Damage(int Xstart, int Ystart, int Xend, int Yend)
+    {
+        int X0, Y0, X1, Y1;
+        MemoryRect(Xstart, Ystart, Xend, Yend, X0, Y0, X1, Y1);
+        Paint_AddDamage(X0, Y0, X1 + 1, Y1 + 1);
+    }
+
+    // Logical [Xstart, Xend) x [Ystart, Yend)
+    static void FillRect(int Xstart, int Ystart, int Xend, int Yend, UWORD Color)
+    {
+        int X0, Y0, X1, Y1;
+        MemoryRect(Xstart, Ystart, Xend, Yend, X0, Y0, X1, Y1);
+        Paint_AddDamage(X0, Y0, X1 + 1, Y1 + 1);
+
+        UWORD *Row = Paint.Image + X0 + (UDOUBLE)Y0 * Paint.WidthByte;
+        for (int Y = Y0; Y <= Y1; Y++, Row += Paint.WidthByte)
+            Paint_FillWords(Row, X1 - X0 + 1, Prepare(Color));
+    }
+
+    // Copy logical [Xstart, Xend) x [Ystart, Yend) back from the background layer
+    static void Restore(int Xstart, int Ystart, int Xend, int Yend)
+    {
+        int X0, Y0, X1, Y1;
+        MemoryRect(Xstart, Ystart, Xend, Yend, X0, Y0, X1, Y1);
+        Paint_AddDamage(X0, Y0, X1 + 1, Y1 + 1);
+
+        UDOUBLE Offset = X0 + (UDOUBLE)Y0 * Paint.WidthByte;
+        for (int Y = Y0; Y <= Y1; Y++, Offset += Paint.WidthByte)
+            memcpy(Paint.Image + Offset, Paint.Background + Offset, (X1 - X0 + 1) * sizeof(UWORD));
+    }
+
+    // Logical [Xstart, Xstart + Length) on row Ypoint, Color already swapped
+    static void Span(int Xstart, int Ypoint, int Length, UWORD Swapped)
+    {
+        UWORD *Dst = Paint.Image + MemoryX(Xstart, Ypoint) + (UDOUBLE)MemoryY(Xstart, Ypoint) * Paint.WidthByte;
+        if (DX_x == 1)
+        {
+            Paint_FillWords(Dst, Length, Swapped);
+        }
+        else if (DX_x == -1)
+        {
+            Paint_FillWords(Dst - Length + 1, Length, Swapped);
+        }
+        else
+        {
+            long Step = (long)DY_x * Paint.WidthByte;
+            for (; Length > 0; Length--, Dst += Step)
+                *Dst = Swapped;
+        }
+    }
+
+    static UWORD Prepare(UWORD Color) { return ((Color << 8) & 0xff00) | (Color >> 8); }
+};
+
+// Depth 1 images keep going through Paint_SetPixel
+struct PaintPixelWriter
+{
+    static int Width() { return Paint.Width; }
+    static int Height() { return Paint.Height; }
+
+    // Paint_SetPixel records its own damage
+    static void Damage(int Xstart, int Ystart, int Xend, int Yend) {}
+
+    static void FillRect(int Xstart, int Ystart, int Xend, int Yend, UWORD Color)
+    {
+        for (int Y = Ystart; Y < Yend; Y++)
+            for (int X = Xstart; X < Xend; X++)
+                Paint_SetPixel(X, Y, Color);
+    }
+
+    static void Span(int Xstart, int Ypoint, int Length, UWORD Color)
+    {
+        for (int X = Xstart; X < Xstart + Length; X++)
+            Paint_SetPixel(X, Ypoint, Color);
+    }
+
+    // Depth 1 images have no background layer
+    static void Restore(int Xstart, int Ystart, int Xend, int Yend) {}
+
+    static UWORD Prepare(UWORD Color) { return Color; }
+};
+
+/******************************************************************************
+function: Run a writer call for the current rotation and mirroring
+parameter:
+    Fn : Called with a PaintWriter (or PaintPixelWriter) instance
+******************************************************************************/
+template <UWORD Rotate, typename Fn>
+static void Paint_WithMirror(Fn &&Fn_Writer)
+{
+    switch (Paint.Mirror)
+    {
+    case MIRROR_NONE:
+        Fn_Writer(PaintWriter<Rotate, MIRROR_NONE>());
+        break;
+    case MIRROR_HORIZONTAL:
+        Fn_Writer(PaintWriter<Rotate, MIRROR_HORIZONTAL>());
+        break;
+    case MIRROR_VERTICAL:
+        Fn_Writer(PaintWriter<Rotate, MIRROR_VERTICAL>());
+        break;
+    case MIRROR_ORIGIN:
+        Fn_Writer(PaintWriter<Rotate, MIRROR_ORIGIN>());
+        break;
+    }
+}
+
+template <typename Fn>
+static void Paint_WithWriter(Fn &&Fn_Writer)
+{
+    if (Paint.Depth == 1)
+    {
+        Fn_Writer(PaintPixelWriter());
+        return;
+    }
+
+    switch (Paint.Rotate)
+    {
+    case ROTATE_0:
+        Paint_WithMirror<ROTATE_0>(Fn_Writer);
+        break;
+    case ROTATE_90:
+        Paint_WithMirror<ROTATE_90>(Fn_Writer);
+        break;
+    case ROTATE_180:
+        Paint_WithMirror<ROTATE_180>(Fn_Writer);
+        break;
+    case ROTATE_270:
+        Paint_WithMirror<ROTATE_270>(Fn_Writer);
+        break;
+    }
+}
+
+/******************************************************************************
+function: Fill a rectangle through the span writers
+parameter:
+    Xstart : x starting point
+    Ystart : Y starting point
+    Xend   : x end point (exclusive)
+    Yend   : y end point (exclusive)
+    Color  : Painted colors
+info:
+    Clips to the image, so the corners may lie outside of it
+******************************************************************************/
+static void Paint_FillArea(int Xstart, int Ystart, int Xend, int Yend, UWORD Color)
+{
+    Paint_WithWriter([&](auto Writer)
+                     {
+        int X0 = Paint_Max(Xstart, 0), Y0 = Paint_Max(Ystart, 0);
+        int X1 = Paint_Min(Xend, Writer.Width()), Y1 = Paint_Min(Yend, Writer.Height());
+        if (X0 < X1 && Y0 < Y1)
+            Writer.FillRect(X0, Y0, X1, Y1, Color); });
+}
+
+/******************************************************************************
+function: Fill the dots of Paint_DrawPoint(DOT_FILL_AROUND) for every point
+          of an axis-aligned segment or box in one rectangle
+parameter:
+    Xstart, Ystart : First point (inclusive)
+    Xend, Yend     : Last point (inclusive)
+    Color          : Painted colors
+    Dot_Pixel      : point size
+info:
+    A dot covers [X - Dot_Pixel, X + Dot_Pixel - 2] on both axes. Dots whose
+    top row would be above the image are dropped entirely and columns left of
+    it are cut, as Paint_DrawPoint does.
+******************************************************************************/
+static void Paint_FillDots(int Xstart, int Ystart, int Xend, int Yend, UWORD Color, DOT_PIXEL Dot_Pixel)
+{
+    if (Xstart > Xend)
+    {
+        int T = Xstart;
+        Xstart = Xend;
+        Xend = T;
+    }
+    if (Ystart > Yend)
+    {
+        int T = Ystart;
+        Ystart = Yend;
+        Yend = T;
+    }
+
+    Ystart = Paint_Max(Ystart, (int)Dot_Pixel);
+    if (Ystart > Yend)
+        return;
+    Paint_FillArea(Xstart - Dot_Pixel, Ystart - Dot_Pixel, Xend + Dot_Pixel - 1, Yend + Dot_Pixel - 1, Color);
+}
+
+/******************************************************************************
+function: Draw a horizontal span
+parameter:
+    Xstart : x starting point
+    Ypoint : Row
+    Length : Number of pixels
+    Color  : Painted colors
+******************************************************************************/
+void Paint_DrawHSpan(UWORD Xstart, UWORD Ypoint, UWORD Length, UWORD Color)
+{
+    Paint_FillArea(Xstart, Ypoint, Xstart + Length, Ypoint + 1, Color);
+}
+
+/******************************************************************************
+function: Draw a vertical span
+parameter:
+    Xpoint : Column
+    Ystart : Y starting point
+    Length : Number of pixels
+    Color  : Painted colors
+******************************************************************************/
+void Paint_DrawVSpan(UWORD Xpoint, UWORD Ystart, UWORD Length, UWORD Color)
+{
+    Paint_FillArea(Xpoint, Ystart, Xpoint + 1, Ystart + Length, Color);
+}
+
+/******************************************************************************
+function: Draw one character as runs of equal bits
+parameter:
+    Writer           : Span writer of the current rotation
+    Xpoint, Ypoint   : Top left corner
+    Acsii_Char       : To display the English characters
+    Font             : A structure pointer that displays a character size
+    Color_Foreground : Color of set bits
+    Color_Background : Color of clear bits, not drawn if FONT_BACKGROUND
+******************************************************************************/
+template <typename Writer>
+static void Paint_DrawGlyph(Writer, UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
+                            sFONT *Font, UWORD Color_Foreground, UWORD Color_Background)
+{
+    if (Xpoint > Paint.Width || Ypoint > Paint.Height)
+    {
+        DEBUG("Paint_DrawChar Input exceeds the normal display range\r\n");
+        return;
+    }
+
+    UWORD Row_Bytes = Font->Width / 8 + (Font->Width % 8 ? 1 : 0);
+    const unsigned char *ptr = &Font->table[(Acsii_Char - ' ') * Font->Height * Row_Bytes];
+    int Width = Paint_Min(Font->Width, Writer::Width() - Xpoint);
+    int Height = Paint_Min(Font->Height, Writer::Height() - Ypoint);
+
+    // To determine whether the font background color and screen background color is consistent
+    bool Transparent = FONT_BACKGROUND == Color_Background;
+    UWORD Foreground = Writer::Prepare(Color_Foreground);
+    UWORD Background = Writer::Prepare(Color_Background);
+    if (Width > 0 && Height > 0)
+        Writer::Damage(Xpoint, Ypoint, Xpoint + Width, Ypoint + Height);
+
+    for (int Page = 0; Page < Height; Page++, ptr += Row_Bytes)
+    {
+        int Column = 0;
+        while (Column < Width)
+        {
+            int Start = Column;
+            bool Set = ptr[Column / 8] & (0x80 >> (Column % 8));
+            while (++Column < Width && (bool)(ptr[Column / 8] & (0x80 >> (Column % 8))) == Set)
+                ;
+
+            if (Set)
+                Writer::Span(Xpoint + Start, Ypoint + Page, Column - Start, Foreground);
+            else if (!Transparent)
+                Writer::Span(Xpoint + Start, Ypoint + Page, Column - Start, Background);
         }
     }
 }
 
+/******************************************************************************
+function: Clear the color of the picture
+parameter:
+    Color : Painted colors
+******************************************************************************/
+void Paint_Clear(UWORD Color)
+{
+    Paint_FillWords(Paint.Image, (UDOUBLE)Paint.WidthByte * Paint.HeightByte, Color);
+    Paint_AddDamage(0, 0, Paint.WidthMemory, Paint.HeightMemory);
+}
+
 /******************************************************************************
 function: Clear the color of a window
 parameter:
@@ -235,14 +716,7 @@ parameter:
 ******************************************************************************/
 void Paint_ClearWindow(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color)
 {
-    UWORD X, Y;
-    for (Y = Ystart; Y < Yend; Y++)
-    {
-        for (X = Xstart; X < Xend; X++)
-        { // 8 pixel =  1 byte
-            Paint_SetPixel(X, Y, Color);
-        }
-    }
+    Paint_FillArea(Xstart, Ystart, Xend, Yend, Color);
 }
 
 /******************************************************************************
@@ -263,30 +737,13 @@ void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color,
         return;
     }
 
-    int16_t XDir_Num, YDir_Num;
     if (Dot_Style == DOT_FILL_AROUND)
     {
-        for (XDir_Num = 0; XDir_Num < 2 * Dot_Pixel - 1; XDir_Num++)
-        {
-            for (YDir_Num = 0; YDir_Num < 2 * Dot_Pixel - 1; YDir_Num++)
-            {
-                if (Xpoint + XDir_Num - Dot_Pixel < 0 || Ypoint + YDir_Num - Dot_Pixel < 0)
-                    break;
-                // DEBUG("Paint_DrawPoint x:%d y:%d color:0x%x\r\n",Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel,Color);
-                // printf("x = %d, y = %d\r\n", Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel);
-                Paint_SetPixel(Xpoint + XDir_Num - Dot_Pixel, Ypoint + YDir_Num - Dot_Pixel, Color);
-            }
-        }
+        Paint_FillDots(Xpoint, Ypoint, Xpoint, Ypoint, Color, Dot_Pixel);
     }
     else
     {
-        for (XDir_Num = 0; XDir_Num < Dot_Pixel; XDir_Num++)
-        {
-            for (YDir_Num = 0; YDir_Num < Dot_Pixel; YDir_Num++)
-            {
-                Paint_SetPixel(Xpoint + XDir_Num - 1, Ypoint + YDir_Num - 1, Color);
-            }
-        }
+        Paint_FillArea(Xpoint - 1, Ypoint - 1, Xpoint + Dot_Pixel - 1, Ypoint + Dot_Pixel - 1, Color);
     }
 }
 
@@ -311,6 +768,13 @@ void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
         return;
     }
 
+    // Horizontal and vertical solid lines are one rectangle of dots
+    if (Line_Style == LINE_STYLE_SOLID && (Xstart == Xend || Ystart == Yend))
+    {
+        Paint_FillDots(Xstart, Ystart, Xend, Yend, Color, Line_width);
+        return;
+    }
+
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
     int dx = (int)Xend - (int)Xstart >= 0 ? Xend - Xstart : Xstart - Xend;
@@ -378,11 +842,9 @@ void Paint_DrawRectangle(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend,
 
     if (Draw_Fill)
     {
-        UWORD Ypoint;
-        for (Ypoint = Ystart; Ypoint < Yend; Ypoint++)
-        {
-            Paint_DrawLine(Xstart, Ypoint, Xend, Ypoint, Color, Line_width, LINE_STYLE_SOLID);
-        }
+        // The lines of rows [Ystart, Yend) merge into one rectangle
+        if (Ystart < Yend)
+            Paint_FillDots(Xstart, Ystart, Xend, Yend - 1, Color, Line_width);
     }
     else
     {
@@ -485,49 +947,15 @@ parameter:
 void Paint_DrawChar(UWORD Xpoint, UWORD Ypoint, const char Acsii_Char,
                     sFONT *Font, UWORD Color_Foreground, UWORD Color_Background)
 {
-    UWORD Page, Column;
-
-    if (Xpoint > Paint.Width || Ypoint > Paint.Height)
-    {
-        DEBUG("Paint_DrawChar Input exceeds the normal display range\r\n");
-        return;
-    }
-
-    uint32_t Char_Offset = (Acsii_Char - ' ') * Font->Height * (Font->Width / 8 + (Font->Width % 8 ? 1 : 0));
-    const unsigned char *ptr = &Font->table[Char_Offset];
-
-    for (Page = 0; Page < Font->Height; Page++)
-    {
-        for (Column = 0; Column < Font->Width; Column++)
-        {
+    Paint_WithWriter([&](auto Writer)
+                     { Paint_DrawGlyph(Writer, Xpoint, Ypoint, Acsii_Char, Font, Color_Foreground, Color_Background); });
+}
 
-            // To determine whether the font background color and screen background color is consistent
-            if (FONT_BACKGROUND == Color_Background)
-            { // this process is to speed up the scan
-                if (*ptr & (0x80 >> (Column % 8)))
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
-                // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-            }
-            else
-            {
-                if (*ptr & (0x80 >> (Column % 8)))
-                {
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Foreground);
-                    // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Foreground, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                }
-                else
-                {
-                    Paint_SetPixel(Xpoint + Column, Ypoint + Page, Color_Background);
-                    // Paint_DrawPoint(Xpoint + Column, Ypoint + Page, Color_Background, DOT_PIXEL_DFT, DOT_STYLE_DFT);
-                }
-            }
-            // One pixel is 8 bits
-            if (Column % 8 == 7)
-                ptr++;
-        } // Write a line
-        if (Font->Width % 8 != 0)
-            ptr++;
-    } // Write all
+// Step to the next character, '.' and 'I' are set closer
+static inline UWORD Paint_Advance(const char Acsii_Char, sFONT *Font)
+{
+    UWORD nextXpoint = (Acsii_Char == '.' || Acsii_Char == 'I') ? Font->Width * 0.4 : 0;
+    return Font->Width - nextXpoint;
 }
 
 /******************************************************************************
@@ -545,7 +973,6 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char *pString,
 {
     UWORD Xpoint = Xstart;
     UWORD Ypoint = Ystart;
-    UWORD nextXpoint = 0;
 
     if (Xstart > Paint.Width || Ystart > Paint.Height)
     {
@@ -553,38 +980,106 @@ void Paint_DrawString_EN(UWORD Xstart, UWORD Ystart, const char *pString,
         return;
     }
 
-    while (*pString != '\0')
-    {
-        // if X direction filled , reposition to(Xstart,Ypoint),Ypoint is Y direction plus the Height of the character
-        if ((Xpoint + Font->Width) > Paint.Width)
+    // Rotation and mirroring are resolved once for the whole string
+    Paint_WithWriter([&](auto Writer)
+                     {
+        while (*pString != '\0')
         {
-            Xpoint = Xstart;
-            Ypoint += Font->Height;
-        }
+            // if X direction filled , reposition to(Xstart,Ypoint),Ypoint is Y direction plus the Height of the character
+            if ((Xpoint + Font->Width) > Paint.Width)
+            {
+                Xpoint = Xstart;
+                Ypoint += Font->Height;
+            }
 
-        // If the Y direction is full, reposition to(Xstart, Ystart)
-        if ((Ypoint + Font->Height) > Paint.Height)
-        {
-            Xpoint = Xstart;
-            Ypoint = Ystart;
-        }
+            // If the Y direction is full, reposition to(Xstart, Ystart)
+            if ((Ypoint + Font->Height) > Paint.Height)
+            {
+                Xpoint = Xstart;
+                Ypoint = Ystart;
+            }
 
-        Paint_DrawChar(Xpoint, Ypoint, *pString, Font, Color_Background, Color_Foreground);
-        if (*pString == '.' || *pString == 'I')
-        {
-            nextXpoint = Font->Width * 0.4;
-        }
-        else
+            Paint_DrawGlyph(Writer, Xpoint, Ypoint, *pString, Font, Color_Background, Color_Foreground);
+
+            // The next word of the abscissa increases the font of the broadband
+            Xpoint += Paint_Advance(*pString, Font);
+
+            // The next character of the address
+            pString++;
+        } });
+}
+
+/******************************************************************************
+function: Set the background layer
+parameter:
+    Background : Image-sized copy of the image, same layout. NULL drops it
+info:
+    Paint_NewImage drops it as well
+******************************************************************************/
+void Paint_SetBackground(const UWORD *Background)
+{
+    Paint.Background = Background;
+}
+
+/******************************************************************************
+function: Copy an area of the background layer back into the image
+parameter:
+    Xstart : x starting point
+    Ystart : Y starting point
+    Xend   : x end point (exclusive)
+    Yend   : y end point (exclusive)
+info:
+    One memcpy per image row the area covers. Does nothing without a
+    background layer
+******************************************************************************/
+void Paint_RestoreBackground(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
+{
+    if (Paint.Background == NULL)
+        return;
+
+    Paint_WithWriter([&](auto Writer)
+                     {
+        int X1 = Paint_Min(Xend, Writer.Width()), Y1 = Paint_Min(Yend, Writer.Height());
+        if (Xstart < X1 && Ystart < Y1)
+            Writer.Restore(Xstart, Ystart, X1, Y1); });
+}
+
+/******************************************************************************
+function: Replace a string drawn over the background layer
+parameter:
+    Xstart           ：X coordinate
+    Ystart           ：Y coordinate
+    pString          ：The new string, on one line
+    Font             ：A structure pointer that displays a character size
+    Color_Foreground : Color of the characters
+    Area             : Box of the previous string, restored from the background
+                       layer first. Set to the box of the new one; start with
+                       an empty box ({0, 0, 0, 0})
+info:
+    Only the set bits of the characters are drawn, the background shows
+    through the rest of the box. Pixels outside the old box already show
+    the background, so nothing else is copied.
+******************************************************************************/
+void Paint_DrawString_Layer(UWORD Xstart, UWORD Ystart, const char *pString,
+                            sFONT *Font, UWORD Color_Foreground, PAINT_RECT *Area)
+{
+    Paint_RestoreBackground(Area->Xstart, Area->Ystart, Area->Xend, Area->Yend);
+
+    Paint_WithWriter([&](auto Writer)
+                     {
+        int Xpoint = Xstart;
+        int Xend = Xstart;
+        for (; *pString != '\0' && Xpoint < Writer.Width(); pString++)
         {
-            nextXpoint = 0;
+            Paint_DrawGlyph(Writer, Xpoint, Ystart, *pString, Font, Color_Foreground, FONT_BACKGROUND);
+            Xend = Xpoint + Font->Width;
+            Xpoint += Paint_Advance(*pString, Font);
         }
 
-        // The next character of the address
-        pString++;
-
-        // The next word of the abscissa increases the font of the broadband
-        Xpoint += Font->Width - nextXpoint;
-    }
+        Area->Xstart = Xstart;
+        Area->Ystart = Ystart;
+        Area->Xend = Paint_Min(Xend, Writer.Width());
+        Area->Yend = Paint_Min(Ystart + Font->Height, Writer.Height()); });
 }
 
 /******************************************************************************
@@ -857,6 +1352,7 @@ void Paint_DrawBitMap(const unsigned char *image_buffer)
             Paint.Image[Addr] = (unsigned char)image_buffer[Addr];
         }
     }
+    Paint_AddDamage(0, 0, Paint.WidthMemory, Paint.HeightMemory);
 }
 
 /*
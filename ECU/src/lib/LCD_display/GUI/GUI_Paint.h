@@ -65,9 +65,31 @@ typedef struct
     UWORD HeightByte;
     UWORD Depth;
     UBYTE Mode;
+    const UWORD *Background; // Background layer, NULL if there is none
 } PAINT;
 extern PAINT Paint;
 
+/**
+ * Damaged (drawn since the last flush) areas of the image, in memory
+ * coordinates with exclusive ends. Close rectangles are merged, so the
+ * list stays short enough to send each one as a display window.
+ **/
+#define PAINT_DAMAGE_MAX 8
+
+typedef struct
+{
+    UWORD Xstart;
+    UWORD Ystart;
+    UWORD Xend;
+    UWORD Yend;
+} PAINT_RECT;
+
+typedef struct
+{
+    PAINT_RECT Rect[PAINT_DAMAGE_MAX];
+    UBYTE Count;
+} PAINT_DAMAGE;
+
 /**
  * image color
  **/
@@ -158,6 +180,21 @@ void Paint_SetPixel(UWORD Xpoint, UWORD Ypoint, UWORD Color);
 void Paint_Clear(UWORD Color);
 void Paint_ClearWindow(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color);
 
+// Spans, clipped to the image; rotation and mirroring are resolved once per call
+void Paint_DrawHSpan(UWORD Xstart, UWORD Ypoint, UWORD Length, UWORD Color);
+void Paint_DrawVSpan(UWORD Xpoint, UWORD Ystart, UWORD Length, UWORD Color);
+
+// Damage tracking
+void Paint_AddDamage(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend);
+const PAINT_DAMAGE *Paint_GetDamage(void);
+void Paint_ClearDamage(void);
+
+// Background layer: an unchanging copy of the image that overlays are drawn over
+// and erased back to. Areas are logical with exclusive ends, 16 bit images only
+void Paint_SetBackground(const UWORD *Background);
+void Paint_RestoreBackground(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend);
+void Paint_DrawString_Layer(UWORD Xstart, UWORD Ystart, const char *pString, sFONT *Font, UWORD Color_Foreground, PAINT_RECT *Area);
+
 // Drawing
 void Paint_DrawPoint(UWORD Xpoint, UWORD Ypoint, UWORD Color, DOT_PIXEL Dot_Pixel, DOT_STYLE Dot_FillWay);
 void Paint_DrawLine(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD Color, DOT_PIXEL Line_width, LINE_STYLE Line_Style);
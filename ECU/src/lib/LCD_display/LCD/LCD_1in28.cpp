@@ -368,23 +368,25 @@ function:	Sets the start position and size of the display area
 parameter:
 		Xstart 	:   X direction Start coordinates
 		Ystart  :   Y direction Start coordinates
-		Xend    :   X direction end coordinates
-		Yend    :   Y direction end coordinates
+		Xend    :   X direction end coordinates (exclusive)
+		Yend    :   Y direction end coordinates (exclusive)
+info:
+		The window must not be empty (Xend > Xstart, Yend > Ystart)
 ********************************************************************************/
 void LCD_1IN28_SetWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend)
 {
     //set the X coordinates
     LCD_1IN28_SendCommand(0x2A);
-    LCD_1IN28_SendData_8Bit(0x00);
+    LCD_1IN28_SendData_8Bit(Xstart>>8);
     LCD_1IN28_SendData_8Bit(Xstart);
 	LCD_1IN28_SendData_8Bit((Xend-1)>>8);
     LCD_1IN28_SendData_8Bit(Xend-1);
 
     //set the Y coordinates
     LCD_1IN28_SendCommand(0x2B);
-    LCD_1IN28_SendData_8Bit(0x00);
+    LCD_1IN28_SendData_8Bit(Ystart>>8);
 	LCD_1IN28_SendData_8Bit(Ystart);
-	LCD_1IN28_SendData_8Bit((Xend-1)>>8);
+	LCD_1IN28_SendData_8Bit((Yend-1)>>8);
     LCD_1IN28_SendData_8Bit(Yend-1);
 
     LCD_1IN28_SendCommand(0X2C);
@@ -426,24 +428,40 @@ void LCD_1IN28_Display(UWORD *Image)
     }
 }
 
-void LCD_1IN28_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image)
+/******************************************************************************
+function :	Sends part of the image buffer in RAM to displays
+parameter:
+		Xstart, Ystart : Top left corner
+		Xend, Yend     : Bottom right corner (exclusive), clipped to the panel
+		Image          : Whole image buffer, LCD_1IN28_WIDTH pixels per row
+return   :	Bytes sent over SPI, 0 if the window is empty
+******************************************************************************/
+UDOUBLE LCD_1IN28_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image)
 {
     // display
     UDOUBLE Addr = 0;
 
+    if (Xend > LCD_1IN28_WIDTH)
+        Xend = LCD_1IN28_WIDTH;
+    if (Yend > LCD_1IN28_HEIGHT)
+        Yend = LCD_1IN28_HEIGHT;
+    if (Xstart >= Xend || Ystart >= Yend)
+        return 0;
+
     UWORD j;
     LCD_1IN28_SetWindows(Xstart, Ystart, Xend , Yend);
     LCD_1IN28_DC_1;
-    for (j = Ystart; j < Yend - 1; j++) {
+    for (j = Ystart; j < Yend; j++) {
         Addr = Xstart + j * LCD_1IN28_WIDTH ;
         DEV_SPI_Write_nByte((uint8_t *)&Image[Addr], (Xend-Xstart)*2);
     }
+    return LCD_1IN28_WINDOW_BYTES + (UDOUBLE)(Xend - Xstart) * (Yend - Ystart) * 2;
 }
 
 
 void LCD_1IN28_DisplayPoint(UWORD X, UWORD Y, UWORD Color)
 {
-    LCD_1IN28_SetWindows(X,Y,X,Y);
+    LCD_1IN28_SetWindows(X,Y,X+1,Y+1);
     LCD_1IN28_SendData_16Bit(Color);
 }
 
@@ -24,6 +24,9 @@
 #define LCD_1IN28_HEIGHT 240
 #define LCD_1IN28_WIDTH 240
 
+// SPI bytes a window costs before its pixels: CASET and RASET with 4 data bytes each, RAMWR
+#define LCD_1IN28_WINDOW_BYTES 11
+
 
 #define HORIZONTAL 0
 #define VERTICAL   1
@@ -56,7 +59,7 @@ function:
 void LCD_1IN28_Init(UBYTE Scan_dir);
 void LCD_1IN28_Clear(UWORD Color);
 void LCD_1IN28_Display(UWORD *Image);
-void LCD_1IN28_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image);
+UDOUBLE LCD_1IN28_DisplayWindows(UWORD Xstart, UWORD Ystart, UWORD Xend, UWORD Yend, UWORD *Image);
 void LCD_1IN28_DisplayPoint(UWORD X, UWORD Y, UWORD Color);
 void Handler_1IN28_LCD(int signo);
 #endif
@@ -18,6 +18,7 @@
 #include "LCD_1in28.h"
 #include "GUI_Paint.h"
 #include "GUI_BMP.h"
+#include "GUI_Bundle.h"
 #include "image.h"
 #include <stdio.h>
 #include <stdlib.h> //exit()
@@ -18,8 +18,21 @@ int main(int argc, char *argv[])
 
 	logger.info("BCM2835 initialized!");
 
+	// Mapped before the processes are forked, so they all share its pages
+	if (GUI_OpenBundle(ASSET_BUNDLE_FILE) != 0)
+	{
+#ifdef USE_ASSET_BUNDLE
+		logger.error("Failed to open " ASSET_BUNDLE_FILE ", the fonts are in it!");
+		exit(1);
+#else
+		logger.warning("Failed to open " ASSET_BUNDLE_FILE ", images will be read from " IMAGES_PATH);
+#endif
+	}
+
 	// Setting up shared memory
 	engineValues = createSharedMemory<EngineValues>("/engineValues", true);
+	engineSignals = createSharedMemory<EngineSignals>("/engineSignals", true);
+	canStats = createSharedMemory<CANStats>("/canStats", true);
 	speedSensorData = createSharedMemory<SpeedSensorData>("/speedSensorData", true);
 	coolantTempSensorData = createSharedMemory<CoolantTempSensorData>("/coolantTempSensorData", true);
 	mileage = createSharedMemory<MileageData>("/mileageData", true);
@@ -31,8 +44,7 @@ int main(int argc, char *argv[])
 	useconds_t mainLoopInterval = config.get<useconds_t>("main_loop_interval");
 	bool debugEnabled = config.get<bool>("debug_enabled");
 
-	double lastDistanceCovered = 0;
-	double lastFuelConsumption = 0;
+	double fuelFlow = 0;
 	std::ostringstream roundedPartialMileage;
 
 	ads1115 = std::make_unique<ADS1115>();
@@ -44,8 +56,8 @@ int main(int argc, char *argv[])
 	SSD1306Hardware speedometerUpperDisplay;
 
 	// Add smart pointer factories to the vector
-	// processFactories.push_back({"MCP2515", []()
-	// 							{ return std::make_shared<MCP2515>(); }});
+	processFactories.push_back({"MCP2515", []()
+								{ return std::make_shared<MCP2515>(); }});
 	// processFactories.push_back({"TempGauge", []()
 	// 							{ return std::make_shared<TempGauge>(); }});
 	// processFactories.push_back({"DigitalGauge", []()
@@ -110,8 +122,16 @@ int main(int argc, char *argv[])
 		}
 
 		speedometerUpperDisplay.drawString(SSD1306_ALIGN_CENTER, roundedPartialMileage.str().c_str(), LiberationSansNarrow_Bold28);
-		engineValues->kml = lastFuelConsumption > 0 ? lastDistanceCovered / lastFuelConsumption : 0;
-		lastDistanceCovered = speedSensorData->distanceCovered;
+		// Fuel flow comes from the Holley ECU in lb/h (gasoline ~6 lb/gal)
+		if (readFreshEngineSignal(engineSignals, SIGNAL_FUEL_FLOW, fuelFlow) && fuelFlow > 0)
+		{
+			double litersPerHour = fuelFlow / 6.0 * 3.78541;
+			engineValues->kml = speedSensorData->speed / litersPerHour;
+		}
+		else
+		{
+			engineValues->kml = 0;
+		}
 
 		if (debugEnabled)
 		{
@@ -146,6 +166,10 @@ int main(int argc, char *argv[])
 	// Cleanup shared memory spaces.
 	munmap(const_cast<void *>(reinterpret_cast<const volatile void *>(engineValues)), sizeof(EngineValues));
 	shm_unlink("/engineValuesMemory");
+	munmap(const_cast<void *>(reinterpret_cast<const volatile void *>(engineSignals)), sizeof(EngineSignals));
+	shm_unlink("/engineSignals");
+	munmap(const_cast<void *>(reinterpret_cast<const volatile void *>(canStats)), sizeof(CANStats));
+	shm_unlink("/canStats");
 	munmap(const_cast<void *>(reinterpret_cast<const volatile void *>(speedSensorData)), sizeof(SpeedSensorData));
 	shm_unlink("/speedSensorData");
 	munmap(const_cast<void *>(reinterpret_cast<const volatile void *>(coolantTempSensorData)), sizeof(CoolantTempSensorData));
@@ -157,6 +181,7 @@ int main(int argc, char *argv[])
 	// digitalGauge.showLogo();
 
 	terminateChildProcesses(childProcesses);
+	GUI_CloseBundle();
 
 	bcm2835_i2c_end();
 	bcm2835_close();
@@ -35,6 +35,8 @@ struct Factory
 std::vector<Factory> processFactories;
 
 volatile EngineValues *engineValues = nullptr;
+volatile EngineSignals *engineSignals = nullptr;
+volatile CANStats *canStats = nullptr;
 volatile SpeedSensorData *speedSensorData = nullptr;
 volatile CoolantTempSensorData *coolantTempSensorData = nullptr;
 volatile MileageData *mileage = nullptr;
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Packs the ECU's fonts and images into one asset bundle that GUI_Bundle
+(ECU/src/lib/LCD_display/GUI/GUI_Bundle.h) maps read-only at startup.
+
+Fonts are read from the sFONT sources (FontNN / LiberationSansNarrow_BoldNN
+.cpp files) and stored as the same 1 bit glyph tables, named after their sFONT
+symbol. Images are uncompressed BMPs converted to panel-native (byte-swapped)
+RGB565, top row first, named after their file name.
+
+Layout, little endian:
+    header   magic "TBND", version, entry count, file size
+    index    one 64 byte entry per asset: name, type, compression, width,
+             height, offset, stored size, unpacked size
+    sections the asset data, each starting on an --align boundary so the
+             pages of one asset are never shared with another
+
+With --compress images are stored as the RGB565 run-length packets of
+image_pack.py when that is smaller. Fonts are always stored as is, glyphs are
+looked up in place.
+
+Usage: asset_bundle.py [--align BYTES] [--compress] <output> <font.cpp|image.bmp>...
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from image_pack import packets, read_bmp  # noqa: E402
+
+MAGIC = 0x444E4254  # "TBND"
+VERSION = 1
+NAME_MAX = 32
+HEADER = struct.Struct("<IIII")
+ENTRY = struct.Struct(f"<{NAME_MAX}sHHHHIII12x")
+
+TYPE_FONT = 0
+TYPE_IMAGE = 1
+COMPRESSION_NONE = 0
+COMPRESSION_RLE = 1
+
+FONT_PATTERN = re.compile(r"sFONT\s+(\w+)\s*=\s*\{\s*(\w+)\s*,\s*(\d+)\s*,\s*(\d+)")
+FIRST_CHAR = " "
+LAST_CHAR = "~"
+
+
+def read_font(path):
+    with open(path) as file:
+        source = file.read()
+    source = re.sub(r"/\*.*?\*/|//[^\n]*", "", source, flags=re.S)
+
+    font = FONT_PATTERN.search(source)
+    if not font:
+        sys.exit(f"Error: {path}: no sFONT definition")
+    name, table, width, height = font.group(1), font.group(2), int(font.group(3)), int(font.group(4))
+
+    array = re.search(rf"{table}\s*\[\s*\]\s*=\s*\{{(.*?)\}};", source, re.S)
+    if not array:
+        sys.exit(f"Error: {path}: no {table} array")
+    data = bytes(int(value, 16) for value in re.findall(r"0[xX]([0-9A-Fa-f]+)", array.group(1)))
+
+    expected = (ord(LAST_CHAR) - ord(FIRST_CHAR) + 1) * height * ((width + 7) // 8)
+    if len(data) < expected:
+        sys.exit(f"Error: {path}: {name} has {len(data)} bytes, {expected} expected")
+    return name, width, height, data[:expected]
+
+
+def rle(pixels):
+    """RGB565 packets of image_pack.py, colours big endian (panel-native)."""
+    stream = bytearray()
+    for packet in packets(pixels, 2):
+        if packet[0] == "run":
+            _, value, count = packet
+            stream.append(0x80 | (count - 1))
+            stream += struct.pack(">H", value)
+        else:
+            stream.append(len(packet[1]) - 1)
+            stream += struct.pack(f">{len(packet[1])}H", *packet[1])
+    return bytes(stream)
+
+
+def read_image(path, compress):
+    image = read_bmp(path)
+    if not image:
+        sys.exit(f"Error: {path} is not a BMP")
+    width, height, pixels = image
+    # The panel takes the high byte first
+    raw = struct.pack(f">{len(pixels)}H", *pixels)
+    if compress:
+        packed = rle(pixels)
+        if len(packed) < len(raw):
+            return width, height, COMPRESSION_RLE, packed, len(raw)
+    return width, height, COMPRESSION_NONE, raw, len(raw)
+
+
+def align(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack fonts and images into an ECU asset bundle.")
+    parser.add_argument("output", help="Bundle to write")
+    parser.add_argument("inputs", nargs="+", help="sFONT .cpp sources and .bmp images")
+    parser.add_argument("--align", type=int, default=4096, help="Section alignment (default: 4096, a page)")
+    parser.add_argument("--compress", action="store_true", help="Run-length code images when it saves space")
+    args = parser.parse_args()
+
+    assets = []
+    for path in args.inputs:
+        if path.lower().endswith(".bmp"):
+            width, height, compression, data, raw_size = read_image(path, args.compress)
+            assets.append((os.path.basename(path), TYPE_IMAGE, compression, width, height, data, raw_size))
+        else:
+            name, width, height, data = read_font(path)
+            assets.append((name, TYPE_FONT, COMPRESSION_NONE, width, height, data, len(data)))
+
+    names = set()
+    for asset in assets:
+        if len(asset[0].encode()) >= NAME_MAX:
+            sys.exit(f"Error: asset name {asset[0]} is longer than {NAME_MAX - 1} characters")
+        if asset[0] in names:
+            sys.exit(f"Error: asset {asset[0]} is there twice")
+        names.add(asset[0])
+
+    offset = align(HEADER.size + ENTRY.size * len(assets), args.align)
+    index = bytearray()
+    for name, kind, compression, width, height, data, raw_size in assets:
+        index += ENTRY.pack(name.encode(), kind, compression, width, height, offset, len(data), raw_size)
+        offset = align(offset + len(data), args.align)
+
+    size = HEADER.size + len(index)
+    for asset in assets:
+        size = align(size, args.align) + len(asset[5])
+
+    bundle = bytearray(HEADER.pack(MAGIC, VERSION, len(assets), size) + index)
+    for asset in assets:
+        bundle += bytes(align(len(bundle), args.align) - len(bundle)) + asset[5]
+
+    # A running ECU has the old bundle mapped, replace it instead of truncating it
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output + ".tmp", "wb") as file:
+        file.write(bundle)
+    os.replace(args.output + ".tmp", args.output)
+
+    fonts = sum(1 for asset in assets if asset[1] == TYPE_FONT)
+    print(f"Bundled {fonts} fonts and {len(assets) - fonts} images: {len(bundle)} bytes "
+          f"({sum(len(asset[5]) for asset in assets)} bytes of data)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Generates a saturated CAN stream on a virtual interface so the ECU receive loop
+# can be checked for dropped frames. Point the ECU at it with [MCP2515] interface=vcan0
+# and compare the frames sent below with the "Received/dropped" stats it logs.
+
+INTERFACE="vcan0"
+BITRATE=500000
+DURATION=30
+LOAD=100
+
+usage() {
+    echo "Usage: $0 [-i interface] [-b bitrate] [-l load_percent] [-d duration_seconds]"
+    exit 1
+}
+
+while getopts "i:b:l:d:h" opt; do
+    case $opt in
+        i) INTERFACE="$OPTARG" ;;
+        b) BITRATE="$OPTARG" ;;
+        l) LOAD="$OPTARG" ;;
+        d) DURATION="$OPTARG" ;;
+        *) usage ;;
+    esac
+done
+
+if ! command -v cangen &> /dev/null; then
+    echo "Error: cangen is not installed. Install it using: sudo apt install can-utils"
+    exit 1
+fi
+
+# Create the virtual interface if needed
+if ! ip link show "$INTERFACE" &> /dev/null; then
+    echo "Creating $INTERFACE..."
+    sudo modprobe vcan || exit 1
+    sudo ip link add dev "$INTERFACE" type vcan || exit 1
+fi
+sudo ip link set up "$INTERFACE" || exit 1
+
+# An extended frame with 8 data bytes takes ~128 bits on the wire plus worst case
+# stuffing (~25 bits). Derive the inter-frame gap that matches the requested load.
+BITS_PER_FRAME=153
+GAP_MS=$(awk -v bits=$BITS_PER_FRAME -v rate=$BITRATE -v load=$LOAD 'BEGIN { printf "%.3f", bits * 1000 / rate * 100 / load }')
+FRAMES_PER_SECOND=$(awk -v gap=$GAP_MS 'BEGIN { printf "%d", 1000 / gap }')
+
+TX_BEFORE=$(cat /sys/class/net/"$INTERFACE"/statistics/tx_packets)
+
+# Holley RPM message (0x1E005000) carrying random data, the same 29-bit layout the ECU decodes
+echo "Sending ~$FRAMES_PER_SECOND frames/s (${LOAD}% of $BITRATE bit/s) on $INTERFACE for ${DURATION}s..."
+timeout "$DURATION" cangen "$INTERFACE" -e -I 1E005000 -L 8 -D r -g "$GAP_MS"
+
+TX_AFTER=$(cat /sys/class/net/"$INTERFACE"/statistics/tx_packets)
+echo "Frames sent: $((TX_AFTER - TX_BEFORE))"
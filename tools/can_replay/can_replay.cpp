@@ -0,0 +1,221 @@
+/*
+ * can_replay.cpp
+ *
+ * Host-side front end for the CAN traces the ECU records (MCP2515 section,
+ * record_trace=true). Converts between traces and candump logs and replays a
+ * trace into either decoder, at the recorded timing, N times faster or as
+ * fast as possible, reporting decode throughput and the latency from each
+ * frame's slot to its decoded output.
+ *
+ *   dbc        ECU DBCParser::decode (the path published to shared memory)
+ *   dbc-print  ECU DBCParser::parseCANData, printing every signal
+ *   holley     DigitalGauge HolleySniper::processCANMessage
+ *
+ * Build from the repository root:
+ *   python3 tools/dbc_to_header.py --signed32-as-float --holley-addressing \
+ *       ECU/src/assets/HolleySniper/Sniper_V2.dbc /tmp/HolleySniperDBC.h
+ *   g++ -std=c++20 -O2 -I/tmp -IECU/src/core -IDigitalGauge/core -Itools/mcp2515_sim \
+ *       tools/can_replay/can_replay.cpp ECU/src/core/CANTrace.cpp ECU/src/core/CANReplay.cpp \
+ *       ECU/src/core/DBCParser.cpp DigitalGauge/core/HolleySniper.cpp DigitalGauge/core/MCP2515.cpp \
+ *       -o can_replay
+ *
+ *   ./can_replay import <candump.log> <trace_dir>
+ *   ./can_replay export <trace_dir> [candump.log]
+ *   ./can_replay replay <trace_dir> [dbc|dbc-print|holley] [speed|max]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "CANTrace.h"
+#include "CANReplay.h"
+#include "DBCParser.h"
+#include "HolleySniper.h"
+
+// ---------------------------------------------------------------------------
+// Pico SDK stand-ins. HolleySniper only needs the clock, the MCP2515 driver is
+// linked for its acceptance filter code and never touches the bus here.
+// ---------------------------------------------------------------------------
+
+spi_inst_t* spi1 = nullptr;
+
+static uint64_t hostMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+absolute_time_t get_absolute_time(void) { return hostMicros(); }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint32_t time_us_32(void) { return (uint32_t)hostMicros(); }
+void sleep_ms(uint32_t ms) { (void)ms; }
+void sleep_us(uint64_t us) { (void)us; }
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+void gpio_put(uint gpio, bool value) { (void)gpio; (void)value; }
+bool gpio_get(uint gpio) { (void)gpio; return true; }
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    (void)gpio; (void)events; (void)enabled; (void)callback;
+}
+
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len) {
+    (void)spi; (void)src;
+    memset(dst, 0, len);
+    return (int)len;
+}
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) { (void)spi; (void)src; return (int)len; }
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len) {
+    (void)spi; (void)repeated_tx_data;
+    memset(dst, 0, len);
+    return (int)len;
+}
+
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) { (void)status; }
+
+// ---------------------------------------------------------------------------
+// Commands
+// ---------------------------------------------------------------------------
+
+static int usage(const char* name) {
+    printf("Usage: %s import <candump.log> <trace_dir>\n", name);
+    printf("       %s export <trace_dir> [candump.log]\n", name);
+    printf("       %s replay <trace_dir> [dbc|dbc-print|holley] [speed|max]\n", name);
+    return 1;
+}
+
+static int importTrace(const char* logPath, const char* directory) {
+    std::ifstream log(logPath);
+    if (!log) {
+        printf("ERROR: cannot open %s\n", logPath);
+        return 1;
+    }
+
+    CANTraceWriter writer;
+    if (!writer.open(directory)) {
+        return 1;
+    }
+    size_t frames = writer.importCandump(log);
+    writer.close();
+
+    printf("Imported %zu frames into %s\n", frames, directory);
+    return 0;
+}
+
+static int exportTrace(const char* directory, const char* logPath) {
+    CANTraceReader reader;
+    if (!reader.open(directory)) {
+        return 1;
+    }
+
+    if (!logPath) {
+        reader.exportCandump(std::cout);
+        return 0;
+    }
+
+    std::ofstream log(logPath);
+    if (!log) {
+        printf("ERROR: cannot create %s\n", logPath);
+        return 1;
+    }
+    size_t frames = reader.exportCandump(log);
+    printf("Exported %zu frames to %s\n", frames, logPath);
+    return 0;
+}
+
+static int replayTrace(const char* directory, const std::string& sinkName, double speed) {
+    CANTraceReader reader;
+    if (!reader.open(directory)) {
+        return 1;
+    }
+
+    DBCParser dbc;
+    if (!dbc.loadGenerated(HolleyDBC::MESSAGES, HolleyDBC::MESSAGE_COUNT)) {
+        printf("ERROR: cannot load the generated DBC decoders\n");
+        return 1;
+    }
+    dbc.setIgnoredIDBits(HolleyDBC::SOURCE_MASK);  // As the ECU does
+
+    HolleySniper sniper(nullptr);
+    uint64_t decoded = 0;
+    volatile double sink = 0;
+
+    std::function<void(const CANTraceRecord&)> decode;
+    if (sinkName == "dbc") {
+        decode = [&](const CANTraceRecord& record) {
+            DecodedSignal signals[16];
+            size_t count = dbc.decode(record.canID, record.data, record.dlc, signals, 16);
+            if (count) {
+                sink = sink + signals[0].value;
+                decoded++;
+            }
+        };
+    } else if (sinkName == "dbc-print") {
+        decode = [&](const CANTraceRecord& record) {
+            uint8_t data[8];
+            memcpy(data, record.data, sizeof(data));
+            dbc.parseCANData(record.canID, data, record.dlc, record.timestamp);
+            decoded++;
+        };
+    } else if (sinkName == "holley") {
+        decode = [&](const CANTraceRecord& record) {
+            CANFrame frame;
+            memset(&frame, 0, sizeof(frame));
+            frame.extended = (record.canID & CAN_EFF_FLAG) != 0;
+            frame.remote = (record.canID & CAN_RTR_FLAG) != 0;
+            frame.id = record.canID & (frame.extended ? CAN_EFF_MASK : CAN_SFF_MASK);
+            frame.dlc = record.dlc;
+            frame.timestamp = time_us_32();
+            memcpy(frame.data, record.data, sizeof(frame.data));
+            if (sniper.processCANMessage(frame)) {
+                decoded++;
+            }
+        };
+    } else {
+        printf("ERROR: unknown sink %s\n", sinkName.c_str());
+        return 1;
+    }
+
+    printf("Replaying %llu frames from %s into %s %s\n", (unsigned long long)reader.recordCount(), directory,
+           sinkName.c_str(), speed > 0 ? (std::to_string(speed) + "x").c_str() : "as fast as possible");
+
+    CANReplay replay(reader, speed);
+    CANReplayStats stats = replay.run(decode);
+
+    printf("Frames      %llu replayed, %llu decoded in %.3f s (%.0f frames/s)\n",
+           (unsigned long long)stats.frames, (unsigned long long)decoded, stats.elapsed, stats.framesPerSecond);
+    printf("Throughput  %.0f frames/s of decode time\n", stats.decodePerSecond);
+    printf("Latency     avg %.1f us, p99 %llu us, max %llu us, %llu frames released late\n",
+           stats.latencyAvg, (unsigned long long)stats.latencyP99, (unsigned long long)stats.latencyMax,
+           (unsigned long long)stats.lateFrames);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        return usage(argv[0]);
+    }
+
+    std::string command = argv[1];
+    if (command == "import" && argc == 4) {
+        return importTrace(argv[2], argv[3]);
+    }
+    if (command == "export") {
+        return exportTrace(argv[2], argc > 3 ? argv[3] : nullptr);
+    }
+    if (command == "replay") {
+        std::string sinkName = argc > 3 ? argv[3] : "dbc";
+        double speed = 1.0;
+        if (argc > 4) {
+            speed = strcmp(argv[4], "max") == 0 ? 0.0 : atof(argv[4]);
+        }
+        return replayTrace(argv[2], sinkName, speed);
+    }
+    return usage(argv[0]);
+}
@@ -0,0 +1,387 @@
+#!/usr/bin/env python3
+"""
+Generates a C++ header with constexpr message/signal descriptors and inlined
+decoder functions from a DBC file. Used at build time by both the ECU (Pi) and
+the DigitalGauge (Pico) targets so the Holley message layout lives in one place.
+
+Usage: dbc_to_header.py [--namespace NAME] [--signed32-as-float] [--holley-addressing] <input.dbc> <output.h>
+"""
+import argparse
+import os
+import re
+import sys
+
+BO_PATTERN = re.compile(r"^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\S+)")
+SG_PATTERN = re.compile(
+    r"^SG_\s+(\w+)\s*(\S*)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*"
+    r"\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*\"([^\"]*)\""
+)
+VALTYPE_PATTERN = re.compile(r"^SIG_VALTYPE_\s+(\d+)\s+(\w+)\s*:?\s*(\d)\s*;")
+
+CAN_EFF_FLAG = 0x80000000
+CAN_EFF_MASK = 0x1FFFFFFF
+
+# Holley 29-bit identifier: command bit, target ID/serial, source ID/serial.
+# The target serial selects the message, the source fields name the sender.
+HOLLEY_FIELDS = [
+    ("command", "bool", 28, 0x1),
+    ("target_id", "uint8_t", 25, 0x7),
+    ("target_serial", "uint16_t", 14, 0x7FF),
+    ("source_id", "uint8_t", 11, 0x7),
+    ("source_serial", "uint16_t", 0, 0x7FF),
+]
+HOLLEY_SOURCE_MASK = 0x3FFF
+HOLLEY_SELECTOR_SHIFT = 14
+HOLLEY_SELECTOR_MASK = 0x7FF
+
+
+def identifier(name):
+    name = re.sub(r"\W", "_", name)
+    return f"_{name}" if name[0].isdigit() else name
+
+
+def parse_dbc(path, signed32_as_float):
+    messages = []
+    value_types = {}
+
+    with open(path, encoding="utf-8", errors="replace") as file:
+        for raw_line in file:
+            line = raw_line.strip()
+
+            match = BO_PATTERN.match(line)
+            if match:
+                raw_id = int(match.group(1))
+                messages.append({
+                    "raw_id": raw_id,
+                    "id": raw_id & CAN_EFF_MASK,
+                    "extended": bool(raw_id & CAN_EFF_FLAG) or raw_id > 0x7FF,
+                    "name": match.group(2),
+                    "dlc": int(match.group(3)),
+                    "signals": [],
+                })
+                continue
+
+            match = SG_PATTERN.match(line)
+            if match:
+                if not messages:
+                    sys.exit(f"Error: signal {match.group(1)} outside of a message")
+                messages[-1]["signals"].append({
+                    "name": match.group(1),
+                    "start": int(match.group(3)),
+                    "length": int(match.group(4)),
+                    "big_endian": match.group(5) == "0",
+                    "signed": match.group(6) == "-",
+                    "factor": float(match.group(7)),
+                    "offset": float(match.group(8)),
+                    "minimum": float(match.group(9) or 0),
+                    "maximum": float(match.group(10) or 0),
+                    "unit": match.group(11),
+                    "float": False,
+                })
+                continue
+
+            match = VALTYPE_PATTERN.match(line)
+            if match:
+                value_types[(int(match.group(1)), match.group(2))] = int(match.group(3))
+
+    for message in messages:
+        for signal in message["signals"]:
+            value_type = value_types.get((message["raw_id"], signal["name"]))
+            if value_type in (1, 2):
+                signal["float"] = True
+            elif signed32_as_float and signal["signed"] and signal["length"] == 32:
+                # Holley's DBC omits SIG_VALTYPE_ even though these are IEEE754 floats
+                signal["float"] = True
+
+            # Position of the signal LSB inside the 64-bit payload word. Motorola
+            # signals use a big endian word (byte 0 = most significant byte).
+            if signal["big_endian"]:
+                msb = (7 - signal["start"] // 8) * 8 + signal["start"] % 8
+                signal["shift"] = msb - (signal["length"] - 1)
+            else:
+                signal["shift"] = signal["start"]
+
+            if signal["shift"] < 0 or signal["shift"] + signal["length"] > 64:
+                sys.exit(f"Error: signal {message['name']}.{signal['name']} does not fit in 8 bytes")
+            if signal["float"] and signal["length"] not in (32, 64):
+                sys.exit(f"Error: float signal {message['name']}.{signal['name']} must be 32 or 64 bits")
+
+    messages.sort(key=lambda m: m["id"])
+    return messages
+
+
+def raw_type(length):
+    for bits in (8, 16, 32, 64):
+        if length <= bits:
+            return f"uint{bits}_t"
+
+
+def extract_expression(signal):
+    shift = signal["shift"]
+    length = signal["length"]
+
+    # Byte aligned fields collapse into a direct byte composition
+    if shift % 8 == 0 and length % 8 == 0:
+        count = length // 8
+        if signal["big_endian"]:
+            first = 7 - (shift // 8 + count - 1)
+            order = range(first, first + count)
+        else:
+            first = shift // 8
+            order = reversed(range(first, first + count))
+        cast = raw_type(length)
+        terms = []
+        for position, index in enumerate(order):
+            bits = (count - 1 - position) * 8
+            term = f"({cast})data[{index}]"
+            terms.append(f"({term} << {bits})" if bits else term)
+        return " | ".join(terms)
+
+    word = "bigEndianWord(data)" if signal["big_endian"] else "littleEndianWord(data)"
+    mask = "0xFFFFFFFFFFFFFFFFull" if length == 64 else f"0x{(1 << length) - 1:X}ull"
+    return f"({raw_type(length)})(({word} >> {shift}) & {mask})"
+
+
+def value_type(signal):
+    scaled = signal["factor"] != 1 or signal["offset"] != 0
+    if signal["float"]:
+        return "double" if signal["length"] == 64 or scaled else "float"
+    if scaled:
+        return "double"
+    if signal["signed"]:
+        return raw_type(signal["length"]).replace("uint", "int")
+    return raw_type(signal["length"])
+
+
+def emit_decoder(message, signal):
+    function = f"{identifier(message['name'])}_{identifier(signal['name'])}"
+    result = value_type(signal)
+    cast = raw_type(signal["length"])
+    body = [f"    {cast} raw = {extract_expression(signal)};"]
+
+    if signal["float"]:
+        physical = "float" if signal["length"] == 32 else "double"
+        body.append(f"    {physical} value;")
+        body.append("    memcpy(&value, &raw, sizeof(value));")
+    elif signal["signed"] and signal["length"] not in (8, 16, 32, 64):
+        signed_cast = cast.replace("uint", "int")
+        body.append(f"    {signed_cast} value = (raw & (1ull << {signal['length'] - 1})) ? ({signed_cast})(raw | ~(({cast})0x{(1 << signal['length']) - 1:X}ull)) : ({signed_cast})raw;")
+    elif signal["signed"]:
+        body.append(f"    {cast.replace('uint', 'int')} value = ({cast.replace('uint', 'int')})raw;")
+    else:
+        body.append(f"    {cast} value = raw;")
+
+    if signal["factor"] != 1 or signal["offset"] != 0:
+        body.append(f"    return (double)value * {signal['factor']!r} + {signal['offset']!r};")
+    else:
+        body.append("    return value;")
+
+    lines = [f"// {message['name']}.{signal['name']} [{signal['unit']}]"]
+    lines.append(f"static inline {result} {function}(const uint8_t *data)")
+    lines.append("{")
+    lines.extend(body)
+    lines.append("}")
+    return function, "\n".join(lines)
+
+
+def emit_holley_addressing(messages):
+    table = [0xFF] * (HOLLEY_SELECTOR_MASK + 1)
+    for index, message in enumerate(messages):
+        selector = (message["id"] >> HOLLEY_SELECTOR_SHIFT) & HOLLEY_SELECTOR_MASK
+        if table[selector] != 0xFF:
+            other = messages[table[selector]]["name"]
+            sys.exit(f"Error: {message['name']} and {other} share target serial {selector}")
+        table[selector] = index
+    if len(messages) >= 0xFF:
+        sys.exit("Error: too many messages for the addressing table")
+
+    out = []
+    out.append("// Holley identifier fields")
+    out.append("struct Address")
+    out.append("{")
+    for name, type_name, _, _ in HOLLEY_FIELDS:
+        out.append(f"    {type_name} {name};")
+    out.append("};")
+    out.append("")
+    out.append("static inline Address decodeAddress(uint32_t id)")
+    out.append("{")
+    out.append("    Address address;")
+    for name, type_name, shift, mask in HOLLEY_FIELDS:
+        cast = "" if type_name == "bool" else f"({type_name})"
+        out.append(f"    address.{name} = {cast}((id >> {shift}) & 0x{mask:X}u);")
+    out.append("    return address;")
+    out.append("}")
+    out.append("")
+    out.append("// Source ID and serial bits, they differ between units sending the same message")
+    out.append(f"constexpr uint32_t SOURCE_MASK = 0x{HOLLEY_SOURCE_MASK:08X}u;")
+    out.append("")
+    out.append("// MESSAGES index by target serial field, 0xFF when unused")
+    out.append(f"inline constexpr uint8_t INDEX_BY_TARGET_SERIAL[{len(table)}] = {{")
+    for row in range(0, len(table), 16):
+        out.append("    " + " ".join(f"{value}," for value in table[row:row + 16]))
+    out.append("};")
+    out.append("")
+    out.append("// Returns the MESSAGES index for a CAN ID sent by any Holley unit (the source")
+    out.append("// fields are ignored), or -1 when the ID is not in the DBC. One table load.")
+    out.append("static inline int messageIndexAnySource(uint32_t id)")
+    out.append("{")
+    out.append(f"    id &= 0x{CAN_EFF_MASK:X}u;")
+    out.append(f"    uint8_t index = INDEX_BY_TARGET_SERIAL[(id >> {HOLLEY_SELECTOR_SHIFT}) & 0x{HOLLEY_SELECTOR_MASK:X}u];")
+    out.append("    if (index == 0xFF || ((MESSAGES[index].id ^ id) & ~SOURCE_MASK) != 0)")
+    out.append("        return -1;")
+    out.append("    return index;")
+    out.append("}")
+    out.append("")
+    return out
+
+
+def generate(messages, source, namespace, holley_addressing):
+    out = []
+    out.append(f"// Generated by tools/dbc_to_header.py from {os.path.basename(source)}. Do not edit.")
+    out.append("#pragma once")
+    out.append("")
+    out.append("#include <stdint.h>")
+    out.append("#include <stddef.h>")
+    out.append("#include <string.h>")
+    out.append("")
+    out.append(f"namespace {namespace}")
+    out.append("{")
+    out.append("")
+    out.append("struct SignalDescriptor")
+    out.append("{")
+    out.append("    const char *name;")
+    out.append("    const char *unit;")
+    out.append("    uint8_t shift;      // LSB position inside the 64-bit payload word")
+    out.append("    uint8_t length;")
+    out.append("    bool big_endian;")
+    out.append("    bool is_float;")
+    out.append("    bool is_signed;")
+    out.append("    float factor;")
+    out.append("    float offset;")
+    out.append("    float minimum;")
+    out.append("    float maximum;")
+    out.append("    double (*decode)(const uint8_t *data);")
+    out.append("};")
+    out.append("")
+    out.append("struct MessageDescriptor")
+    out.append("{")
+    out.append("    uint32_t id;")
+    out.append("    const char *name;")
+    out.append("    uint8_t dlc;")
+    out.append("    bool extended;")
+    out.append("    uint8_t signal_count;")
+    out.append("    const SignalDescriptor *signals;")
+    out.append("};")
+    out.append("")
+    out.append("static inline uint64_t bigEndianWord(const uint8_t *data)")
+    out.append("{")
+    out.append("    uint64_t word = 0;")
+    out.append("    for (int i = 0; i < 8; i++)")
+    out.append("        word = (word << 8) | data[i];")
+    out.append("    return word;")
+    out.append("}")
+    out.append("")
+    out.append("static inline uint64_t littleEndianWord(const uint8_t *data)")
+    out.append("{")
+    out.append("    uint64_t word = 0;")
+    out.append("    for (int i = 7; i >= 0; i--)")
+    out.append("        word = (word << 8) | data[i];")
+    out.append("    return word;")
+    out.append("}")
+    out.append("")
+
+    out.append(f"constexpr size_t MESSAGE_COUNT = {len(messages)};")
+    out.append("")
+    for index, message in enumerate(messages):
+        name = identifier(message["name"])
+        out.append(f"constexpr uint32_t {name}_ID = 0x{message['id']:08X}u;")
+        out.append(f"constexpr uint8_t {name}_INDEX = {index};")
+    out.append("")
+
+    for message in messages:
+        name = identifier(message["name"])
+        out.append(f"// ---- {message['name']} (0x{message['id']:08X}) ----")
+        entries = []
+        for signal in message["signals"]:
+            function, code = emit_decoder(message, signal)
+            out.append(code)
+            out.append("")
+            entries.append(
+                f"    {{\"{signal['name']}\", \"{signal['unit']}\", {signal['shift']}, {signal['length']}, "
+                f"{str(signal['big_endian']).lower()}, {str(signal['float']).lower()}, {str(signal['signed']).lower()}, "
+                f"{signal['factor']!r}f, {signal['offset']!r}f, {signal['minimum']!r}f, {signal['maximum']!r}f, "
+                f"[](const uint8_t *data) -> double {{ return (double){function}(data); }}}},"
+            )
+        out.append(f"inline constexpr SignalDescriptor {name}_SIGNALS[] = {{")
+        out.extend(entries)
+        out.append("};")
+        out.append("")
+
+    out.append("// Sorted by CAN ID")
+    out.append("inline constexpr MessageDescriptor MESSAGES[MESSAGE_COUNT] = {")
+    for message in messages:
+        name = identifier(message["name"])
+        out.append(
+            f"    {{{name}_ID, \"{message['name']}\", {message['dlc']}, {str(message['extended']).lower()}, "
+            f"{len(message['signals'])}, {name}_SIGNALS}},"
+        )
+    out.append("};")
+    out.append("")
+    out.append("// Returns the MESSAGES index for a CAN ID, or -1 when the ID is not in the DBC.")
+    out.append("static inline int messageIndex(uint32_t id)")
+    out.append("{")
+    out.append(f"    id &= 0x{CAN_EFF_MASK:X}u;")
+    out.append("    int low = 0;")
+    out.append("    int high = (int)MESSAGE_COUNT - 1;")
+    out.append("    while (low <= high)")
+    out.append("    {")
+    out.append("        int middle = (low + high) / 2;")
+    out.append("        if (MESSAGES[middle].id == id)")
+    out.append("            return middle;")
+    out.append("        if (MESSAGES[middle].id < id)")
+    out.append("            low = middle + 1;")
+    out.append("        else")
+    out.append("            high = middle - 1;")
+    out.append("    }")
+    out.append("    return -1;")
+    out.append("}")
+    out.append("")
+    out.append("static inline const MessageDescriptor *findMessage(uint32_t id)")
+    out.append("{")
+    out.append("    int index = messageIndex(id);")
+    out.append("    return index < 0 ? nullptr : &MESSAGES[index];")
+    out.append("}")
+    out.append("")
+    if holley_addressing:
+        out.extend(emit_holley_addressing(messages))
+    out.append(f"}} // namespace {namespace}")
+    out.append("")
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Generate C++ decoders from a DBC file.")
+    parser.add_argument("input", help="Input .dbc file")
+    parser.add_argument("output", help="Output header")
+    parser.add_argument("--namespace", default="HolleyDBC", help="C++ namespace for the generated code")
+    parser.add_argument("--signed32-as-float", action="store_true",
+                        help="Treat signed 32-bit signals without SIG_VALTYPE_ as IEEE754 floats")
+    parser.add_argument("--holley-addressing", action="store_true",
+                        help="Emit Holley identifier field decoding and a source independent message lookup")
+    args = parser.parse_args()
+
+    messages = parse_dbc(args.input, args.signed32_as_float)
+    if not messages:
+        sys.exit(f"Error: no messages found in {args.input}")
+
+    content = generate(messages, args.input, args.namespace, args.holley_addressing)
+
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+    with open(args.output, "w") as file:
+        file.write(content)
+
+    print(f"Generated {args.output} ({len(messages)} messages)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,522 @@
+/*
+ * gauge_sim.cpp
+ *
+ * Host build of the DigitalGauge display stack. The unmodified GC9A01 driver,
+ * widgets and dashboard run against a model of the panel: the SPI stand-in
+ * decodes CASET/RASET/RAMWR into a 240x240 RGB565 panel memory and DMA
+ * transfers complete at once through the driver's own IRQ handler. A scripted
+ * drive (boot logo, RPM sweeps, a sensor dropping out) is rendered frame by
+ * frame. The driver's frame stats plus the SPI time the traffic would take at
+ * the firmware's 10 MHz are reported, and frames can be dumped as PPM or PNG
+ * to check the layout.
+ *
+ * Build and run from the repository root:
+ *   python3 tools/dbc_to_header.py --signed32-as-float --holley-addressing \
+ *       DigitalGauge/assets/HolleySniper/Sniper_V2.dbc /tmp/gauge_sim/HolleySniperDBC.h
+ *   python3 tools/image_pack.py DigitalGauge/assets/torino_logo_sm.bmp /tmp/gauge_sim
+ *   g++ -std=c++17 -O2 -I/tmp/gauge_sim -Itools/gauge_sim -IDigitalGauge -IDigitalGauge/core \
+ *       tools/gauge_sim/gauge_sim.cpp DigitalGauge/core/GC9A01.cpp DigitalGauge/core/GlyphCache.cpp \
+ *       DigitalGauge/core/PackedImage.cpp DigitalGauge/core/RingMeter.cpp DigitalGauge/core/Widgets.cpp \
+ *       DigitalGauge/core/Dashboard.cpp DigitalGauge/fonts/font*.cpp DigitalGauge/fonts/Liberation*.cpp \
+ *       /tmp/gauge_sim/torino_logo_sm.cpp -o gauge_sim
+ *   ./gauge_sim [--frames N] [--direct] [--no-dma] [--csv] [--overlay] [--dump DIR] [--dump-every N] [--png]
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#include "GC9A01.h"
+#include "GlyphCache.h"
+#include "Dashboard.h"
+#include "torino_logo_sm.h"
+
+#define SIM_PIN_CS          17
+#define SIM_PIN_DC          20
+#define SIM_PIN_RST         21
+#define SIM_PIN_BL          22
+#define SIM_SPI_HZ          10000000    // DigitalGauge runs SPI0 at 10MHz
+#define SIM_FRAME_MS        33          // UI_FPS 30
+
+spi_inst_t* spi0 = (spi_inst_t*)&spi0;
+spi_inst_t* spi1 = (spi_inst_t*)&spi1;
+
+// ---------------------------------------------------------------------------
+// Panel model
+// ---------------------------------------------------------------------------
+
+struct PanelModel {
+    uint16_t ram[GC9A01_WIDTH * GC9A01_HEIGHT];     // RGB565
+    bool selected;              // CS low
+    bool data;                  // DC high
+    uint8_t command;
+    uint8_t params[4];
+    uint8_t param_count;
+    uint16_t x0, x1, y0, y1;
+    uint16_t x, y;
+    bool have_high;             // First byte of a pixel seen
+    uint8_t high;
+    uint64_t bytes;             // Everything clocked out on SPI0
+};
+
+static PanelModel panel;
+
+static void panelByte(uint8_t byte) {
+    panel.bytes++;
+    if (!panel.selected) {
+        return;
+    }
+
+    if (!panel.data) {
+        panel.command = byte;
+        panel.param_count = 0;
+        if (byte == GC9A01_RAMWR) {
+            panel.x = panel.x0;
+            panel.y = panel.y0;
+            panel.have_high = false;
+        }
+        return;
+    }
+
+    switch (panel.command) {
+    case GC9A01_CASET:
+    case GC9A01_RASET:
+        if (panel.param_count < 4) {
+            panel.params[panel.param_count++] = byte;
+        }
+        if (panel.param_count == 4) {
+            uint16_t start = (panel.params[0] << 8) | panel.params[1];
+            uint16_t end = (panel.params[2] << 8) | panel.params[3];
+            if (panel.command == GC9A01_CASET) {
+                panel.x0 = start;
+                panel.x1 = end;
+            } else {
+                panel.y0 = start;
+                panel.y1 = end;
+            }
+        }
+        break;
+    case GC9A01_RAMWR:
+        if (!panel.have_high) {
+            panel.high = byte;
+            panel.have_high = true;
+            break;
+        }
+        panel.have_high = false;
+        if (panel.x < GC9A01_WIDTH && panel.y < GC9A01_HEIGHT) {
+            panel.ram[panel.y * GC9A01_WIDTH + panel.x] = (uint16_t)((panel.high << 8) | byte);
+        }
+        // The window wraps to its next row, then back to the top
+        if (++panel.x > panel.x1) {
+            panel.x = panel.x0;
+            if (++panel.y > panel.y1) {
+                panel.y = panel.y0;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Pico SDK stand-ins. DMA moves its bytes into the panel model as soon as it
+// is triggered and raises DMA_IRQ_0 right away.
+// ---------------------------------------------------------------------------
+
+static bool dma_available = true;
+static bool dma_irq_pending = false;
+static bool dma_irq_enabled = false;
+static irq_handler_t dma_irq_handler = nullptr;
+static spi_hw_t spi_hw;
+
+static uint64_t hostMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+absolute_time_t get_absolute_time(void) { return hostMicros(); }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint32_t time_us_32(void) { return (uint32_t)hostMicros(); }
+void sleep_ms(uint32_t ms) { (void)ms; }
+void sleep_us(uint64_t us) { (void)us; }
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+bool gpio_get(uint gpio) { (void)gpio; return true; }
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    (void)gpio; (void)events; (void)enabled; (void)callback;
+}
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio == SIM_PIN_CS) {
+        panel.selected = !value;
+    } else if (gpio == SIM_PIN_DC) {
+        panel.data = value;
+    }
+}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    if (spi == spi0) {
+        for (size_t i = 0; i < len; i++) {
+            panelByte(src[i]);
+        }
+    }
+    return (int)len;
+}
+
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len) {
+    spi_write_blocking(spi, src, len);
+    memset(dst, 0, len);
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len) {
+    (void)spi; (void)repeated_tx_data;
+    memset(dst, 0, len);
+    return (int)len;
+}
+
+spi_hw_t* spi_get_hw(spi_inst_t* spi) { (void)spi; return &spi_hw; }
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx) { (void)spi; (void)is_tx; return 0; }
+bool spi_is_busy(spi_inst_t* spi) { (void)spi; return false; }
+bool spi_is_readable(spi_inst_t* spi) { (void)spi; return false; }
+
+uint32_t save_and_disable_interrupts(void) { return 0; }
+void restore_interrupts(uint32_t status) { (void)status; }
+
+int dma_claim_unused_channel(bool required) { (void)required; return dma_available ? 0 : -1; }
+dma_channel_config dma_channel_get_default_config(uint channel) {
+    (void)channel;
+    dma_channel_config config = {true, 0};
+    return config;
+}
+void channel_config_set_transfer_data_size(dma_channel_config* c, enum dma_channel_transfer_size size) { (void)c; (void)size; }
+void channel_config_set_dreq(dma_channel_config* c, uint dreq) { (void)c; (void)dreq; }
+void channel_config_set_read_increment(dma_channel_config* c, bool incr) { c->read_increment = incr; }
+void channel_config_set_write_increment(dma_channel_config* c, bool incr) { (void)c; (void)incr; }
+void channel_config_set_ring(dma_channel_config* c, bool write, uint size_bits) { if (!write) c->ring_bits = size_bits; }
+
+void dma_channel_configure(uint channel, const dma_channel_config* config, volatile void* write_addr,
+                           const volatile void* read_addr, uint transfer_count, bool trigger) {
+    (void)channel; (void)write_addr;
+    if (!trigger) {
+        return;
+    }
+
+    const uint8_t* src = (const uint8_t*)read_addr;
+    uint32_t ring = config->ring_bits ? (1u << config->ring_bits) : 0;
+    for (uint i = 0; i < transfer_count; i++) {
+        uint offset = !config->read_increment ? 0 : ring ? i % ring : i;
+        panelByte(src[offset]);
+    }
+
+    dma_irq_pending = true;
+    if (dma_irq_enabled && dma_irq_handler) {
+        dma_irq_handler();
+    }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) { (void)channel; (void)enabled; }
+bool dma_channel_get_irq0_status(uint channel) { (void)channel; return dma_irq_pending; }
+void dma_channel_acknowledge_irq0(uint channel) { (void)channel; dma_irq_pending = false; }
+
+void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t order_priority) {
+    (void)order_priority;
+    if (num == DMA_IRQ_0) {
+        dma_irq_handler = handler;
+    }
+}
+
+void irq_set_enabled(uint num, bool enabled) {
+    if (num == DMA_IRQ_0) {
+        dma_irq_enabled = enabled;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Frame dumps
+// ---------------------------------------------------------------------------
+
+static void rgb888(uint16_t color, uint8_t* out) {
+    out[0] = (uint8_t)(((color >> 11) & 0x1F) * 255 / 31);
+    out[1] = (uint8_t)(((color >> 5) & 0x3F) * 255 / 63);
+    out[2] = (uint8_t)((color & 0x1F) * 255 / 31);
+}
+
+static bool writePpm(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", GC9A01_WIDTH, GC9A01_HEIGHT);
+    for (int i = 0; i < GC9A01_WIDTH * GC9A01_HEIGHT; i++) {
+        uint8_t rgb[3];
+        rgb888(panel.ram[i], rgb);
+        fwrite(rgb, 1, 3, file);
+    }
+    fclose(file);
+    return true;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void pngChunk(FILE* file, const char* type, const std::string& payload) {
+    uint8_t header[8] = {
+        (uint8_t)(payload.size() >> 24), (uint8_t)(payload.size() >> 16),
+        (uint8_t)(payload.size() >> 8), (uint8_t)payload.size(),
+        (uint8_t)type[0], (uint8_t)type[1], (uint8_t)type[2], (uint8_t)type[3],
+    };
+    uint32_t crc = crc32(header + 4, 4);
+    crc = crc32((const uint8_t*)payload.data(), payload.size(), crc);
+    uint8_t trailer[4] = {(uint8_t)(crc >> 24), (uint8_t)(crc >> 16), (uint8_t)(crc >> 8), (uint8_t)crc};
+    fwrite(header, 1, 8, file);
+    fwrite(payload.data(), 1, payload.size(), file);
+    fwrite(trailer, 1, 4, file);
+}
+
+// Uncompressed (stored deflate blocks) PNG, so no zlib is needed
+static bool writePng(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    std::string raw;
+    for (int y = 0; y < GC9A01_HEIGHT; y++) {
+        raw.push_back(0);   // Filter: none
+        for (int x = 0; x < GC9A01_WIDTH; x++) {
+            uint8_t rgb[3];
+            rgb888(panel.ram[y * GC9A01_WIDTH + x], rgb);
+            raw.append((const char*)rgb, 3);
+        }
+    }
+
+    std::string zlib = "\x78\x01";
+    for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+        size_t len = raw.size() - offset < 65535 ? raw.size() - offset : 65535;
+        zlib.push_back(offset + len == raw.size() ? 1 : 0);
+        zlib.push_back((char)(len & 0xFF));
+        zlib.push_back((char)(len >> 8));
+        zlib.push_back((char)(~len & 0xFF));
+        zlib.push_back((char)((~len >> 8) & 0xFF));
+        zlib.append(raw, offset, len);
+    }
+    uint32_t a = 1, b = 0;
+    for (unsigned char c : raw) {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        zlib.push_back((char)(adler >> shift));
+    }
+
+    std::string ihdr;
+    for (uint32_t value : {(uint32_t)GC9A01_WIDTH, (uint32_t)GC9A01_HEIGHT}) {
+        for (int shift = 24; shift >= 0; shift -= 8) {
+            ihdr.push_back((char)(value >> shift));
+        }
+    }
+    ihdr += std::string("\x08\x02\x00\x00\x00", 5);     // 8-bit RGB
+
+    fwrite("\x89PNG\r\n\x1a\n", 1, 8, file);
+    pngChunk(file, "IHDR", ihdr);
+    pngChunk(file, "IDAT", zlib);
+    pngChunk(file, "IEND", "");
+    fclose(file);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Scripted drive
+// ---------------------------------------------------------------------------
+
+struct SimOptions {
+    uint32_t frames = 300;
+    bool framebuffer = true;
+    bool dma = true;
+    bool csv = false;
+    bool png = false;
+    bool overlay = false;
+    std::string dump_dir;
+    uint32_t dump_every = 0;    // 0: only the logo and the last frame
+};
+
+// Idle, then RPM sweeps with the coolant warming up; the AFR sensor drops
+// out for a second to exercise hidden widgets
+static GaugeSnapshot scriptedSnapshot(uint32_t frame, uint32_t now_ms, float& fuel_liters) {
+    GaugeSnapshot snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    HolleyEngineData& engine = snapshot.engine;
+
+    float sweep = 0.5f - 0.5f * cosf(frame * 2.0f * (float)M_PI / 150.0f);
+    engine.rpm = 800.0f + 6000.0f * sweep;
+    engine.coolant_temp = 150.0f + 55.0f * (frame % 600) / 600.0f;
+    engine.fuel_flow = 8.0f + engine.rpm / 120.0f;
+    engine.air_fuel_ratio = 14.7f + 1.5f * sinf(frame * 0.11f);
+    engine.last_update_time = now_ms;
+
+    snapshot.rpm_valid = frame >= 15;
+    snapshot.coolant_temp_valid = frame >= 15;
+    snapshot.fuel_flow_valid = frame >= 15;
+    snapshot.afr_valid = frame >= 15 && (frame < 100 || frame >= 130);
+
+    if (snapshot.fuel_flow_valid) {
+        float liters_per_hour = HolleySniper::convertLbHrToGalHr(engine.fuel_flow) * 3.78541f;
+        fuel_liters += liters_per_hour * SIM_FRAME_MS / 3600000.0f;
+    }
+    snapshot.fuel_consumed_liters = fuel_liters;
+    return snapshot;
+}
+
+static void dump(const SimOptions& options, const char* name) {
+    if (options.dump_dir.empty()) {
+        return;
+    }
+    std::string path = options.dump_dir + "/" + name + (options.png ? ".png" : ".ppm");
+    if (!(options.png ? writePng(path) : writePpm(path))) {
+        printf("ERROR: cannot write %s\n", path.c_str());
+    }
+}
+
+// Pixels where the panel differs from the driver's framebuffer
+static uint32_t panelMismatches(GC9A01& display) {
+    static uint16_t pixels[GC9A01_WIDTH * GC9A01_HEIGHT];
+    if (!display.captureRegion(0, 0, GC9A01_WIDTH, GC9A01_HEIGHT, pixels)) {
+        return 0;
+    }
+    uint32_t mismatches = 0;
+    for (int i = 0; i < GC9A01_WIDTH * GC9A01_HEIGHT; i++) {
+        uint16_t color = (uint16_t)((pixels[i] >> 8) | (pixels[i] << 8));
+        if (color != panel.ram[i]) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static int usage(const char* name) {
+    printf("Usage: %s [--frames N] [--direct] [--no-dma] [--csv] [--overlay] [--dump DIR] [--dump-every N] [--png]\n", name);
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    SimOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--frames" && i + 1 < argc) {
+            options.frames = (uint32_t)atoi(argv[++i]);
+        } else if (arg == "--direct") {
+            options.framebuffer = false;
+        } else if (arg == "--no-dma") {
+            options.dma = false;
+        } else if (arg == "--csv") {
+            options.csv = true;
+        } else if (arg == "--overlay") {
+            options.overlay = true;
+        } else if (arg == "--png") {
+            options.png = true;
+        } else if (arg == "--dump" && i + 1 < argc) {
+            options.dump_dir = argv[++i];
+        } else if (arg == "--dump-every" && i + 1 < argc) {
+            options.dump_every = (uint32_t)atoi(argv[++i]);
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    dma_available = options.dma;
+
+    static GC9A01 display(spi0, SIM_PIN_CS, SIM_PIN_DC, SIM_PIN_RST, SIM_PIN_BL);
+    static GlyphCache glyph_cache(GLYPH_CACHE_DEFAULT_BUDGET);
+    static Dashboard dashboard(display);
+
+    // Same bring-up as core1_main()
+    display.init();
+    if (options.framebuffer && !display.enableFramebuffer()) {
+        printf("ERROR: no memory for the framebuffer\n");
+        return 1;
+    }
+    if (options.dma) {
+        display.enableDMA();
+    }
+    display.setGlyphCache(&glyph_cache);
+
+    display.fillScreen(BLACK);
+    display.drawPackedImage((240 - torino_logo_sm.width) / 2 + 4, (240 - torino_logo_sm.height) / 2 - 12, torino_logo_sm);
+    display.flush();
+    display.waitIdle();
+    dump(options, "logo");
+
+    display.fillScreen(BLACK);
+    dashboard.invalidate();
+    display.setStatsOverlay(options.overlay);
+    display.flush();
+    display.resetFrameStats();
+    uint64_t boot_bytes = panel.bytes;
+
+    if (options.csv) {
+        printf("frame,render_us,spi_bytes,spi_model_us,widgets\n");
+    }
+
+    float fuel_liters = 0.0f;
+    uint32_t max_model_us = 0;
+    uint32_t mismatched_frames = 0;
+    for (uint32_t frame = 0; frame < options.frames; frame++) {
+        uint32_t now_ms = 5000 + frame * SIM_FRAME_MS;
+        GaugeSnapshot snapshot = scriptedSnapshot(frame, now_ms, fuel_liters);
+
+        display.beginFrame();
+        uint8_t widgets = dashboard.update(snapshot, now_ms);
+        display.flush();
+
+        GC9A01FrameStats stats = display.getFrameStats();
+        uint32_t model_us = (uint32_t)((uint64_t)stats.spi_bytes * 8 * 1000000 / SIM_SPI_HZ);
+        if (model_us > max_model_us) max_model_us = model_us;
+        if (options.framebuffer && panelMismatches(display) != 0) {
+            mismatched_frames++;
+        }
+
+        if (options.csv) {
+            printf("%lu,%lu,%lu,%lu,%u\n", (unsigned long)frame, (unsigned long)stats.render_us,
+                   (unsigned long)stats.spi_bytes, (unsigned long)model_us, widgets);
+        }
+        if (options.dump_every && frame % options.dump_every == 0) {
+            char name[32];
+            snprintf(name, sizeof(name), "frame_%05lu", (unsigned long)frame);
+            dump(options, name);
+        }
+    }
+    dump(options, "last");
+
+    uint64_t frame_bytes = panel.bytes - boot_bytes;
+    uint32_t frames = options.frames ? options.frames : 1;
+    printf("Mode        %s, %s\n", options.framebuffer ? "framebuffer" : "direct", options.dma ? "DMA" : "blocking SPI");
+    display.printFrameStats();
+    printf("SPI model   %.2f ms/frame avg, %.2f ms max at %d MHz (%.0f%% of a %d ms frame)\n",
+           frame_bytes * 8000.0 / SIM_SPI_HZ / frames, max_model_us / 1000.0, SIM_SPI_HZ / 1000000,
+           100.0 * frame_bytes * 8000.0 / SIM_SPI_HZ / frames / SIM_FRAME_MS, SIM_FRAME_MS);
+    if (options.framebuffer) {
+        printf("Panel       %lu of %lu frames differ from the framebuffer after flush\n",
+               (unsigned long)mismatched_frames, (unsigned long)options.frames);
+    }
+    glyph_cache.printStats();
+    return mismatched_frames ? 2 : 0;
+}
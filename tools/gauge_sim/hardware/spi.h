@@ -0,0 +1,26 @@
+// Host stand-in for the Pico SDK, see gauge_sim.cpp
+#ifndef SIM_HARDWARE_SPI_H
+#define SIM_HARDWARE_SPI_H
+
+#include "pico/stdlib.h"
+
+#define SPI_SSPICR_RORIC_BITS 0x1u
+
+typedef struct spi_inst spi_inst_t;
+extern spi_inst_t* spi0;
+extern spi_inst_t* spi1;
+
+typedef struct {
+    volatile uint32_t dr;
+    volatile uint32_t icr;
+} spi_hw_t;
+
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len);
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len);
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len);
+spi_hw_t* spi_get_hw(spi_inst_t* spi);
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx);
+bool spi_is_busy(spi_inst_t* spi);
+bool spi_is_readable(spi_inst_t* spi);
+
+#endif // SIM_HARDWARE_SPI_H
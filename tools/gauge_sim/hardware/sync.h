@@ -0,0 +1,10 @@
+// Host stand-in for the Pico SDK, see gauge_sim.cpp
+#ifndef SIM_HARDWARE_SYNC_H
+#define SIM_HARDWARE_SYNC_H
+
+#include <stdint.h>
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+#endif // SIM_HARDWARE_SYNC_H
@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+Packs an image into the run-length coded PackedImage format of the
+DigitalGauge display driver (DigitalGauge/core/PackedImage.h) and writes it as
+a C++ source/header pair. Images with up to 16 colours use a 4-bit palette, up
+to 256 an 8-bit palette, anything else plain RGB565 runs.
+
+Reads uncompressed BMPs (1/4/8/24/32 bits) without extra modules, so it can run
+at build time; other formats are loaded through Pillow when it is installed.
+
+Usage: image_pack.py [--name NAME] [--format auto|rgb565|index8|index4] <input> <output_dir>
+"""
+import argparse
+import os
+import struct
+import sys
+
+FORMATS = {"rgb565": 0, "index8": 1, "index4": 2}
+MAX_PACKET = 128
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def read_bmp(path):
+    with open(path, "rb") as file:
+        data = file.read()
+    if data[:2] != b"BM":
+        return None
+
+    offset = struct.unpack_from("<I", data, 10)[0]
+    header_size, width, height, _, bpp, compression = struct.unpack_from("<IiiHHI", data, 14)
+    if compression not in (0, 3) or bpp not in (1, 4, 8, 24, 32):
+        sys.exit(f"Error: {path}: unsupported BMP ({bpp} bits, compression {compression})")
+
+    palette = []
+    if bpp <= 8:
+        colors = struct.unpack_from("<I", data, 46)[0] or (1 << bpp)
+        for i in range(colors):
+            b, g, r = struct.unpack_from("<BBB", data, 14 + header_size + 4 * i)
+            palette.append((r, g, b))
+
+    stride = (width * bpp + 31) // 32 * 4
+    rows = abs(height)
+    pixels = []
+    for y in range(rows):
+        # Positive heights are stored bottom-up
+        base = offset + (rows - 1 - y if height > 0 else y) * stride
+        for x in range(width):
+            if bpp == 24 or bpp == 32:
+                b, g, r = struct.unpack_from("<BBB", data, base + x * (bpp // 8))
+                pixels.append(rgb565(r, g, b))
+            else:
+                bit = x * bpp
+                index = (data[base + bit // 8] >> (8 - bpp - bit % 8)) & ((1 << bpp) - 1)
+                pixels.append(rgb565(*palette[index]))
+    return width, rows, pixels
+
+
+def read_image(path):
+    if path.lower().endswith(".bmp"):
+        image = read_bmp(path)
+        if image:
+            return image
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit(f"Error: {path} is not an uncompressed BMP and Pillow is not installed")
+    image = Image.open(path).convert("RGB")
+    width, height = image.size
+    return width, height, [rgb565(*image.getpixel((x, y))) for y in range(height) for x in range(width)]
+
+
+def packets(values, min_run):
+    """Splits values into ("run", value, count) and ("literal", values) packets."""
+    result = []
+    literal = []
+    i = 0
+    while i < len(values):
+        run = 1
+        while i + run < len(values) and run < MAX_PACKET and values[i + run] == values[i]:
+            run += 1
+        if run >= min_run:
+            if literal:
+                result.append(("literal", literal))
+                literal = []
+            result.append(("run", values[i], run))
+            i += run
+            continue
+        literal.append(values[i])
+        i += 1
+        if len(literal) == MAX_PACKET:
+            result.append(("literal", literal))
+            literal = []
+    if literal:
+        result.append(("literal", literal))
+    return result
+
+
+def encode(pixels, fmt):
+    if fmt == FORMATS["rgb565"]:
+        palette = []
+        values = pixels
+        # A run of 2 already saves a byte over two literals
+        min_run = 2
+    else:
+        palette = sorted(set(pixels))
+        lookup = {color: index for index, color in enumerate(palette)}
+        values = [lookup[color] for color in pixels]
+        min_run = 3
+
+    stream = bytearray()
+    for packet in packets(values, min_run):
+        if packet[0] == "run":
+            _, value, count = packet
+            stream.append(0x80 | (count - 1))
+            if fmt == FORMATS["rgb565"]:
+                stream += bytes((value >> 8, value & 0xFF))
+            else:
+                stream.append(value)
+        else:
+            literal = packet[1]
+            stream.append(len(literal) - 1)
+            if fmt == FORMATS["rgb565"]:
+                for value in literal:
+                    stream += bytes((value >> 8, value & 0xFF))
+            elif fmt == FORMATS["index8"]:
+                stream += bytes(literal)
+            else:
+                for i in range(0, len(literal), 2):
+                    low = literal[i + 1] if i + 1 < len(literal) else 0
+                    stream.append((literal[i] << 4) | low)
+    return palette, stream
+
+
+def decode(width, height, fmt, palette, stream):
+    """Reference decoder, checks the stream before it is written out."""
+    pixels = []
+    i = 0
+    while i < len(stream):
+        control = stream[i]
+        i += 1
+        count = (control & 0x7F) + 1
+        if control & 0x80:
+            if fmt == FORMATS["rgb565"]:
+                pixels += [(stream[i] << 8) | stream[i + 1]] * count
+                i += 2
+            else:
+                pixels += [palette[stream[i] & (0x0F if fmt == FORMATS["index4"] else 0xFF)]] * count
+                i += 1
+        elif fmt == FORMATS["rgb565"]:
+            pixels += [(stream[i + 2 * k] << 8) | stream[i + 2 * k + 1] for k in range(count)]
+            i += 2 * count
+        elif fmt == FORMATS["index8"]:
+            pixels += [palette[v] for v in stream[i:i + count]]
+            i += count
+        else:
+            pixels += [palette[(stream[i + k // 2] >> (0 if k % 2 else 4)) & 0x0F] for k in range(count)]
+            i += (count + 1) // 2
+    return pixels[:width * height]
+
+
+def swap16(value):
+    return ((value & 0xFF) << 8) | (value >> 8)
+
+
+def hex_lines(values, per_line, digits):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(f"0x{v:0{digits}X}" for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack an image for the DigitalGauge display.")
+    parser.add_argument("input", help="Input image")
+    parser.add_argument("output_dir", help="Directory for NAME.h and NAME.cpp")
+    parser.add_argument("--name", help="C++ symbol and file name (default: input file name)")
+    parser.add_argument("--format", default="auto", choices=["auto"] + list(FORMATS),
+                        help="Pixel encoding (default: smallest palette that fits)")
+    args = parser.parse_args()
+
+    name = args.name or os.path.splitext(os.path.basename(args.input))[0].lower()
+    width, height, pixels = read_image(args.input)
+
+    colors = len(set(pixels))
+    if args.format == "auto":
+        fmt = FORMATS["index4"] if colors <= 16 else FORMATS["index8"] if colors <= 256 else FORMATS["rgb565"]
+    else:
+        fmt = FORMATS[args.format]
+        if (fmt == FORMATS["index4"] and colors > 16) or (fmt == FORMATS["index8"] and colors > 256):
+            sys.exit(f"Error: {args.input} has {colors} colours, too many for {args.format}")
+
+    palette, stream = encode(pixels, fmt)
+    if decode(width, height, fmt, palette, stream) != pixels:
+        sys.exit(f"Error: {args.input}: packed stream does not round trip")
+
+    format_name = [key for key, value in FORMATS.items() if value == fmt][0]
+    guard = f"{name.upper()}_H"
+    header = f"""// Generated by tools/image_pack.py from {os.path.basename(args.input)}, do not edit
+#ifndef {guard}
+#define {guard}
+
+#include "core/PackedImage.h"
+
+// {width}x{height}, {format_name}, {len(stream)} bytes packed ({width * height * 2} raw)
+extern const PackedImage {name};
+
+#endif // {guard}
+"""
+
+    palette_symbol = "nullptr"
+    palette_source = ""
+    if palette:
+        palette_symbol = f"{name}_palette"
+        palette_source = (f"static const uint16_t {name}_palette[{len(palette)}] = {{\n"
+                          f"{hex_lines([swap16(c) for c in palette], 12, 4)}\n}};\n\n")
+
+    source = f"""// Generated by tools/image_pack.py from {os.path.basename(args.input)}, do not edit
+#include "{name}.h"
+
+{palette_source}static const uint8_t {name}_data[{len(stream)}] = {{
+{hex_lines(list(stream), 16, 2)}
+}};
+
+const PackedImage {name} = {{
+    {width}, {height},
+    PACKED_IMAGE_{format_name.upper()},
+    {len(palette)},
+    {palette_symbol},
+    {name}_data,
+    sizeof({name}_data),
+}};
+"""
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    with open(os.path.join(args.output_dir, f"{name}.h"), "w") as file:
+        file.write(header)
+    with open(os.path.join(args.output_dir, f"{name}.cpp"), "w") as file:
+        file.write(source)
+
+    print(f"Packed {args.input}: {width}x{height}, {colors} colours, {format_name}, "
+          f"{len(stream) + 2 * len(palette)} bytes ({width * height * 2} raw)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,393 @@
+/*
+ * mcp2515_sim.cpp
+ *
+ * Host-side mock SPI backend for the DigitalGauge MCP2515 driver. The Pico SDK
+ * SPI/GPIO/interrupt calls are replaced by a model of the MCP2515 (two RX
+ * buffers with RXB0 rollover, CANINTE/CANINTF and the INT pin) attached to a CAN
+ * bus delivering extended frames at a configurable load. The unmodified driver
+ * runs against it, either polled from the 10 Hz UI loop or fed by its INT
+ * handler, and the frame loss of both modes is reported.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++17 -O2 -Itools/mcp2515_sim -IDigitalGauge/core \
+ *       tools/mcp2515_sim/mcp2515_sim.cpp DigitalGauge/core/MCP2515.cpp -o mcp2515_sim
+ *   ./mcp2515_sim [bus_load_percent] [seconds] [ui_period_ms]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "MCP2515.h"
+
+#define SIM_PIN_CS          5
+#define SIM_PIN_INT         6
+#define SIM_SPI_HZ          8000000     // DigitalGauge runs SPI1 at 8MHz
+#define SIM_CAN_BITRATE     500000
+#define SIM_BITS_PER_FRAME  130         // Extended frame, 8 data bytes, average stuffing
+#define SIM_HOLLEY_RPM_ID   0x1E005000
+
+spi_inst_t* spi1 = nullptr;
+
+// ---------------------------------------------------------------------------
+// Simulation state
+// ---------------------------------------------------------------------------
+
+struct SimState {
+    uint64_t now_ns;
+
+    // MCP2515 model
+    uint8_t regs[128];
+    bool cs_active;
+    uint8_t command;
+    uint8_t address;
+    uint8_t mask;
+    size_t byte_index;
+    bool int_level;             // INT pin, active low
+
+    // Interrupt controller
+    gpio_irq_callback_t callback;
+    bool irq_armed;
+    bool irq_pending;
+    bool irq_masked;
+    bool in_irq;
+
+    // CAN bus
+    bool bus_enabled;
+    uint64_t frame_period_ns;
+    uint64_t next_frame_ns;
+    uint32_t sequence;
+
+    // Results
+    uint32_t frames_sent;
+    uint32_t frames_overflowed; // Lost in the chip: both RX buffers full
+};
+
+static SimState sim;
+
+static void simAdvance(uint64_t ns);
+
+static bool simIntLevel() {
+    return (sim.regs[MCP2515_CANINTF] & sim.regs[MCP2515_CANINTE]) == 0;
+}
+
+static void simRunInterrupts() {
+    while (sim.irq_pending && sim.irq_armed && !sim.irq_masked && !sim.in_irq) {
+        sim.irq_pending = false;
+        sim.in_irq = true;
+        sim.irq_masked = true;
+        sim.callback(SIM_PIN_INT, GPIO_IRQ_EDGE_FALL);
+        sim.irq_masked = false;
+        sim.in_irq = false;
+    }
+}
+
+// Latches a falling edge on INT like the RP2350 edge detector does
+static void simUpdateInt() {
+    bool level = simIntLevel();
+    if (sim.int_level && !level && sim.irq_armed) {
+        sim.irq_pending = true;
+    }
+    sim.int_level = level;
+}
+
+static void simReset() {
+    memset(sim.regs, 0, sizeof(sim.regs));
+    sim.regs[MCP2515_CANCTRL] = 0x87;
+    sim.regs[MCP2515_CANSTAT] = MCP2515_MODE_CONFIG;
+    simUpdateInt();
+}
+
+static void simRegisterWritten(uint8_t reg) {
+    if (reg == MCP2515_CANCTRL) {
+        sim.regs[MCP2515_CANSTAT] = (sim.regs[MCP2515_CANSTAT] & ~MCP2515_MODE_MASK) |
+                                    (sim.regs[MCP2515_CANCTRL] & MCP2515_MODE_MASK);
+    }
+    simUpdateInt();
+}
+
+// A frame finished on the bus: store it like the MCP2515 acceptance logic
+static void simReceiveFrame() {
+    sim.frames_sent++;
+
+    if ((sim.regs[MCP2515_CANSTAT] & MCP2515_MODE_MASK) != MCP2515_MODE_NORMAL) {
+        sim.frames_overflowed++;
+        return;
+    }
+
+    uint8_t base;
+    if (!(sim.regs[MCP2515_CANINTF] & MCP2515_INT_RX0IF)) {
+        base = MCP2515_RXB0SIDH;
+        sim.regs[MCP2515_CANINTF] |= MCP2515_INT_RX0IF;
+    } else if ((sim.regs[MCP2515_RXB0CTRL] & MCP2515_RXB0CTRL_BUKT) &&
+               !(sim.regs[MCP2515_CANINTF] & MCP2515_INT_RX1IF)) {
+        base = MCP2515_RXB1SIDH;
+        sim.regs[MCP2515_CANINTF] |= MCP2515_INT_RX1IF;
+    } else {
+        sim.frames_overflowed++;
+        sim.regs[MCP2515_EFLG] |= 0x40;  // RX0OVR
+        return;
+    }
+
+    uint32_t id = SIM_HOLLEY_RPM_ID;
+    sim.regs[base + 0] = (uint8_t)(id >> 21);
+    sim.regs[base + 1] = (uint8_t)(((id >> 13) & 0xE0) | 0x08 | ((id >> 16) & 0x03));
+    sim.regs[base + 2] = (uint8_t)(id >> 8);
+    sim.regs[base + 3] = (uint8_t)id;
+    sim.regs[base + 4] = 8;
+    memcpy(&sim.regs[base + 5], &sim.sequence, sizeof(sim.sequence));
+    memset(&sim.regs[base + 9], 0, 4);
+    sim.sequence++;
+
+    simUpdateInt();
+}
+
+// Moves simulated time forward, delivering bus frames and running the INT
+// handler whenever it is due and not masked
+static void simAdvance(uint64_t ns) {
+    uint64_t target = sim.now_ns + ns;
+
+    while (sim.bus_enabled && sim.next_frame_ns <= target) {
+        if (sim.next_frame_ns > sim.now_ns) {
+            sim.now_ns = sim.next_frame_ns;
+        }
+        sim.next_frame_ns += sim.frame_period_ns;
+        simReceiveFrame();
+        simRunInterrupts();
+    }
+
+    if (target > sim.now_ns) {
+        sim.now_ns = target;
+    }
+}
+
+static uint8_t simSpiByte(uint8_t tx) {
+    simAdvance(8ULL * 1000000000ULL / SIM_SPI_HZ);
+
+    if (!sim.cs_active) {
+        return 0xFF;
+    }
+
+    uint8_t rx = 0xFF;
+    size_t index = sim.byte_index++;
+
+    if (index == 0) {
+        sim.command = tx;
+        if (tx == MCP2515_RESET) {
+            simReset();
+        } else if ((tx & 0xF9) == MCP2515_READ_RX_BUFFER) {
+            static const uint8_t starts[4] = {MCP2515_RXB0SIDH, MCP2515_RXB0DATA, MCP2515_RXB1SIDH, MCP2515_RXB1DATA};
+            sim.address = starts[(tx >> 1) & 0x03];
+        }
+        return rx;
+    }
+
+    switch (sim.command) {
+        case MCP2515_READ:
+            if (index == 1) sim.address = tx;
+            else rx = sim.regs[sim.address++ & 0x7F];
+            break;
+        case MCP2515_WRITE:
+            if (index == 1) {
+                sim.address = tx;
+            } else {
+                uint8_t reg = sim.address++ & 0x7F;
+                sim.regs[reg] = tx;
+                simRegisterWritten(reg);
+            }
+            break;
+        case MCP2515_BIT_MODIFY:
+            if (index == 1) sim.address = tx;
+            else if (index == 2) sim.mask = tx;
+            else if (index == 3) {
+                uint8_t reg = sim.address & 0x7F;
+                sim.regs[reg] = (sim.regs[reg] & ~sim.mask) | (tx & sim.mask);
+                simRegisterWritten(reg);
+            }
+            break;
+        case MCP2515_READ_STATUS:
+            rx = sim.regs[MCP2515_CANINTF] & (MCP2515_INT_RX0IF | MCP2515_INT_RX1IF);
+            break;
+        default:
+            if ((sim.command & 0xF9) == MCP2515_READ_RX_BUFFER) {
+                rx = sim.regs[sim.address++ & 0x7F];
+            }
+            break;
+    }
+
+    return rx;
+}
+
+// ---------------------------------------------------------------------------
+// Pico SDK stand-ins
+// ---------------------------------------------------------------------------
+
+absolute_time_t get_absolute_time(void) { return sim.now_ns / 1000; }
+uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+uint32_t time_us_32(void) { return (uint32_t)(sim.now_ns / 1000); }
+void sleep_ms(uint32_t ms) { simAdvance((uint64_t)ms * 1000000ULL); }
+void sleep_us(uint64_t us) { simAdvance(us * 1000ULL); }
+
+void gpio_init(uint gpio) { (void)gpio; }
+void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+void gpio_pull_up(uint gpio) { (void)gpio; }
+
+void gpio_put(uint gpio, bool value) {
+    if (gpio != SIM_PIN_CS) {
+        return;
+    }
+
+    if (!value) {
+        sim.cs_active = true;
+        sim.byte_index = 0;
+        return;
+    }
+
+    // Raising CS after READ_RX_BUFFER releases the buffer that was read
+    if (sim.cs_active && sim.byte_index > 0 && (sim.command & 0xF9) == MCP2515_READ_RX_BUFFER) {
+        sim.regs[MCP2515_CANINTF] &= (sim.command & 0x04) ? ~MCP2515_INT_RX1IF : ~MCP2515_INT_RX0IF;
+        simUpdateInt();
+    }
+    sim.cs_active = false;
+}
+
+bool gpio_get(uint gpio) {
+    return gpio == SIM_PIN_INT ? sim.int_level : true;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback) {
+    (void)events;
+    if (gpio == SIM_PIN_INT) {
+        sim.callback = callback;
+        sim.irq_armed = enabled;
+    }
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    uint32_t previous = sim.irq_masked ? 1 : 0;
+    sim.irq_masked = true;
+    return previous;
+}
+
+void restore_interrupts(uint32_t status) {
+    sim.irq_masked = status != 0;
+    simRunInterrupts();
+}
+
+int spi_write_read_blocking(spi_inst_t* spi, const uint8_t* src, uint8_t* dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = simSpiByte(src[i]);
+    }
+    return (int)len;
+}
+
+int spi_write_blocking(spi_inst_t* spi, const uint8_t* src, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) {
+        simSpiByte(src[i]);
+    }
+    return (int)len;
+}
+
+int spi_read_blocking(spi_inst_t* spi, uint8_t repeated_tx_data, uint8_t* dst, size_t len) {
+    (void)spi;
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = simSpiByte(repeated_tx_data);
+    }
+    return (int)len;
+}
+
+// ---------------------------------------------------------------------------
+// Scenarios
+// ---------------------------------------------------------------------------
+
+struct SimResult {
+    uint32_t sent;
+    uint32_t received;
+    uint32_t out_of_order;
+    uint32_t chip_overflows;
+    uint32_t overflow_events;   // RXnOVR flags seen through checkRxOverflow()
+    uint32_t ring_drops;
+    uint32_t interrupts;
+};
+
+// Mirrors the DigitalGauge main loop: drain the driver, then spend the rest of
+// the UI period rendering
+static SimResult runScenario(bool use_interrupt, double load_percent, uint32_t seconds, uint32_t ui_period_ms) {
+    memset(&sim, 0, sizeof(sim));
+    sim.int_level = true;
+    simReset();
+
+    MCP2515 can(spi1, SIM_PIN_CS, SIM_PIN_INT);
+    SimResult result = {};
+
+    if (!can.init(CAN_500KBPS)) {
+        printf("ERROR: driver init failed against the mock\n");
+        exit(1);
+    }
+    if (use_interrupt && !can.enableRxInterrupt()) {
+        printf("ERROR: enabling the RX interrupt failed against the mock\n");
+        exit(1);
+    }
+
+    sim.frame_period_ns = (uint64_t)(SIM_BITS_PER_FRAME * 1e9 / SIM_CAN_BITRATE * 100.0 / load_percent);
+    sim.next_frame_ns = sim.now_ns + sim.frame_period_ns;
+    sim.bus_enabled = true;
+
+    uint64_t end_ns = sim.now_ns + (uint64_t)seconds * 1000000000ULL;
+    uint32_t expected = 0;
+    CANFrame frame;
+
+    while (sim.now_ns < end_ns) {
+        while (can.readFrame(frame)) {
+            uint32_t sequence;
+            memcpy(&sequence, frame.data, sizeof(sequence));
+            if (sequence < expected) {
+                result.out_of_order++;
+            }
+            expected = sequence + 1;
+            result.received++;
+        }
+        if (can.checkRxOverflow()) {
+            result.overflow_events++;
+        }
+        sleep_ms(ui_period_ms);
+    }
+
+    // Stop the bus and collect whatever is still buffered
+    sim.bus_enabled = false;
+    while (can.readFrame(frame)) {
+        result.received++;
+    }
+
+    result.sent = sim.frames_sent;
+    result.chip_overflows = sim.frames_overflowed;
+    result.ring_drops = can.getRxDroppedCount();
+    result.interrupts = can.getRxInterruptCount();
+    return result;
+}
+
+static void printResult(const char* name, const SimResult& r) {
+    double loss = r.sent ? 100.0 * (r.sent - r.received) / r.sent : 0.0;
+    printf("%-10s sent %8u  received %8u  loss %6.2f%%  (chip overflow %u, EFLG events %u, ring drops %u, out of order %u, interrupts %u)\n",
+           name, r.sent, r.received, loss, r.chip_overflows, r.overflow_events, r.ring_drops, r.out_of_order, r.interrupts);
+}
+
+int main(int argc, char** argv) {
+    double load_percent = argc > 1 ? atof(argv[1]) : 100.0;
+    uint32_t seconds = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+    uint32_t ui_period_ms = argc > 3 ? (uint32_t)atoi(argv[3]) : 100;
+
+    if (load_percent <= 0.0 || seconds == 0) {
+        printf("Usage: %s [bus_load_percent] [seconds] [ui_period_ms]\n", argv[0]);
+        return 1;
+    }
+
+    printf("MCP2515 mock: %.0f%% load at %d bit/s, %u s, UI period %u ms, SPI %d Hz\n",
+           load_percent, SIM_CAN_BITRATE, seconds, ui_period_ms, SIM_SPI_HZ);
+
+    printResult("polling", runScenario(false, load_percent, seconds, ui_period_ms));
+    printResult("interrupt", runScenario(true, load_percent, seconds, ui_period_ms));
+    return 0;
+}
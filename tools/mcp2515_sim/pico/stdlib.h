@@ -0,0 +1,21 @@
+// Host stand-in for the Pico SDK, see mcp2515_sim.cpp
+#ifndef SIM_PICO_STDLIB_H
+#define SIM_PICO_STDLIB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+absolute_time_t get_absolute_time(void);
+uint32_t to_ms_since_boot(absolute_time_t t);
+uint32_t time_us_32(void);
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+
+#define GPIO_OUT 1
+#define GPIO_IN  0
+
+#endif // SIM_PICO_STDLIB_H
@@ -0,0 +1,10 @@
+// Host stand-in for libbcm2835, see paint_bench.cpp. DEV_Config.h only needs
+// the pin names; nothing in GUI_Paint talks to the hardware.
+#ifndef SIM_BCM2835_H
+#define SIM_BCM2835_H
+
+#define RPI_V2_GPIO_P1_16 23
+#define RPI_V2_GPIO_P1_22 25
+#define RPI_V2_GPIO_P1_24 8
+
+#endif // SIM_BCM2835_H
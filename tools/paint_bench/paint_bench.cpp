@@ -0,0 +1,144 @@
+/*
+ * paint_bench.cpp
+ *
+ * Host benchmark of the ECU GUI_Paint drawing layer. Times full-screen clears
+ * (Paint_Clear, Paint_ClearWindow, filled Paint_DrawRectangle) and the text
+ * draws the DigitalGauge screen does (opaque readouts in
+ * LiberationSansNarrow_Bold48/36, transparent labels) on a 240x240 RGB565
+ * image, for every rotation. --check instead draws a fixed scene under every
+ * rotation and mirroring and prints a hash of each image, so two versions of
+ * GUI_Paint.cpp can be compared for identical output.
+ *
+ * Build and run from the repository root:
+ *   g++ -std=c++20 -O2 -Itools/paint_bench -IECU/src/lib/LCD_display/Config \
+ *       -IECU/src/lib/LCD_display/LCD -IECU/src/lib/LCD_display/GUI -IECU/src/lib/LCD_display/Fonts \
+ *       tools/paint_bench/paint_bench.cpp ECU/src/lib/LCD_display/GUI/GUI_Paint.cpp \
+ *       ECU/src/lib/LCD_display/Fonts/LiberationSansNarrow_Bold*.cpp -o paint_bench
+ *   ./paint_bench [--check] [--seconds S]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include "GUI_Paint.h"
+
+#define BENCH_WIDTH  240
+#define BENCH_HEIGHT 240
+
+static UWORD image[BENCH_WIDTH * BENCH_HEIGHT];
+
+static const UWORD rotations[] = {ROTATE_0, ROTATE_90, ROTATE_180, ROTATE_270};
+static const UBYTE mirrors[] = {MIRROR_NONE, MIRROR_HORIZONTAL, MIRROR_VERTICAL, MIRROR_ORIGIN};
+
+static uint32_t imageHash()
+{
+    // FNV-1a over the image bytes
+    uint32_t hash = 2166136261u;
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(image);
+    for (size_t i = 0; i < sizeof(image); i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Calls per second of op, run for about the given time
+static double rate(double seconds, const std::function<void(int)> &op)
+{
+    using clock = std::chrono::steady_clock;
+    long calls = 0;
+    auto start = clock::now();
+    double elapsed = 0;
+    do
+    {
+        for (int i = 0; i < 64; i++, calls++)
+            op(calls);
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < seconds);
+    return calls / elapsed;
+}
+
+static void drawScene()
+{
+    Paint_Clear(BLACK);
+    Paint_ClearWindow(10, 20, 200, 60, BLUE);
+    Paint_ClearWindow(230, 230, 240, 240, RED);
+    Paint_DrawRectangle(30, 70, 120, 110, GREEN, DOT_PIXEL_2X2, DRAW_FILL_FULL);
+    Paint_DrawRectangle(1, 1, 240, 240, YELLOW, DOT_PIXEL_1X1, DRAW_FILL_EMPTY);
+    Paint_DrawRectangle(0, 2, 60, 200, CYAN, DOT_PIXEL_3X3, DRAW_FILL_EMPTY);
+    Paint_DrawRectangle(150, 150, 140, 130, MAGENTA, DOT_PIXEL_4X4, DRAW_FILL_FULL);
+    Paint_DrawLine(5, 235, 235, 235, GRAY, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+    Paint_DrawLine(200, 10, 200, 100, BROWN, DOT_PIXEL_1X1, LINE_STYLE_DOTTED);
+    Paint_DrawLine(20, 30, 180, 190, WHITE, DOT_PIXEL_2X2, LINE_STYLE_SOLID);
+    Paint_DrawPoint(0, 0, RED, DOT_PIXEL_3X3, DOT_FILL_AROUND);
+    Paint_DrawPoint(100, 5, RED, DOT_PIXEL_4X4, DOT_FILL_AROUND);
+    Paint_DrawPoint(120, 120, GRED, DOT_PIXEL_5X5, DOT_FILL_RIGHTUP);
+    Paint_DrawCircle(120, 120, 40, WHITE, DOT_PIXEL_2X2, DRAW_FILL_EMPTY);
+    Paint_DrawString_EN(40, 90, "12.5", &LiberationSansNarrow_Bold48, BLACK, RED);
+    Paint_DrawString_EN(60, 160, "KM/L 0.9", &LiberationSansNarrow_Bold16, WHITE, GREEN);
+    Paint_DrawString_EN(180, 200, "14.7 AFR", &LiberationSansNarrow_Bold36, BLACK, WHITE);
+    Paint_DrawChar(215, 0, 'I', &LiberationSansNarrow_Bold24, CYAN, BLACK);
+}
+
+static int check()
+{
+    for (UWORD rotate : rotations)
+    {
+        for (UBYTE mirror : mirrors)
+        {
+            Paint_NewImage(image, BENCH_WIDTH, BENCH_HEIGHT, rotate, BLACK, 16);
+            Paint.Mirror = mirror;
+            drawScene();
+            printf("rotate %3u mirror %u: %08x\n", rotate, mirror, imageHash());
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 0.5;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--check"))
+            return check();
+        else if (!strcmp(argv[i], "--seconds") && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: %s [--check] [--seconds S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("%-6s %12s %12s %12s %12s %12s %12s\n", "rotate", "clear/s", "window/s", "rect/s",
+           "kml48/s", "temp36/s", "labels/s");
+    for (UWORD rotate : rotations)
+    {
+        Paint_NewImage(image, BENCH_WIDTH, BENCH_HEIGHT, rotate, BLACK, 16);
+
+        double clear = rate(seconds, [](int i)
+                            { Paint_Clear(i & 1 ? BLACK : WHITE); });
+        double window = rate(seconds, [](int i)
+                             { Paint_ClearWindow(0, 0, BENCH_WIDTH, BENCH_HEIGHT, i & 1 ? BLACK : RED); });
+        double rect = rate(seconds, [](int i)
+                           { Paint_DrawRectangle(1, 1, BENCH_WIDTH, BENCH_HEIGHT, i & 1 ? BLACK : RED,
+                                                 DOT_PIXEL_1X1, DRAW_FILL_FULL); });
+        // The readouts and labels of ECU DigitalGauge
+        double kml = rate(seconds, [](int i)
+                          { Paint_DrawString_EN(71, 100, i & 1 ? "12.5" : "9.8", &LiberationSansNarrow_Bold48,
+                                                BLACK, GREEN); });
+        double temp = rate(seconds, [](int i)
+                           { Paint_DrawString_EN(90, 30, i & 1 ? "87" : "105", &LiberationSansNarrow_Bold36,
+                                                 BLACK, WHITE); });
+        double labels = rate(seconds, [](int i)
+                             { Paint_DrawString_EN(100, 70, "TEMP", &LiberationSansNarrow_Bold16, WHITE,
+                                                   i & 1 ? GRAY : BLACK); });
+        printf("%-6u %12.0f %12.0f %12.0f %12.0f %12.0f %12.0f\n", rotate, clear, window, rect, kml, temp, labels);
+    }
+    return 0;
+}